@@ -0,0 +1,288 @@
+/**
+ * @file tcs3472x_acq.c
+ * @brief Periodic acquisition thread for the TCS3472x sensor on Linux.
+ *
+ * This file implements the runner declared in tcs3472x_acq.h. The thread sleeps on absolute
+ * CLOCK_MONOTONIC deadlines so lateness does not accumulate, and hands samples to the consumer
+ * through a single-producer single-consumer ring.
+ */
+
+#define _GNU_SOURCE         // For CPU_SET() and pthread_attr_setaffinity_np()
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>       // For mlockall()
+
+#include "tcs3472x.h"
+#include "tcs3472x_acq.h"
+
+#define NS_PER_US       1000LL
+#define NS_PER_SEC      1000000000LL
+#define STACK_PREFAULT  (16 * 1024)
+#define SYNC_POLL_NS    100000LL    ///< Status poll interval while waiting for AVALID
+#define SYNC_MARGIN_NS  20000000LL  ///< Extra wait beyond one nominal cycle before giving up
+
+static int64_t _now_ns(void);
+static void _record_jitter(tcs3472x_acq_t *acq, int64_t late_ns);
+static void *_acq_thread(void *arg);
+
+int8_t tcs3472x_acq_start(tcs3472x_acq_t *acq, const tcs3472x_acq_config_t *config) {
+    pthread_attr_t attr;
+    struct sched_param param;
+    cpu_set_t cpus;
+    int result = 0;
+
+    if (config->capacity == 0 || (config->capacity & (config->capacity - 1)) != 0) {
+        LOG_ERROR("Sample ring capacity must be a power of two.\r\n");
+        return -1;
+    }
+
+    memset(acq, 0, sizeof(*acq));
+    acq->config = *config;
+    atomic_init(&acq->running, 1);
+    atomic_init(&acq->head, 0);
+    atomic_init(&acq->tail, 0);
+    atomic_init(&acq->jitter_seq, 0);
+
+    // Fault the ring in now so the thread never page faults on it
+    memset(config->samples, 0, config->capacity * sizeof(*config->samples));
+
+    if (config->lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        LOG_ERROR("Failed to lock memory (errno %d).\r\n", errno);
+        return -1;
+    }
+
+    if (config->cpu >= CPU_SETSIZE) {
+        LOG_ERROR("CPU %d is out of range.\r\n", config->cpu);
+        return -1;
+    }
+
+    pthread_attr_init(&attr);
+
+    if (config->cpu >= 0) {
+        CPU_ZERO(&cpus);
+        CPU_SET(config->cpu, &cpus);
+        result = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+        if (result != 0) {
+            LOG_ERROR("Failed to set CPU affinity (error %d).\r\n", result);
+            pthread_attr_destroy(&attr);
+            return -1;
+        }
+    }
+
+    if (config->priority > 0) {
+        param.sched_priority = config->priority;
+        result = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        if (result == 0) {
+            result = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        }
+        if (result == 0) {
+            result = pthread_attr_setschedparam(&attr, &param);
+        }
+        if (result != 0) {
+            LOG_ERROR("Failed to set SCHED_FIFO priority %d (error %d).\r\n", config->priority, result);
+            pthread_attr_destroy(&attr);
+            return -1;
+        }
+    }
+
+    result = pthread_create(&acq->thread, &attr, _acq_thread, acq);
+    pthread_attr_destroy(&attr);
+
+    if (result != 0) {
+        LOG_ERROR("Failed to create acquisition thread (error %d).\r\n", result);
+        return -1;
+    }
+
+    return 0;
+}
+
+void tcs3472x_acq_stop(tcs3472x_acq_t *acq) {
+    atomic_store(&acq->running, 0);
+    pthread_join(acq->thread, NULL);
+}
+
+int8_t tcs3472x_acq_pop(tcs3472x_acq_t *acq, tcs3472x_acq_sample_t *sample) {
+    uint32_t tail = atomic_load_explicit(&acq->tail, memory_order_relaxed);
+
+    if (tail == atomic_load_explicit(&acq->head, memory_order_acquire)) {
+        return 0;
+    }
+
+    *sample = acq->config.samples[tail & (acq->config.capacity - 1)];
+    atomic_store_explicit(&acq->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+void tcs3472x_acq_get_jitter(tcs3472x_acq_t *acq, tcs3472x_jitter_hist_t *hist) {
+    uint32_t begin = 0, end = 0;
+
+    // Retry until the copy did not overlap an update by the thread
+    do {
+        begin = atomic_load_explicit(&acq->jitter_seq, memory_order_acquire);
+        memcpy(hist, &acq->jitter, sizeof(*hist));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&acq->jitter_seq, memory_order_relaxed);
+    } while ((begin & 1) != 0 || begin != end);
+}
+
+uint32_t tcs3472x_jitter_percentile_us(const tcs3472x_jitter_hist_t *hist, uint32_t permille) {
+    uint64_t target = ((uint64_t)hist->count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < TCS3472X_ACQ_JITTER_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            return i;
+        }
+    }
+    return TCS3472X_ACQ_JITTER_BUCKETS;
+}
+
+int8_t tcs3472x_acq_sync(tcs3472x_timing_t *timing) {
+    const tcs3472x_config_cache_t *config = tcs3472x_get_config_cache();
+    const struct timespec poll = { .tv_sec = 0, .tv_nsec = SYNC_POLL_NS };
+    int64_t t_begin = 0, t_end = 0, enable_ns = 0, invalid_ns = 0, give_up_ns = 0;
+    uint8_t enable = config->enable | ENABLE_PON | ENABLE_AEN;
+    uint8_t status = 0;
+
+    tcs3472x_timing_init(timing, config);
+
+    if (tcs3472x_set_enable(enable & (uint8_t)~ENABLE_AEN) < 0) {
+        return -1;
+    }
+    t_begin = _now_ns();
+    if (tcs3472x_set_enable(enable) < 0) {
+        return -1;
+    }
+    t_end = _now_ns();
+
+    enable_ns = t_begin + (t_end - t_begin) / 2;
+    invalid_ns = enable_ns;
+    give_up_ns = enable_ns + timing->cycle_ns + SYNC_MARGIN_NS;
+
+    while (t_end < give_up_ns) {
+        t_begin = _now_ns();
+        status = tcs3472x_get_status();
+        t_end = _now_ns();
+
+        if (status & STATUS_AVALID) {
+            tcs3472x_timing_sync(timing, enable_ns, invalid_ns, t_begin + (t_end - t_begin) / 2);
+            return 0;
+        }
+        invalid_ns = t_begin + (t_end - t_begin) / 2;
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &poll, NULL);
+    }
+
+    LOG_ERROR("AVALID not seen after restarting integration.\r\n");
+    return -1;
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * Adds one wake-up lateness to the jitter histogram. The sequence counter is odd while the histogram
+ * is being updated, so tcs3472x_acq_get_jitter() can tell a torn copy.
+ */
+static void _record_jitter(tcs3472x_acq_t *acq, int64_t late_ns) {
+    tcs3472x_jitter_hist_t *hist = &acq->jitter;
+    uint32_t seq = atomic_load_explicit(&acq->jitter_seq, memory_order_relaxed);
+    int64_t bucket = late_ns / NS_PER_US;
+
+    atomic_store_explicit(&acq->jitter_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (late_ns < 0) {
+        bucket = 0;
+    }
+    if (bucket < TCS3472X_ACQ_JITTER_BUCKETS) {
+        hist->buckets[bucket]++;
+    }
+    else {
+        hist->overflow++;
+    }
+    if (late_ns > hist->max_ns) {
+        hist->max_ns = late_ns;
+    }
+    hist->count++;
+    atomic_store_explicit(&acq->jitter_seq, seq + 2, memory_order_release);
+}
+
+/**
+ * Acquisition thread body: sleep until the next deadline, read, publish, repeat.
+ */
+static void *_acq_thread(void *arg) {
+    tcs3472x_acq_t *acq = arg;
+    const int64_t period_ns = (int64_t)acq->config.period_us * NS_PER_US;
+    const uint32_t mask = acq->config.capacity - 1;
+    volatile uint8_t stack_prefault[STACK_PREFAULT];
+    tcs3472x_acq_sample_t *sample = NULL;
+    struct timespec deadline;
+    int64_t next_ns = 0, now_ns = 0, behind = 0, read_begin_ns = 0, read_end_ns = 0;
+    uint32_t head = 0;
+
+    // Fault the stack in before entering the timed loop
+    memset((void *)stack_prefault, 0, sizeof(stack_prefault));
+
+    if (acq->config.sync_window && tcs3472x_acq_sync(&acq->timing) < 0) {
+        acq->config.sync_window = 0;
+    }
+
+    next_ns = _now_ns() + period_ns;
+
+    while (atomic_load_explicit(&acq->running, memory_order_relaxed)) {
+        deadline.tv_sec = next_ns / NS_PER_SEC;
+        deadline.tv_nsec = next_ns % NS_PER_SEC;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        now_ns = _now_ns();
+        _record_jitter(acq, now_ns - next_ns);
+
+        head = atomic_load_explicit(&acq->head, memory_order_relaxed);
+        if (head - atomic_load_explicit(&acq->tail, memory_order_acquire) > mask) {
+            acq->dropped++;
+        }
+        else {
+            sample = &acq->config.samples[head & mask];
+            read_begin_ns = _now_ns();
+            if (tcs3472x_get_all_colors_data(sample->colors) < 0) {
+                acq->errors++;
+            }
+            else {
+                read_end_ns = _now_ns();
+
+                sample->timestamp_ns = read_end_ns;
+                sample->read_latency_ns = read_end_ns - read_begin_ns;
+                sample->window_start_ns = 0;
+                sample->window_end_ns = 0;
+                if (acq->config.sync_window) {
+                    tcs3472x_timing_window(&acq->timing, read_begin_ns + sample->read_latency_ns / 2,
+                                           &sample->window_start_ns, &sample->window_end_ns);
+                }
+                atomic_store_explicit(&acq->head, head + 1, memory_order_release);
+            }
+        }
+
+        next_ns += period_ns;
+        now_ns = _now_ns();
+        if (next_ns <= now_ns) {
+            behind = (now_ns - next_ns) / period_ns + 1;
+            acq->overruns += behind;
+            next_ns += behind * period_ns;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file tcs3472x_backlight_sysfs.c
+ * @brief Linux sysfs backlight output and sample-synchronized control loop.
+ *
+ * This file implements the functions declared in tcs3472x_backlight_sysfs.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_acq.h"
+#include "tcs3472x_backlight_sysfs.h"
+
+#define PATH_SIZE           256
+#define VALUE_SIZE          16
+#define NS_PER_SEC          1000000000LL
+#define WAKE_MARGIN_NS      200000LL    ///< Wake this long after a predicted integration end
+#define WAKE_MARGIN_DIV     100         ///< plus 1 % of the cycle for oscillator error
+
+static int64_t _now_ns(void);
+
+int8_t tcs3472x_backlight_sysfs_open(tcs3472x_backlight_sysfs_t *sysfs, const char *dir) {
+    char path[PATH_SIZE];
+    char value[VALUE_SIZE] = {0};
+    struct stat st;
+    ssize_t length = 0;
+    char *end = NULL;
+    int fd = -1;
+
+    if (snprintf(path, sizeof(path), "%s/max_brightness", dir) >= (int)sizeof(path)) {
+        LOG_ERROR("Backlight path too long.\r\n");
+        return -1;
+    }
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open max_brightness (errno %d).\r\n", errno);
+        return -1;
+    }
+    length = read(fd, value, sizeof(value) - 1);
+    close(fd);
+    if (length <= 0) {
+        LOG_ERROR("Failed to read max_brightness (errno %d).\r\n", errno);
+        return -1;
+    }
+    sysfs->max_brightness = (uint32_t)strtoul(value, &end, 10);
+    if (end == value) {
+        LOG_ERROR("Invalid max_brightness value.\r\n");
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/brightness", dir);
+    sysfs->fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (sysfs->fd < 0) {
+        LOG_ERROR("Failed to open brightness (errno %d).\r\n", errno);
+        return -1;
+    }
+    sysfs->regular_file = fstat(sysfs->fd, &st) == 0 && S_ISREG(st.st_mode);
+    return 0;
+}
+
+int8_t tcs3472x_backlight_sysfs_write(void *context, uint32_t level) {
+    tcs3472x_backlight_sysfs_t *sysfs = context;
+    char value[VALUE_SIZE];
+    int length = 0;
+
+    if (level > sysfs->max_brightness) {
+        level = sysfs->max_brightness;
+    }
+    length = snprintf(value, sizeof(value), "%u\n", level);
+
+    // sysfs takes the whole value in one write at offset 0
+    if (pwrite(sysfs->fd, value, length, 0) != length) {
+        LOG_ERROR("Failed to write backlight level (errno %d).\r\n", errno);
+        return -1;
+    }
+    if (sysfs->regular_file && ftruncate(sysfs->fd, length) < 0) {
+        LOG_ERROR("Failed to truncate backlight file (errno %d).\r\n", errno);
+        return -1;
+    }
+    return 0;
+}
+
+void tcs3472x_backlight_sysfs_close(tcs3472x_backlight_sysfs_t *sysfs) {
+    if (sysfs->fd >= 0) {
+        close(sysfs->fd);
+        sysfs->fd = -1;
+    }
+}
+
+int8_t tcs3472x_backlight_run(tcs3472x_backlight_t *backlight, atomic_int *running,
+                              tcs3472x_backlight_latency_t *latency) {
+    const tcs3472x_config_cache_t *config = tcs3472x_get_config_cache();
+    tcs3472x_timing_t timing;
+    struct timespec deadline;
+    uint16_t colors[4] = {0};
+    int64_t margin_ns = 0, wake_ns = 0, read_begin_ns = 0, read_end_ns = 0, start_ns = 0, end_ns = 0;
+    int64_t done_ns = 0;
+    int8_t result = 0;
+
+    memset(latency, 0, sizeof(*latency));
+
+    if (tcs3472x_acq_sync(&timing) < 0) {
+        return -1;
+    }
+    margin_ns = WAKE_MARGIN_NS + timing.cycle_ns / WAKE_MARGIN_DIV;
+    wake_ns = timing.first_end_ns + margin_ns;
+
+    while (atomic_load_explicit(running, memory_order_relaxed)) {
+        deadline.tv_sec = wake_ns / NS_PER_SEC;
+        deadline.tv_nsec = wake_ns % NS_PER_SEC;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        read_begin_ns = _now_ns();
+        if (tcs3472x_get_all_colors_data(colors) < 0) {
+            latency->errors++;
+            wake_ns += timing.cycle_ns;
+            continue;
+        }
+        read_end_ns = _now_ns();
+
+        result = tcs3472x_backlight_update(backlight, colors, config->atime, config->control, read_end_ns);
+        if (result < 0) {
+            return -1;
+        }
+        done_ns = _now_ns();
+
+        if (tcs3472x_timing_window(&timing, read_begin_ns + (read_end_ns - read_begin_ns) / 2,
+                                   &start_ns, &end_ns) < 0) {
+            end_ns = read_begin_ns;
+        }
+        latency->samples++;
+        latency->writes += result;
+        latency->sum_latency_ns += done_ns - end_ns;
+        if (done_ns - end_ns > latency->max_latency_ns) {
+            latency->max_latency_ns = done_ns - end_ns;
+        }
+
+        // Next integration end after this one; skip ends already missed
+        wake_ns = end_ns + timing.cycle_ns + margin_ns;
+        while (wake_ns <= done_ns) {
+            wake_ns += timing.cycle_ns;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
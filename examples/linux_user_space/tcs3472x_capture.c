@@ -0,0 +1,366 @@
+/**
+ * @file tcs3472x_capture.c
+ * @brief Command-line tool streaming samples from one or more sensors to a file or stdout.
+ *
+ * The sensors are opened as a group, so every integration cycle costs one I2C_RDWR transaction per bus
+ * no matter how many sensors share it. The capture loop sleeps until just after each predicted
+ * integration end, reads the group and formats every sample with the integer formatter into a large
+ * buffer. Full buffers are handed to a writer thread, so a slow disk or pipe never delays a read; if
+ * the writer still holds the other buffer, the cycle's samples are dropped and counted instead.
+ *
+ * On SIGINT, SIGTERM or when the requested count or duration is reached, the remaining data is
+ * flushed and the achieved rate, the expected rate and the dropped samples are printed to stderr.
+ *
+ *     tcs3472x_capture [-d bus:address]... [-a atime_us] [-f csv|ndjson|binary] [-o file]
+ *                      [-n samples] [-t seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_group.h"
+#include "tcs3472x_format.h"
+
+#define DEFAULT_BUS         "/dev/i2c-1"
+#define DEFAULT_ADDRESS     0x29
+#define DEFAULT_ATIME_US    2400
+#define ATIME_STEP_US       2400
+#define BUFFER_SIZE         (1 << 20)
+#define NS_PER_SEC          1000000000LL
+#define READ_MARGIN_NS      200000LL    ///< Wake this long after a predicted integration end
+
+/**
+ * @brief Two output buffers: the capture loop fills one while the writer thread drains the other.
+ */
+typedef struct {
+    char *buffers[2];
+    size_t lengths[2];
+    uint8_t filling;            ///< Buffer the capture loop writes to.
+    int8_t pending;             ///< Buffer handed to the writer, or -1.
+    uint8_t stop;
+    int fd;
+    uint64_t bytes;
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} output_t;
+
+static volatile sig_atomic_t running = 1;
+
+static void _on_signal(int signal_number) {
+    (void)signal_number;
+    running = 0;
+}
+
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static int _write_all(int fd, const char *data, size_t length) {
+    ssize_t written = 0;
+
+    while (length > 0) {
+        written = write(fd, data, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0) {
+            return errno;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+static void *_writer(void *arg) {
+    output_t *output = arg;
+    int8_t index = -1;
+    int error = 0;
+
+    pthread_mutex_lock(&output->lock);
+    for (;;) {
+        while (output->pending < 0 && !output->stop) {
+            pthread_cond_wait(&output->cond, &output->lock);
+        }
+        if (output->pending < 0) {
+            break;
+        }
+        index = output->pending;
+        pthread_mutex_unlock(&output->lock);
+
+        error = _write_all(output->fd, output->buffers[index], output->lengths[index]);
+
+        pthread_mutex_lock(&output->lock);
+        if (error != 0 && output->error == 0) {
+            output->error = error;
+        }
+        output->bytes += output->lengths[index];
+        output->lengths[index] = 0;
+        output->pending = -1;
+        pthread_cond_broadcast(&output->cond);
+    }
+    pthread_mutex_unlock(&output->lock);
+    return NULL;
+}
+
+/**
+ * Hands the filled buffer to the writer if it is idle.
+ *
+ * @return 1 if the buffer was handed over, 0 if the writer is still busy.
+ */
+static int _hand_over(output_t *output) {
+    int handed = 0;
+
+    pthread_mutex_lock(&output->lock);
+    if (output->pending < 0) {
+        output->pending = (int8_t)output->filling;
+        output->filling ^= 1;
+        pthread_cond_broadcast(&output->cond);
+        handed = 1;
+    }
+    pthread_mutex_unlock(&output->lock);
+    return handed;
+}
+
+/**
+ * Waits for the writer, writes the rest of the filling buffer and stops the writer thread.
+ */
+static void _finish(output_t *output, pthread_t thread) {
+    pthread_mutex_lock(&output->lock);
+    while (output->pending >= 0) {
+        pthread_cond_wait(&output->cond, &output->lock);
+    }
+    if (output->lengths[output->filling] > 0) {
+        output->pending = (int8_t)output->filling;
+        pthread_cond_broadcast(&output->cond);
+        while (output->pending >= 0) {
+            pthread_cond_wait(&output->cond, &output->lock);
+        }
+    }
+    output->stop = 1;
+    pthread_cond_broadcast(&output->cond);
+    pthread_mutex_unlock(&output->lock);
+    pthread_join(thread, NULL);
+}
+
+static int _parse_device(const char *arg, tcs3472x_group_sensor_t *sensor) {
+    static char paths[TCS3472X_GROUP_MAX_SENSORS][TCS3472X_GROUP_PATH_LEN];
+    static uint8_t used = 0;
+    const char *colon = strrchr(arg, ':');
+    char *end = NULL;
+    long address = 0;
+
+    if (colon == NULL || colon == arg || (size_t)(colon - arg) >= TCS3472X_GROUP_PATH_LEN ||
+        used == TCS3472X_GROUP_MAX_SENSORS) {
+        return -1;
+    }
+    address = strtol(colon + 1, &end, 0);
+    if (*end != '\0' || address <= 0 || address > 0x7F) {
+        return -1;
+    }
+    memcpy(paths[used], arg, (size_t)(colon - arg));
+    paths[used][colon - arg] = '\0';
+    sensor->bus_path = paths[used++];
+    sensor->address = (uint16_t)address;
+    return 0;
+}
+
+static void _usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [-d bus:address]... [-a atime_us] [-f csv|ndjson|binary] [-o file] [-n samples] [-t seconds]\n"
+            "  -d  sensor to read, repeatable (default " DEFAULT_BUS ":0x29)\n"
+            "  -a  integration time in microseconds, 2400 to 614400 (default 2400)\n"
+            "  -f  output format (default csv)\n"
+            "  -o  output file (default stdout)\n"
+            "  -n  stop after this many samples\n"
+            "  -t  stop after this many seconds\n",
+            name);
+}
+
+int main(int argc, char *argv[]) {
+    static tcs3472x_group_sensor_t sensors[TCS3472X_GROUP_MAX_SENSORS];
+    static tcs3472x_group_t group;
+    static output_t output;
+    tcs3472x_format_t format = TCS3472X_FORMAT_CSV;
+    tcs3472x_format_sample_t sample;
+    struct sigaction action;
+    struct timespec deadline;
+    const char *path = NULL;
+    pthread_t writer;
+    uint32_t atime_us = DEFAULT_ATIME_US;
+    uint64_t limit = 0, samples = 0, dropped = 0, read_errors = 0, cycles = 0, missed = 0;
+    int64_t duration_ns = 0, cycle_ns = 0, start_ns = 0, end_ns = 0, next_ns = 0, now_ns = 0;
+    uint8_t count = 0, i = 0, atime = 0;
+    size_t reserve = 0;
+    char *buffer = NULL;
+    int option = 0;
+
+    while ((option = getopt(argc, argv, "d:a:f:o:n:t:h")) != -1) {
+        switch (option) {
+            case 'd':
+                if (count == TCS3472X_GROUP_MAX_SENSORS || _parse_device(optarg, &sensors[count]) < 0) {
+                    fprintf(stderr, "Invalid device '%s', expected bus:address.\n", optarg);
+                    return 2;
+                }
+                count++;
+                break;
+            case 'a':
+                atime_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                if (strcmp(optarg, "csv") == 0) {
+                    format = TCS3472X_FORMAT_CSV;
+                }
+                else if (strcmp(optarg, "ndjson") == 0) {
+                    format = TCS3472X_FORMAT_NDJSON;
+                }
+                else if (strcmp(optarg, "binary") == 0) {
+                    format = TCS3472X_FORMAT_BINARY;
+                }
+                else {
+                    _usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'o':
+                path = optarg;
+                break;
+            case 'n':
+                limit = strtoull(optarg, NULL, 0);
+                break;
+            case 't':
+                duration_ns = (int64_t)(strtod(optarg, NULL) * NS_PER_SEC);
+                break;
+            default:
+                _usage(argv[0]);
+                return option == 'h' ? 0 : 2;
+        }
+    }
+    if (atime_us < ATIME_STEP_US || atime_us > 256 * ATIME_STEP_US) {
+        fprintf(stderr, "Integration time must be between 2400 and 614400 microseconds.\n");
+        return 2;
+    }
+    // Same rounding as tcs3472x_set_atime_us(): up to the next 2.4 ms step
+    atime = tcs3472x_us_to_atime(atime_us);
+    if (tcs3472x_atime_to_us(atime) != (int32_t)atime_us) {
+        fprintf(stderr, "Integration time rounded up to %d microseconds.\n", tcs3472x_atime_to_us(atime));
+    }
+    if (count == 0) {
+        sensors[0].bus_path = DEFAULT_BUS;
+        sensors[0].address = DEFAULT_ADDRESS;
+        count = 1;
+    }
+    for (i = 0; i < count; i++) {
+        sensors[i].enable = ENABLE_PON | ENABLE_AEN;
+        sensors[i].atime = atime;
+        sensors[i].wtime = 0xFF;
+    }
+
+    output.fd = path == NULL ? STDOUT_FILENO : open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (output.fd < 0) {
+        fprintf(stderr, "Failed to open %s (errno %d).\n", path, errno);
+        return 1;
+    }
+    output.buffers[0] = malloc(BUFFER_SIZE);
+    output.buffers[1] = malloc(BUFFER_SIZE);
+    if (output.buffers[0] == NULL || output.buffers[1] == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    output.pending = -1;
+    pthread_mutex_init(&output.lock, NULL);
+    pthread_cond_init(&output.cond, NULL);
+    if (format == TCS3472X_FORMAT_CSV) {
+        output.lengths[0] = strlen(TCS3472X_FORMAT_CSV_HEADER);
+        memcpy(output.buffers[0], TCS3472X_FORMAT_CSV_HEADER, output.lengths[0]);
+    }
+
+    if (tcs3472x_group_init(&group, sensors, count) < 0 || tcs3472x_group_configure(&group) < 0 ||
+        tcs3472x_group_start(&group) < 0) {
+        fprintf(stderr, "Failed to start the sensors.\n");
+        return 1;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _on_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    pthread_create(&writer, NULL, _writer, &output);
+
+    // All sensors share ATIME and WTIME and were started together, so they complete in phase
+    cycle_ns = tcs3472x_group_cycle_ns(&sensors[0]);
+    reserve = (size_t)count * TCS3472X_FORMAT_MAX_SIZE;
+    start_ns = _now_ns();
+    next_ns = sensors[0].start_ns + cycle_ns + READ_MARGIN_NS;
+
+    while (running && (limit == 0 || samples < limit) && (duration_ns == 0 || next_ns - start_ns < duration_ns)) {
+        deadline.tv_sec = next_ns / NS_PER_SEC;
+        deadline.tv_nsec = next_ns % NS_PER_SEC;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        if (!running) {
+            break;
+        }
+        cycles++;
+
+        if (tcs3472x_group_read(&group) < 0) {
+            read_errors++;
+            dropped += count;
+        }
+        else if (output.lengths[output.filling] + reserve > BUFFER_SIZE && !_hand_over(&output)) {
+            dropped += count;
+        }
+        else {
+            buffer = output.buffers[output.filling];
+            for (i = 0; i < count; i++) {
+                sample.timestamp_ns = sensors[i].read_ns;
+                sample.device = i;
+                memcpy(sample.colors, sensors[i].colors, sizeof(sample.colors));
+                output.lengths[output.filling] +=
+                    tcs3472x_format_sample(buffer + output.lengths[output.filling], format, &sample);
+            }
+            samples += count;
+        }
+
+        // Integration ends that passed while this cycle was handled are lost
+        now_ns = _now_ns();
+        next_ns += cycle_ns;
+        if (next_ns <= now_ns) {
+            missed = (uint64_t)((now_ns - next_ns) / cycle_ns + 1);
+            dropped += missed * count;
+            next_ns += (int64_t)missed * cycle_ns;
+        }
+    }
+    end_ns = _now_ns();
+
+    _finish(&output, writer);
+    tcs3472x_group_close(&group);
+    if (path != NULL) {
+        close(output.fd);
+    }
+
+    fprintf(stderr, "%llu samples from %u sensors in %.3f s: %.1f samples/s, expected %.1f\n",
+            (unsigned long long)samples, count, (double)(end_ns - start_ns) / NS_PER_SEC,
+            (double)samples * NS_PER_SEC / (double)(end_ns - start_ns), (double)count * NS_PER_SEC / (double)cycle_ns);
+    fprintf(stderr, "%llu cycles, %llu samples dropped, %llu read errors, %llu bytes written\n",
+            (unsigned long long)cycles, (unsigned long long)dropped, (unsigned long long)read_errors,
+            (unsigned long long)output.bytes);
+    if (output.error != 0) {
+        fprintf(stderr, "Output failed (errno %d).\n", output.error);
+    }
+
+    free(output.buffers[0]);
+    free(output.buffers[1]);
+    return output.error != 0 || samples == 0 ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file tcs3472x_coro_example.cpp
+ * @brief Example application reading a TCS3472x from a C++20 coroutine.
+ *
+ * This program starts one sensor through the group API, services it with a request queue and a
+ * reactor, and prints ten samples, each read right after the sensor reports a completed cycle.
+ */
+
+#include <cstdio>
+
+#include "tcs3472x_coro.hpp"
+
+extern "C" {
+#include "tcs3472x_log_thread.h"
+}
+
+#define BUS_PATH        "/dev/i2c-1"
+#define DEVICE_ADDRESS  0x29
+#define SAMPLE_COUNT    10
+#define LOG_DRAIN_INTERVAL_MS 100
+
+static tcs3472x::task sampler(tcs3472x::reactor &reactor, tcs3472x::async_device &dev) {
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        if (co_await dev.wait_valid() < 0) {
+            break;
+        }
+
+        tcs3472x::sample s = co_await dev.read_sample();
+        if (s.result < 0) {
+            break;
+        }
+        printf("%lld | C = %u | R = %u | G = %u | B = %u |\n", (long long)s.timestamp_ns,
+               s.colors[0], s.colors[1], s.colors[2], s.colors[3]);
+    }
+    reactor.stop();
+}
+
+int main() {
+    tcs3472x_group_sensor_t sensor{};
+    tcs3472x_group_t group;
+    tcs3472x_queue_t queue;
+    tcs3472x::reactor reactor;
+
+    sensor.bus_path = BUS_PATH;
+    sensor.address = DEVICE_ADDRESS;
+    sensor.atime = 0xF6;    // 24 ms
+    sensor.wtime = WTIME_DEFAULT;
+
+    tcs3472x_log_thread_start(LOG_DRAIN_INTERVAL_MS);
+
+    if (!reactor.valid() || tcs3472x_group_init(&group, &sensor, 1) < 0) {
+        printf("Initialization failed.\n");
+        tcs3472x_log_thread_stop();
+        return -1;
+    }
+    if (tcs3472x_group_configure(&group) < 0 || tcs3472x_group_start(&group) < 0 ||
+        tcs3472x_queue_init(&queue, &group) < 0) {
+        printf("Sensor start failed.\n");
+        tcs3472x_group_close(&group);
+        tcs3472x_log_thread_stop();
+        return -1;
+    }
+    reactor.attach(queue);
+
+    tcs3472x::async_device dev(reactor, queue, 0);
+    sampler(reactor, dev);
+    reactor.run();
+
+    tcs3472x_queue_close(&queue);
+    tcs3472x_group_close(&group);
+    tcs3472x_log_thread_stop();
+    return 0;
+}
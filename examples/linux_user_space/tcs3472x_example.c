@@ -11,20 +11,35 @@
 
 #include "tcs3472x_i2c_hal.h"
 #include "tcs3472x.h"
+#include "tcs3472x_log_thread.h"
+#include "tcs3472x_metrics.h"
 
 #define DEVICE_ADDRESS  0x29
+#define LOG_DRAIN_INTERVAL_MS 100
+#define METRICS_PORT 9472
+
+static tcs3472x_metrics_server_t metrics_server;
 
 int main() {
     uint16_t clear_data, red_data, green_data, blue_data = 0;
     uint16_t all_colors[4] = {0};
+    tcs3472x_metrics_device_t metrics_device = { .name = "tcs3472x-0", .stats = tcs3472x_get_stats() };
+
+    tcs3472x_log_thread_start(LOG_DRAIN_INTERVAL_MS); // Print driver messages off the read path
 
     if (tcs3472x_i2c_hal_init(DEVICE_ADDRESS) < 0) {
         printf("I2C initialization failed.\n");
+        tcs3472x_log_thread_stop();
         return -1;
     }
 
     tcs3472x_init(); // Initialize the sensor settings
 
+    // Scrape with: curl http://127.0.0.1:9472/metrics
+    if (tcs3472x_metrics_server_start(&metrics_server, METRICS_PORT, &metrics_device, 1) < 0) {
+        printf("Metrics server failed to start, continuing without metrics.\n");
+    }
+
     while(1) {
         tcs3472x_get_all_colors_data(all_colors); // Read all colors
         clear_data = tcs3472x_get_clear_data();   // Individual clear data
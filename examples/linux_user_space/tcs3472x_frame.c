@@ -0,0 +1,98 @@
+/**
+ * @file tcs3472x_frame.c
+ * @brief Double-buffered planar frame capture for sensor arrays.
+ *
+ * This file implements the frame buffer declared in tcs3472x_frame.h. The producer and consumer
+ * coordinate through two atomics: the producer publishes the index of the frame it just completed,
+ * and the consumer announces the index of the frame it holds. Both use sequentially consistent
+ * ordering, so the producer can never pick the frame the consumer is about to hold.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_frame.h"
+
+int8_t tcs3472x_frame_buffer_init(tcs3472x_frame_buffer_t *fb, uint16_t width, uint16_t height,
+                                  void *storage, size_t storage_size) {
+    uint16_t *base = storage;
+    uint8_t f = 0, c = 0;
+
+    if (storage_size < TCS3472X_FRAME_STORAGE_SIZE(width, height) ||
+        ((uintptr_t)storage % TCS3472X_FRAME_ALIGN) != 0) {
+        LOG_ERROR("Frame storage too small or misaligned.\r\n");
+        return -1;
+    }
+
+    memset(fb, 0, sizeof(*fb));
+    fb->width = width;
+    fb->height = height;
+    fb->plane_stride = TCS3472X_FRAME_PLANE_STRIDE(width, height);
+
+    for (f = 0; f < 2; f++) {
+        for (c = 0; c < TCS3472X_FRAME_CHANNELS; c++) {
+            fb->frames[f].planes[c] = base + (f * TCS3472X_FRAME_CHANNELS + c) * fb->plane_stride;
+        }
+    }
+
+    atomic_init(&fb->published, -1);
+    atomic_init(&fb->held, -1);
+
+    return 0;
+}
+
+int8_t tcs3472x_frame_buffer_capture(tcs3472x_frame_buffer_t *fb, tcs3472x_group_t *group) {
+    const uint32_t pixels = (uint32_t)fb->width * fb->height;
+    tcs3472x_frame_t *frame = NULL;
+    int published = atomic_load(&fb->published);
+    int target = (published < 0) ? 0 : (published ^ 1);
+    uint32_t i = 0;
+
+    if (group->sensor_count != pixels) {
+        LOG_ERROR("Group has %d sensors, frame expects %d.\r\n", group->sensor_count, (int)pixels);
+        return -1;
+    }
+
+    if (atomic_load(&fb->held) == target) {
+        fb->skipped++;
+        return 1;
+    }
+
+    if (tcs3472x_group_read(group) < 0) {
+        return -1;
+    }
+
+    frame = &fb->frames[target];
+    for (i = 0; i < pixels; i++) {
+        frame->planes[TCS3472X_PLANE_CLEAR][i] = group->sensors[i].colors[0];
+        frame->planes[TCS3472X_PLANE_RED][i] = group->sensors[i].colors[1];
+        frame->planes[TCS3472X_PLANE_GREEN][i] = group->sensors[i].colors[2];
+        frame->planes[TCS3472X_PLANE_BLUE][i] = group->sensors[i].colors[3];
+    }
+    frame->timestamp_ns = group->sensors[0].read_ns - group->sensors[0].read_skew_ns;
+    frame->max_read_skew_ns = group->max_read_skew_ns;
+    frame->sequence = ++fb->captured;
+
+    atomic_store(&fb->published, target);
+
+    return 0;
+}
+
+const tcs3472x_frame_t *tcs3472x_frame_buffer_acquire(tcs3472x_frame_buffer_t *fb) {
+    int index = -1;
+
+    do {
+        index = atomic_load(&fb->published);
+        if (index < 0) {
+            return NULL;
+        }
+        atomic_store(&fb->held, index);
+    } while (atomic_load(&fb->published) != index);
+
+    return &fb->frames[index];
+}
+
+void tcs3472x_frame_buffer_release(tcs3472x_frame_buffer_t *fb) {
+    atomic_store(&fb->held, -1);
+}
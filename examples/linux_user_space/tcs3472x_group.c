@@ -0,0 +1,324 @@
+/**
+ * @file tcs3472x_group.c
+ * @brief Synchronized multi-sensor start and read on Linux i2c-dev buses.
+ *
+ * This file implements the bus side of the group API declared in tcs3472x_group.h; the cycle times
+ * are in tcs3472x_group_timing.c so the simulated group can share them. All sensors that share a
+ * bus are handled by one I2C_RDWR ioctl, which the kernel issues as a single sequence of messages
+ * separated by repeated starts, so no other bus user can slip in between the sensors of a group.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>          // For O_RDWR
+#include <sys/ioctl.h>      // For ioctl()
+#include <linux/i2c.h>      // For struct i2c_msg
+#include <linux/i2c-dev.h>  // For I2C_RDWR
+#include <unistd.h>         // For close()
+
+#include "tcs3472x.h"
+#include "tcs3472x_group.h"
+#include "tcs3472x_trace.h"
+
+#define MSGS_PER_SENSOR     2
+#define SENSORS_PER_IOCTL   (I2C_RDWR_IOCTL_MAX_MSGS / MSGS_PER_SENSOR)
+
+typedef enum {
+    GROUP_OP_CONFIGURE,
+    GROUP_OP_START,
+    GROUP_OP_READ,
+} group_op_t;
+
+static int64_t _now_ns(void);
+static int8_t _transfer_chunk(tcs3472x_group_t *group, int fd, group_op_t op,
+                              const uint8_t *indices, uint8_t count);
+static int8_t _transfer_bus(tcs3472x_group_t *group, uint8_t bus_index, group_op_t op);
+
+int8_t tcs3472x_group_init(tcs3472x_group_t *group, tcs3472x_group_sensor_t *sensors, uint8_t count) {
+    uint8_t i = 0, b = 0;
+
+    if (count > TCS3472X_GROUP_MAX_SENSORS) {
+        LOG_ERROR("Too many sensors in group (%d).\r\n", count);
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (sensors[i].bus_path == NULL) {
+            LOG_ERROR("Sensor %d has no bus path.\r\n", i);
+            return -1;
+        }
+    }
+
+    memset(group, 0, sizeof(*group));
+    group->sensors = sensors;
+    group->sensor_count = count;
+
+    for (i = 0; i < count; i++) {
+        for (b = 0; b < group->bus_count; b++) {
+            if (strncmp(group->buses[b].path, sensors[i].bus_path, TCS3472X_GROUP_PATH_LEN) == 0) {
+                break;
+            }
+        }
+
+        if (b == group->bus_count) {
+            if (group->bus_count == TCS3472X_GROUP_MAX_BUSES) {
+                LOG_ERROR("Too many buses in group.\r\n");
+                tcs3472x_group_close(group);
+                return -1;
+            }
+            snprintf(group->buses[b].path, TCS3472X_GROUP_PATH_LEN, "%s", sensors[i].bus_path);
+            group->buses[b].fd = open(sensors[i].bus_path, O_RDWR);
+            if (group->buses[b].fd < 0) {
+                LOG_ERROR("Failed to open I2C bus (errno %d).\r\n", errno);
+                tcs3472x_group_close(group);
+                return -1;
+            }
+            group->bus_count++;
+        }
+
+        sensors[i].bus_index = b;
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_configure(tcs3472x_group_t *group) {
+    uint8_t b = 0;
+
+    for (b = 0; b < group->bus_count; b++) {
+        if (_transfer_bus(group, b, GROUP_OP_CONFIGURE) < 0) {
+            LOG_ERROR("Failed to configure sensors on %s.\r\n", group->buses[b].path);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_start(tcs3472x_group_t *group) {
+    int64_t earliest = INT64_MAX;
+    uint8_t i = 0, b = 0;
+
+    for (b = 0; b < group->bus_count; b++) {
+        if (_transfer_bus(group, b, GROUP_OP_START) < 0) {
+            LOG_ERROR("Failed to start sensors on %s.\r\n", group->buses[b].path);
+            return -1;
+        }
+    }
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (group->sensors[i].start_ns < earliest) {
+            earliest = group->sensors[i].start_ns;
+        }
+    }
+
+    group->max_start_skew_ns = 0;
+    for (i = 0; i < group->sensor_count; i++) {
+        group->sensors[i].start_skew_ns = group->sensors[i].start_ns - earliest;
+        if (group->sensors[i].start_skew_ns > group->max_start_skew_ns) {
+            group->max_start_skew_ns = group->sensors[i].start_skew_ns;
+        }
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_read(tcs3472x_group_t *group) {
+    int64_t earliest = INT64_MAX;
+    uint8_t i = 0, b = 0;
+
+    for (b = 0; b < group->bus_count; b++) {
+        if (_transfer_bus(group, b, GROUP_OP_READ) < 0) {
+            LOG_ERROR("Failed to read sensors on %s.\r\n", group->buses[b].path);
+            return -1;
+        }
+    }
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (group->sensors[i].read_ns < earliest) {
+            earliest = group->sensors[i].read_ns;
+        }
+    }
+
+    group->max_read_skew_ns = 0;
+    for (i = 0; i < group->sensor_count; i++) {
+        group->sensors[i].read_skew_ns = group->sensors[i].read_ns - earliest;
+        if (group->sensors[i].read_skew_ns > group->max_read_skew_ns) {
+            group->max_read_skew_ns = group->sensors[i].read_skew_ns;
+        }
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_read_sensor(tcs3472x_group_t *group, uint8_t index) {
+    const tcs3472x_group_sensor_t *sensor = NULL;
+
+    if (index >= group->sensor_count) {
+        LOG_ERROR("No sensor %d in group.\r\n", index);
+        return -1;
+    }
+    sensor = &group->sensors[index];
+
+    if (_transfer_chunk(group, group->buses[sensor->bus_index].fd, GROUP_OP_READ, &index, 1) < 0) {
+        LOG_ERROR("Failed to read sensor 0x%X on %s.\r\n", sensor->address, sensor->bus_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_close(tcs3472x_group_t *group) {
+    int8_t result = 0;
+    uint8_t b = 0;
+
+    for (b = 0; b < group->bus_count; b++) {
+        if (close(group->buses[b].fd) < 0) {
+            LOG_ERROR("Failed to close I2C bus (errno %d).\r\n", errno);
+            result = -1;
+        }
+    }
+    group->bus_count = 0;
+
+    return result;
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Runs all sensors of one bus through a group operation, in as few ioctls as the kernel allows.
+ *
+ * @param group The group the bus belongs to.
+ * @param bus_index Index of the bus in the group.
+ * @param op Operation to perform.
+ * @return 0 on success, -1 on error.
+ */
+static int8_t _transfer_bus(tcs3472x_group_t *group, uint8_t bus_index, group_op_t op) {
+    uint8_t indices[TCS3472X_GROUP_MAX_SENSORS];
+    uint8_t count = 0, i = 0, offset = 0, chunk = 0;
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (group->sensors[i].bus_index == bus_index) {
+            indices[count++] = i;
+        }
+    }
+
+    for (offset = 0; offset < count; offset += chunk) {
+        chunk = count - offset;
+        if (chunk > SENSORS_PER_IOCTL) {
+            chunk = SENSORS_PER_IOCTL;
+        }
+        if (_transfer_chunk(group, group->buses[bus_index].fd, op, &indices[offset], chunk) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Issues one I2C_RDWR ioctl covering up to SENSORS_PER_IOCTL sensors of the same bus.
+ *
+ * For a configuration, each sensor gets an ATIME write followed by a WTIME write. For a start, the
+ * first half of the messages clears AEN on every sensor and the second half sets it again. For a read,
+ * each sensor gets a command byte write followed by an 8 byte data read. The time each sensor was
+ * touched is interpolated linearly over the duration of the ioctl.
+ *
+ * @param group The group the sensors belong to.
+ * @param fd File descriptor of the bus.
+ * @param op Operation to perform.
+ * @param indices Indices of the sensors in the group.
+ * @param count Number of sensors.
+ * @return 0 on success, -1 on error.
+ */
+static int8_t _transfer_chunk(tcs3472x_group_t *group, int fd, group_op_t op,
+                              const uint8_t *indices, uint8_t count) {
+    struct i2c_msg msgs[SENSORS_PER_IOCTL * MSGS_PER_SENSOR];
+    struct i2c_rdwr_ioctl_data transfer;
+    uint8_t tx[SENSORS_PER_IOCTL][MSGS_PER_SENSOR][2];
+    uint8_t rx[SENSORS_PER_IOCTL][8];
+    tcs3472x_group_sensor_t *sensor = NULL;
+    int64_t t_begin = 0, t_end = 0, span = 0;
+    uint8_t i = 0, enable = 0;
+
+    for (i = 0; i < count; i++) {
+        sensor = &group->sensors[indices[i]];
+
+        if (op == GROUP_OP_CONFIGURE) {
+            tx[i][0][0] = COMMAND_BIT | ATIME_REGISTER;
+            tx[i][0][1] = sensor->atime;
+            tx[i][1][0] = COMMAND_BIT | WTIME_REGISTER;
+            tx[i][1][1] = sensor->wtime;
+
+            msgs[2 * i] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 2, .buf = tx[i][0] };
+            msgs[2 * i + 1] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 2, .buf = tx[i][1] };
+        }
+        else if (op == GROUP_OP_START) {
+            enable = sensor->enable | ENABLE_PON | ENABLE_AEN;
+
+            tx[i][0][0] = COMMAND_BIT | ENABLE_REGISTER;
+            tx[i][0][1] = enable & (uint8_t)~ENABLE_AEN;
+            tx[i][1][0] = COMMAND_BIT | ENABLE_REGISTER;
+            tx[i][1][1] = enable;
+
+            msgs[i] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 2, .buf = tx[i][0] };
+            msgs[count + i] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 2, .buf = tx[i][1] };
+        }
+        else {
+            tx[i][0][0] = COMMAND_BIT | COMMAND_AUTO_INCREMENT | CDATAL_REGISTER;
+
+            msgs[2 * i] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 1, .buf = tx[i][0] };
+            msgs[2 * i + 1] = (struct i2c_msg){ .addr = sensor->address, .flags = I2C_M_RD, .len = 8, .buf = rx[i] };
+        }
+    }
+
+    transfer.msgs = msgs;
+    transfer.nmsgs = count * MSGS_PER_SENSOR;
+
+    TCS3472X_TRACE1(group_start, transfer.nmsgs);
+    t_begin = _now_ns();
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0) {
+        LOG_ERROR("I2C group transfer error (errno %d).\r\n", errno);
+        t_end = _now_ns();
+        for (i = 0; i < count; i++) {
+            tcs3472x_stats_record_transaction(&group->sensors[indices[i]].stats,
+                                              (uint32_t)(t_end - t_begin), -1);
+        }
+        TCS3472X_TRACE2(group_end, transfer.nmsgs, -1);
+        return -1;
+    }
+    t_end = _now_ns();
+    TCS3472X_TRACE2(group_end, transfer.nmsgs, 0);
+    span = t_end - t_begin;
+
+    for (i = 0; i < count; i++) {
+        sensor = &group->sensors[indices[i]];
+        tcs3472x_stats_record_transaction(&sensor->stats, (uint32_t)span, 0);
+
+        if (op == GROUP_OP_CONFIGURE) {
+            continue;
+        }
+        else if (op == GROUP_OP_START) {
+            sensor->start_ns = t_begin + span * (count + i + 1) / (2 * count);
+        }
+        else {
+            sensor->colors[0] = (rx[i][1] << 8) | rx[i][0];
+            sensor->colors[1] = (rx[i][3] << 8) | rx[i][2];
+            sensor->colors[2] = (rx[i][5] << 8) | rx[i][4];
+            sensor->colors[3] = (rx[i][7] << 8) | rx[i][6];
+            sensor->read_ns = t_begin + span * (i + 1) / count;
+            tcs3472x_stats_record_sample(&sensor->stats, sensor->colors[0], sensor->atime);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file tcs3472x_group_timing.c
+ * @brief RGBC cycle times of group sensors.
+ *
+ * This file implements tcs3472x_group_atime_ns() and tcs3472x_group_cycle_ns() declared in
+ * tcs3472x_group.h. They only use the cached register values, so the i2c-dev group and the
+ * simulated group link the same code.
+ */
+
+#include "tcs3472x.h"
+#include "tcs3472x_group.h"
+
+#define CYCLE_STEP_NS       2400000LL   ///< Duration of one ATIME/WTIME step (2.4 ms)
+#define CYCLE_STEPS         256
+
+int64_t tcs3472x_group_atime_ns(const tcs3472x_group_sensor_t *sensor) {
+    return (int64_t)tcs3472x_atime_to_us(sensor->atime) * 1000;
+}
+
+int64_t tcs3472x_group_cycle_ns(const tcs3472x_group_sensor_t *sensor) {
+    int64_t cycle_ns = tcs3472x_group_atime_ns(sensor);
+
+    if (sensor->enable & ENABLE_WEN) {
+        cycle_ns += (CYCLE_STEPS - sensor->wtime) * CYCLE_STEP_NS;
+    }
+    return cycle_ns;
+}
@@ -9,10 +9,17 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <errno.h>
 #include <fcntl.h>          // For O_RDWR
 #include <sys/ioctl.h>      // For ioctl()
-#include <linux/i2c-dev.h>  // For I2C_SLAVE
+#include <linux/i2c.h>      // For struct i2c_msg
+#include <linux/i2c-dev.h>  // For I2C_SLAVE and I2C_RDWR
 #include <unistd.h>         // For close()
+#include <time.h>           // For clock_gettime()
+
+#include "tcs3472x.h"
+#include "tcs3472x_trace.h"
+#include "tcs3472x_stats.h"
 
 #define I2C_DEVICE_PATH "/dev/i2c-1"
 
@@ -20,6 +27,9 @@
 #define I2C_READ_FAILED -2
 
 static int8_t i2c_device = -1; ///< File descriptor for the I2C device.
+static uint16_t i2c_address = 0; ///< Address of the sensor, needed for I2C_RDWR messages.
+
+static int64_t _now_ns(void);
 
 /**
  * Initializes the I2C bus for communication with the sensor.
@@ -29,15 +39,16 @@ static int8_t i2c_device = -1; ///< File descriptor for the I2C device.
 int8_t tcs3472x_i2c_hal_init(int device_address) {
     i2c_device = open(I2C_DEVICE_PATH, O_RDWR);
     if (i2c_device < 0) {
-        perror("Failed to open I2C bus");
+        LOG_ERROR("Failed to open I2C bus (errno %d).\r\n", errno);
         return -1;
     }
     
     if (ioctl(i2c_device, I2C_SLAVE, device_address) < 0) {
-        perror("Failed to set I2C device address");
+        LOG_ERROR("Failed to set I2C device address (errno %d).\r\n", errno);
         close(i2c_device);
         return -1;
     }
+    i2c_address = (uint16_t)device_address;
 
     return 0;
 }
@@ -49,11 +60,18 @@ int8_t tcs3472x_i2c_hal_init(int device_address) {
  * @return 0 on success, I2C_WRITE_FAILED on error.
  */
 int8_t tcs3472x_i2c_hal_write(const uint8_t *buffer, uint16_t length) {
+    int64_t start_ns = _now_ns();
+
+    TCS3472X_TRACE2(i2c_start, 0, length);
     if (write(i2c_device, buffer, length) != length) {
-        perror("I2C write error");
+        LOG_ERROR("I2C write error (errno %d).\r\n", errno);
+        tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), I2C_WRITE_FAILED);
+        TCS3472X_TRACE3(i2c_end, 0, length, I2C_WRITE_FAILED);
         return I2C_WRITE_FAILED;
     }
 
+    tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), 0);
+    TCS3472X_TRACE3(i2c_end, 0, length, 0);
     return 0;
 }
 
@@ -64,11 +82,47 @@ int8_t tcs3472x_i2c_hal_write(const uint8_t *buffer, uint16_t length) {
  * @return 0 on success, I2C_READ_FAILED on error.
  */
 int8_t tcs3472x_i2c_hal_read(uint8_t *buffer, uint16_t length) {
+    int64_t start_ns = _now_ns();
+
+    TCS3472X_TRACE2(i2c_start, 1, length);
     if (read(i2c_device, buffer, length) != length) {
-        perror("I2C read error");
+        LOG_ERROR("I2C read error (errno %d).\r\n", errno);
+        tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), I2C_READ_FAILED);
+        TCS3472X_TRACE3(i2c_end, 1, length, I2C_READ_FAILED);
         return I2C_READ_FAILED;
     }
 
+    tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), 0);
+    TCS3472X_TRACE3(i2c_end, 1, length, 0);
+    return 0;
+}
+
+/**
+ * Writes and then reads data with a repeated START in between, as one I2C_RDWR ioctl.
+ * @param tx Pointer to the data to write.
+ * @param tx_length Number of bytes to write.
+ * @param rx Pointer to the buffer where read data will be stored.
+ * @param rx_length Number of bytes to read.
+ * @return 0 on success, I2C_READ_FAILED on error.
+ */
+int8_t tcs3472x_i2c_hal_write_read(const uint8_t *tx, uint16_t tx_length, uint8_t *rx, uint16_t rx_length) {
+    struct i2c_msg msgs[2] = {
+        { .addr = i2c_address, .flags = 0, .len = tx_length, .buf = (uint8_t *)tx },
+        { .addr = i2c_address, .flags = I2C_M_RD, .len = rx_length, .buf = rx },
+    };
+    struct i2c_rdwr_ioctl_data transfer = { .msgs = msgs, .nmsgs = 2 };
+    int64_t start_ns = _now_ns();
+
+    TCS3472X_TRACE2(i2c_start, 1, tx_length + rx_length);
+    if (ioctl(i2c_device, I2C_RDWR, &transfer) < 0) {
+        LOG_ERROR("I2C write/read error (errno %d).\r\n", errno);
+        tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), I2C_READ_FAILED);
+        TCS3472X_TRACE3(i2c_end, 1, tx_length + rx_length, I2C_READ_FAILED);
+        return I2C_READ_FAILED;
+    }
+
+    tcs3472x_stats_record_transaction(tcs3472x_get_stats(), (uint32_t)(_now_ns() - start_ns), 0);
+    TCS3472X_TRACE3(i2c_end, 1, tx_length + rx_length, 0);
     return 0;
 }
 
@@ -78,8 +132,18 @@ int8_t tcs3472x_i2c_hal_read(uint8_t *buffer, uint16_t length) {
  */
 int8_t tcs3472x_i2c_hal_close(void) {
     if (close(i2c_device) < 0) {
-        perror("Failed to close I2C device");
+        LOG_ERROR("Failed to close I2C device (errno %d).\r\n", errno);
         return -1;
     }
     return 0;
 }
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
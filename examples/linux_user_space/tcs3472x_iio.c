@@ -0,0 +1,396 @@
+/**
+ * @file tcs3472x_iio.c
+ * @brief Linux IIO backend reading the kernel tcs3472 driver's triggered buffer.
+ *
+ * This file implements the functions declared in tcs3472x_iio.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_iio.h"
+
+#define VALUE_SIZE          64
+#define DEVICE_NAME         "tcs3472"
+#define DEVICE_PREFIX       "iio:device"
+#define TRIGGER_PREFIX      "trigger"
+#define TIMESTAMP_CHANNEL   4
+
+#define DEFAULT_TRIGGER     "tcs3472x"
+#define DEFAULT_SAMPLING_HZ 100
+#define DEFAULT_LENGTH      1024
+#define DEFAULT_WATERMARK   128
+
+static const char *channel_names[TCS3472X_IIO_CHANNELS] = {
+    "in_intensity_clear", "in_intensity_red", "in_intensity_green", "in_intensity_blue", "in_timestamp",
+};
+
+static int8_t _join(char *path, const char *dir, const char *name);
+static int8_t _read_attr(const char *dir, const char *name, char *value, size_t size);
+static int8_t _write_attr(const char *dir, const char *name, const char *value);
+static int8_t _find_entry(const char *dir, const char *prefix, const char *name, char *path, unsigned *number);
+static int8_t _setup_trigger(const tcs3472x_iio_config_t *config, char *trigger_dir);
+static int8_t _setup_channel(tcs3472x_iio_t *iio, uint8_t channel, uint8_t enable, uint32_t *index);
+static void _layout(tcs3472x_iio_t *iio, const uint32_t index[TCS3472X_IIO_CHANNELS]);
+static uint64_t _extract(const uint8_t *scan, const tcs3472x_iio_channel_t *channel);
+
+void tcs3472x_iio_config_default(tcs3472x_iio_config_t *config) {
+    config->sysfs_root = "/sys";
+    config->dev_root = "/dev";
+    config->trigger = DEFAULT_TRIGGER;
+    config->sampling_hz = DEFAULT_SAMPLING_HZ;
+    config->buffer_length = DEFAULT_LENGTH;
+    config->watermark = DEFAULT_WATERMARK;
+    config->timestamp = 1;
+}
+
+int8_t tcs3472x_iio_open(tcs3472x_iio_t *iio, const tcs3472x_iio_config_t *config) {
+    char devices[TCS3472X_IIO_PATH_SIZE];
+    char path[TCS3472X_IIO_PATH_SIZE];
+    char value[VALUE_SIZE];
+    uint32_t index[TCS3472X_IIO_CHANNELS] = {0};
+    unsigned number = 0;
+    uint8_t i = 0;
+
+    memset(iio, 0, sizeof(*iio));
+    iio->fd = -1;
+    iio->timestamp = config->timestamp != 0;
+
+    if (_join(devices, config->sysfs_root, "bus/iio/devices") < 0 ||
+        _find_entry(devices, DEVICE_PREFIX, DEVICE_NAME, iio->device_dir, &number) < 0) {
+        LOG_ERROR("No " DEVICE_NAME " IIO device found.\r\n");
+        return -1;
+    }
+
+    // Scan elements and the trigger can only change while the buffer is disabled
+    if (_write_attr(iio->device_dir, "buffer/enable", "0") < 0) {
+        return -1;
+    }
+    for (i = 0; i < TCS3472X_IIO_CHANNELS; i++) {
+        if (_setup_channel(iio, i, i != TIMESTAMP_CHANNEL || iio->timestamp, &index[i]) < 0) {
+            return -1;
+        }
+    }
+    _layout(iio, index);
+
+    if (config->trigger != NULL) {
+        if (_setup_trigger(config, path) < 0 ||
+            _write_attr(iio->device_dir, "trigger/current_trigger", config->trigger) < 0) {
+            return -1;
+        }
+    }
+
+    snprintf(value, sizeof(value), "%u", config->buffer_length);
+    if (_write_attr(iio->device_dir, "buffer/length", value) < 0) {
+        return -1;
+    }
+    // Kernels before 4.2 have no watermark and wake the reader for every scan
+    if (config->watermark != 0 && _join(path, iio->device_dir, "buffer/watermark") == 0 && access(path, F_OK) == 0) {
+        snprintf(value, sizeof(value), "%u", config->watermark);
+        if (_write_attr(iio->device_dir, "buffer/watermark", value) < 0) {
+            return -1;
+        }
+    }
+    if (_write_attr(iio->device_dir, "buffer/enable", "1") < 0) {
+        return -1;
+    }
+
+    snprintf(value, sizeof(value), DEVICE_PREFIX "%u", number);
+    if (_join(path, config->dev_root, value) < 0) {
+        return -1;
+    }
+    iio->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (iio->fd < 0) {
+        LOG_ERROR("Failed to open IIO character device (errno %d).\r\n", errno);
+        _write_attr(iio->device_dir, "buffer/enable", "0");
+        return -1;
+    }
+    return 0;
+}
+
+int32_t tcs3472x_iio_read(tcs3472x_iio_t *iio, uint16_t (*colors)[4], int64_t *timestamps_ns, uint32_t count) {
+    const uint32_t capacity = TCS3472X_IIO_BLOCK_SIZE / iio->scan_size * iio->scan_size;
+    uint32_t wanted = 0, available = 0, scans = 0, i = 0;
+    const uint8_t *scan = NULL;
+    ssize_t length = 0;
+    uint8_t c = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+    wanted = count > capacity / iio->scan_size ? capacity : count * iio->scan_size;
+
+    // A read may end inside a scan, so keep reading until one is complete
+    do {
+        length = read(iio->fd, iio->block + iio->pending, wanted - iio->pending);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0) {
+            LOG_ERROR("Failed to read IIO buffer (errno %d).\r\n", errno);
+            return -1;
+        }
+        if (length == 0) {
+            return 0;
+        }
+        iio->pending += (uint16_t)length;
+        iio->reads++;
+    } while (iio->pending < iio->scan_size);
+
+    available = iio->pending;
+    scans = available / iio->scan_size;
+    for (i = 0; i < scans; i++) {
+        scan = iio->block + i * iio->scan_size;
+        for (c = 0; c < 4; c++) {
+            colors[i][c] = (uint16_t)_extract(scan, &iio->channels[c]);
+        }
+        if (timestamps_ns != NULL) {
+            timestamps_ns[i] = iio->timestamp ? (int64_t)_extract(scan, &iio->channels[TIMESTAMP_CHANNEL]) : 0;
+        }
+    }
+
+    iio->pending = (uint16_t)(available - scans * iio->scan_size);
+    memmove(iio->block, iio->block + scans * iio->scan_size, iio->pending);
+    iio->scans += scans;
+    return (int32_t)scans;
+}
+
+void tcs3472x_iio_close(tcs3472x_iio_t *iio) {
+    if (iio->fd >= 0) {
+        close(iio->fd);
+        iio->fd = -1;
+        _write_attr(iio->device_dir, "buffer/enable", "0");
+    }
+}
+
+/**
+ * Joins a directory and a relative name into a path.
+ *
+ * @return 0 on success, -1 if the path does not fit.
+ */
+static int8_t _join(char *path, const char *dir, const char *name) {
+    if (snprintf(path, TCS3472X_IIO_PATH_SIZE, "%s/%s", dir, name) >= TCS3472X_IIO_PATH_SIZE) {
+        LOG_ERROR("IIO path too long.\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Reads a sysfs attribute without its trailing newline.
+ */
+static int8_t _read_attr(const char *dir, const char *name, char *value, size_t size) {
+    char path[TCS3472X_IIO_PATH_SIZE];
+    ssize_t length = 0;
+    int fd = -1;
+
+    if (_join(path, dir, name) < 0) {
+        return -1;
+    }
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    length = read(fd, value, size - 1);
+    close(fd);
+    if (length < 0) {
+        LOG_ERROR("Failed to read IIO attribute (errno %d).\r\n", errno);
+        return -1;
+    }
+    while (length > 0 && (value[length - 1] == '\n' || value[length - 1] == '\r')) {
+        length--;
+    }
+    value[length] = '\0';
+    return 0;
+}
+
+/**
+ * Writes a sysfs attribute in one write.
+ */
+static int8_t _write_attr(const char *dir, const char *name, const char *value) {
+    char path[TCS3472X_IIO_PATH_SIZE];
+    size_t length = strlen(value);
+    int fd = -1;
+
+    if (_join(path, dir, name) < 0) {
+        return -1;
+    }
+    // O_TRUNC is ignored by sysfs and replaces the value of a regular file standing in for it
+    fd = open(path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open IIO attribute for writing (errno %d).\r\n", errno);
+        return -1;
+    }
+    if (write(fd, value, length) != (ssize_t)length) {
+        LOG_ERROR("Failed to write IIO attribute (errno %d).\r\n", errno);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+/**
+ * Finds the entry <prefix>N of a directory whose name attribute matches.
+ *
+ * @return 0 with the entry's path and N, or -1 if none matches.
+ */
+static int8_t _find_entry(const char *dir, const char *prefix, const char *name, char *path, unsigned *number) {
+    const size_t prefix_length = strlen(prefix);
+    char value[VALUE_SIZE];
+    struct dirent *entry = NULL;
+    DIR *handle = opendir(dir);
+    int8_t result = -1;
+
+    if (handle == NULL) {
+        return -1;
+    }
+    while (result < 0 && (entry = readdir(handle)) != NULL) {
+        if (strncmp(entry->d_name, prefix, prefix_length) != 0 ||
+            sscanf(entry->d_name + prefix_length, "%u", number) != 1 ||
+            _join(path, dir, entry->d_name) < 0 ||
+            _read_attr(path, "name", value, sizeof(value)) < 0) {
+            continue;
+        }
+        if (strcmp(value, name) == 0) {
+            result = 0;
+        }
+    }
+    closedir(handle);
+    return result;
+}
+
+/**
+ * Finds the trigger, creating it as an hrtimer trigger if it does not exist, and sets its frequency.
+ */
+static int8_t _setup_trigger(const tcs3472x_iio_config_t *config, char *trigger_dir) {
+    char devices[TCS3472X_IIO_PATH_SIZE];
+    char hrtimers[TCS3472X_IIO_PATH_SIZE];
+    char configfs[TCS3472X_IIO_PATH_SIZE];
+    char value[VALUE_SIZE];
+    unsigned number = 0;
+
+    if (_join(devices, config->sysfs_root, "bus/iio/devices") < 0) {
+        return -1;
+    }
+    if (_find_entry(devices, TRIGGER_PREFIX, config->trigger, trigger_dir, &number) < 0) {
+        if (_join(hrtimers, config->sysfs_root, "kernel/config/iio/triggers/hrtimer") < 0 ||
+            _join(configfs, hrtimers, config->trigger) < 0) {
+            return -1;
+        }
+        if (mkdir(configfs, 0755) < 0 && errno != EEXIST) {
+            LOG_ERROR("Failed to create hrtimer trigger (errno %d).\r\n", errno);
+            return -1;
+        }
+        if (_find_entry(devices, TRIGGER_PREFIX, config->trigger, trigger_dir, &number) < 0) {
+            LOG_ERROR("IIO trigger not found.\r\n");
+            return -1;
+        }
+    }
+
+    if (config->sampling_hz != 0) {
+        snprintf(value, sizeof(value), "%u", config->sampling_hz);
+        if (_write_attr(trigger_dir, "sampling_frequency", value) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Enables or disables a scan element and reads its index and type.
+ */
+static int8_t _setup_channel(tcs3472x_iio_t *iio, uint8_t channel, uint8_t enable, uint32_t *index) {
+    char name[VALUE_SIZE];
+    char value[VALUE_SIZE];
+    tcs3472x_iio_channel_t *format = &iio->channels[channel];
+    char endian[3] = {0};
+    char sign = 0;
+    unsigned bits = 0, storage = 0, shift = 0;
+
+    snprintf(name, sizeof(name), "scan_elements/%s_en", channel_names[channel]);
+    if (_write_attr(iio->device_dir, name, enable ? "1" : "0") < 0) {
+        return -1;
+    }
+    if (!enable) {
+        return 0;
+    }
+
+    snprintf(name, sizeof(name), "scan_elements/%s_index", channel_names[channel]);
+    if (_read_attr(iio->device_dir, name, value, sizeof(value)) < 0 || sscanf(value, "%u", index) != 1) {
+        LOG_ERROR("Failed to read scan index of channel %s.\r\n", channel_names[channel]);
+        return -1;
+    }
+
+    // For example le:u16/16>>0, or be:s64/64>>0
+    snprintf(name, sizeof(name), "scan_elements/%s_type", channel_names[channel]);
+    if (_read_attr(iio->device_dir, name, value, sizeof(value)) < 0 ||
+        sscanf(value, "%2[bel]:%c%u/%u>>%u", endian, &sign, &bits, &storage, &shift) != 5 ||
+        (storage != 8 && storage != 16 && storage != 32 && storage != 64) || bits == 0 || bits + shift > storage) {
+        LOG_ERROR("Unsupported scan type for channel %s.\r\n", channel_names[channel]);
+        return -1;
+    }
+    format->bytes = (uint8_t)(storage / 8);
+    format->bits = (uint8_t)bits;
+    format->shift = (uint8_t)shift;
+    format->big_endian = strcmp(endian, "be") == 0;
+    format->is_signed = sign == 's';
+    return 0;
+}
+
+/**
+ * Places the enabled channels in index order, each aligned to its own size, and pads the scan to a
+ * multiple of its largest channel, as the IIO core does.
+ */
+static void _layout(tcs3472x_iio_t *iio, const uint32_t index[TCS3472X_IIO_CHANNELS]) {
+    const uint8_t channels = iio->timestamp ? TCS3472X_IIO_CHANNELS : TCS3472X_IIO_CHANNELS - 1;
+    uint8_t placed[TCS3472X_IIO_CHANNELS] = {0};
+    uint8_t offset = 0, largest = 1, next = 0, i = 0, n = 0;
+    tcs3472x_iio_channel_t *channel = NULL;
+
+    for (n = 0; n < channels; n++) {
+        next = TCS3472X_IIO_CHANNELS;
+        for (i = 0; i < channels; i++) {
+            if (!placed[i] && (next == TCS3472X_IIO_CHANNELS || index[i] < index[next])) {
+                next = i;
+            }
+        }
+        placed[next] = 1;
+        channel = &iio->channels[next];
+        offset = (uint8_t)((offset + channel->bytes - 1) / channel->bytes * channel->bytes);
+        channel->offset = offset;
+        offset += channel->bytes;
+        if (channel->bytes > largest) {
+            largest = channel->bytes;
+        }
+    }
+    iio->scan_size = (uint8_t)((offset + largest - 1) / largest * largest);
+}
+
+/**
+ * Extracts one channel value from a packed scan, sign-extended for signed channels.
+ */
+static uint64_t _extract(const uint8_t *scan, const tcs3472x_iio_channel_t *channel) {
+    const uint8_t *bytes = scan + channel->offset;
+    uint64_t value = 0;
+    uint8_t i = 0;
+
+    for (i = 0; i < channel->bytes; i++) {
+        value |= (uint64_t)bytes[channel->big_endian ? i : channel->bytes - 1 - i] << (8 * (channel->bytes - 1 - i));
+    }
+    value >>= channel->shift;
+    if (channel->bits < 64) {
+        value &= (1ULL << channel->bits) - 1;
+        if (channel->is_signed && (value >> (channel->bits - 1)) != 0) {
+            value |= ~0ULL << channel->bits;
+        }
+    }
+    return value;
+}
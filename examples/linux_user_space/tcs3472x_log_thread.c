@@ -0,0 +1,55 @@
+/**
+ * @file tcs3472x_log_thread.c
+ * @brief Background thread draining the deferred log ring on Linux.
+ *
+ * This file implements the functions declared in tcs3472x_log_thread.h.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "tcs3472x_log.h"
+#include "tcs3472x_log_thread.h"
+
+static pthread_t drain_thread;
+static atomic_int drain_running = 0;
+static uint32_t drain_interval_ms = 0;
+
+/**
+ * Drain thread body: drain, sleep, repeat until stopped, then drain once more.
+ */
+static void *_drain_thread(void *arg) {
+    struct timespec interval = {
+        .tv_sec = drain_interval_ms / 1000,
+        .tv_nsec = (drain_interval_ms % 1000) * 1000000L,
+    };
+
+    (void)arg;
+
+    while (atomic_load(&drain_running)) {
+        tcs3472x_log_drain();
+        nanosleep(&interval, NULL);
+    }
+    tcs3472x_log_drain();
+
+    return NULL;
+}
+
+int8_t tcs3472x_log_thread_start(uint32_t interval_ms) {
+    drain_interval_ms = interval_ms;
+    atomic_store(&drain_running, 1);
+
+    if (pthread_create(&drain_thread, NULL, _drain_thread, NULL) != 0) {
+        atomic_store(&drain_running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+void tcs3472x_log_thread_stop(void) {
+    if (atomic_exchange(&drain_running, 0)) {
+        pthread_join(drain_thread, NULL);
+    }
+}
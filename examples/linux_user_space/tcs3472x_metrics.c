@@ -0,0 +1,248 @@
+/**
+ * @file tcs3472x_metrics.c
+ * @brief Prometheus text-format exporter for TCS3472x device counters on Linux.
+ *
+ * This file implements the functions declared in tcs3472x_metrics.h.
+ */
+
+#define _GNU_SOURCE         // For accept4()
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_metrics.h"
+
+#define PATH_SIZE           256
+#define REQUEST_SIZE        1024
+#define LISTEN_BACKLOG      4
+#define POLL_INTERVAL_MS    200     ///< How often the server thread checks whether it should stop
+
+static const char HTTP_HEADER[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+/**
+ * A counter family: metric name, help text and where its value lives in the counters.
+ */
+typedef struct {
+    const char *name;
+    const char *help;
+    size_t offset;
+} counter_family_t;
+
+static const counter_family_t COUNTER_FAMILIES[] = {
+    { "tcs3472x_samples_total", "Color samples read.", offsetof(tcs3472x_stats_t, samples) },
+    { "tcs3472x_saturations_total", "Samples whose clear channel reached full scale.", offsetof(tcs3472x_stats_t, saturations) },
+    { "tcs3472x_transactions_total", "Bus transactions issued.", offsetof(tcs3472x_stats_t, transactions) },
+    { "tcs3472x_errors_total", "Failed bus transactions.", offsetof(tcs3472x_stats_t, errors) },
+    { "tcs3472x_retries_total", "Operations repeated after a failure.", offsetof(tcs3472x_stats_t, retries) },
+};
+
+static int8_t _append(char *buffer, uint32_t size, uint32_t *used, const char *format, ...);
+static void *_server_thread(void *arg);
+
+int32_t tcs3472x_metrics_render(char *buffer, uint32_t size, const tcs3472x_metrics_device_t *devices,
+                                uint8_t count) {
+    const char *latency = "tcs3472x_transaction_latency_seconds";
+    const tcs3472x_stats_t *stats = NULL;
+    uint32_t used = 0, cumulative = 0, value = 0;
+    uint8_t f = 0, d = 0, b = 0;
+    int8_t status = 0;
+
+    if (size == 0) {
+        return -1;
+    }
+    buffer[0] = '\0';
+
+    for (f = 0; f < sizeof(COUNTER_FAMILIES) / sizeof(COUNTER_FAMILIES[0]); f++) {
+        status |= _append(buffer, size, &used, "# HELP %s %s\n# TYPE %s counter\n",
+                          COUNTER_FAMILIES[f].name, COUNTER_FAMILIES[f].help, COUNTER_FAMILIES[f].name);
+        for (d = 0; d < count; d++) {
+            memcpy(&value, (const uint8_t *)devices[d].stats + COUNTER_FAMILIES[f].offset, sizeof(value));
+            status |= _append(buffer, size, &used, "%s{device=\"%s\"} %u\n",
+                              COUNTER_FAMILIES[f].name, devices[d].name, value);
+        }
+    }
+
+    status |= _append(buffer, size, &used, "# HELP %s Duration of bus transactions.\n# TYPE %s histogram\n",
+                      latency, latency);
+    for (d = 0; d < count; d++) {
+        stats = devices[d].stats;
+        cumulative = 0;
+        for (b = 0; b < TCS3472X_STATS_LATENCY_BUCKETS - 1; b++) {
+            cumulative += stats->latency_buckets[b];
+            status |= _append(buffer, size, &used, "%s_bucket{device=\"%s\",le=\"%u.%06u\"} %u\n",
+                              latency, devices[d].name, tcs3472x_stats_latency_bounds_us[b] / 1000000,
+                              tcs3472x_stats_latency_bounds_us[b] % 1000000, cumulative);
+        }
+        cumulative += stats->latency_buckets[b];
+        status |= _append(buffer, size, &used, "%s_bucket{device=\"%s\",le=\"+Inf\"} %u\n",
+                          latency, devices[d].name, cumulative);
+        status |= _append(buffer, size, &used, "%s_sum{device=\"%s\"} %llu.%09llu\n",
+                          latency, devices[d].name,
+                          (unsigned long long)(stats->latency_sum_ns / 1000000000ULL),
+                          (unsigned long long)(stats->latency_sum_ns % 1000000000ULL));
+        status |= _append(buffer, size, &used, "%s_count{device=\"%s\"} %u\n",
+                          latency, devices[d].name, cumulative);
+    }
+
+    return status < 0 ? -1 : (int32_t)used;
+}
+
+int8_t tcs3472x_metrics_write_file(const char *path, const char *text, uint32_t length) {
+    char tmp_path[PATH_SIZE];
+    uint32_t written = 0;
+    ssize_t result = 0;
+    int fd = -1;
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        LOG_ERROR("Metrics file path too long.\r\n");
+        return -1;
+    }
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create metrics file (errno %d).\r\n", errno);
+        return -1;
+    }
+
+    while (written < length) {
+        result = write(fd, text + written, length - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Failed to write metrics file (errno %d).\r\n", errno);
+            close(fd);
+            unlink(tmp_path);
+            return -1;
+        }
+        written += (uint32_t)result;
+    }
+
+    if (close(fd) < 0 || rename(tmp_path, path) < 0) {
+        LOG_ERROR("Failed to replace metrics file (errno %d).\r\n", errno);
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int8_t tcs3472x_metrics_server_start(tcs3472x_metrics_server_t *server, uint16_t port,
+                                     const tcs3472x_metrics_device_t *devices, uint8_t count) {
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int reuse = 1;
+
+    server->devices = devices;
+    server->count = count;
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        LOG_ERROR("Failed to create metrics socket (errno %d).\r\n", errno);
+        return -1;
+    }
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(server->listen_fd, LISTEN_BACKLOG) < 0) {
+        LOG_ERROR("Failed to listen on metrics port %u (errno %d).\r\n", port, errno);
+        close(server->listen_fd);
+        return -1;
+    }
+
+    atomic_store(&server->running, 1);
+    if (pthread_create(&server->thread, NULL, _server_thread, server) != 0) {
+        LOG_ERROR("Failed to create metrics server thread.\r\n");
+        atomic_store(&server->running, 0);
+        close(server->listen_fd);
+        return -1;
+    }
+    return 0;
+}
+
+void tcs3472x_metrics_server_stop(tcs3472x_metrics_server_t *server) {
+    if (atomic_exchange(&server->running, 0)) {
+        pthread_join(server->thread, NULL);
+        close(server->listen_fd);
+    }
+}
+
+/**
+ * Appends formatted text to a buffer.
+ *
+ * @return 0 on success, -1 if the text did not fit; the buffer stays NUL-terminated either way.
+ */
+static int8_t _append(char *buffer, uint32_t size, uint32_t *used, const char *format, ...) {
+    va_list ap;
+    int written = 0;
+
+    if (*used + 1 >= size) {
+        return -1;
+    }
+
+    va_start(ap, format);
+    written = vsnprintf(buffer + *used, size - *used, format, ap);
+    va_end(ap);
+
+    if (written < 0 || (uint32_t)written >= size - *used) {
+        buffer[*used] = '\0';
+        *used = size - 1;
+        return -1;
+    }
+    *used += (uint32_t)written;
+    return 0;
+}
+
+/**
+ * Server thread body: answers each connection with the current metrics until stopped.
+ */
+static void *_server_thread(void *arg) {
+    tcs3472x_metrics_server_t *server = arg;
+    struct pollfd pfd = { .fd = server->listen_fd, .events = POLLIN };
+    char request[REQUEST_SIZE];
+    int32_t length = 0;
+    int client = -1;
+
+    while (atomic_load(&server->running)) {
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        client = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+
+        // The request itself is not inspected; read what has arrived so closing does not reset it
+        (void)recv(client, request, sizeof(request), MSG_DONTWAIT);
+
+        length = tcs3472x_metrics_render(server->buffer, sizeof(server->buffer), server->devices,
+                                         server->count);
+        if (length < 0) {
+            LOG_ERROR("Metrics do not fit in %u bytes.\r\n", TCS3472X_METRICS_BUFFER_SIZE);
+        }
+        else if (send(client, HTTP_HEADER, sizeof(HTTP_HEADER) - 1, MSG_NOSIGNAL) < 0 ||
+                 send(client, server->buffer, (size_t)length, MSG_NOSIGNAL) < 0) {
+            LOG_ERROR("Failed to send metrics (errno %d).\r\n", errno);
+        }
+        close(client);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file tcs3472x_pool.c
+ * @brief Work-stealing thread pool running parallel loops over sensors on Linux.
+ *
+ * This file implements the functions declared in tcs3472x_pool.h. The deque follows Chase and Lev,
+ * "Dynamic Circular Work-Stealing Deque", with the C11 orderings of Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models", minus resizing: ranges are only pushed while one
+ * is split, so a deque never holds more than 32 of them.
+ */
+
+#include <errno.h>
+#include <sched.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_pool.h"
+
+#define EMPTY           0ULL    ///< No range; an empty range is never pushed
+#define DEQUE_MASK      (TCS3472X_POOL_DEQUE_SIZE - 1)
+#define BATCHES_PER_WORKER  8
+
+static void _push(tcs3472x_pool_deque_t *deque, uint64_t range);
+static uint64_t _pop(tcs3472x_pool_deque_t *deque);
+static uint64_t _steal(tcs3472x_pool_deque_t *deque);
+static void _work(tcs3472x_pool_t *pool, uint32_t self, tcs3472x_pool_fn_t fn, void *context, uint32_t batch);
+static void *_worker(void *arg);
+
+int8_t tcs3472x_pool_start(tcs3472x_pool_t *pool, uint32_t workers) {
+    uint32_t i = 0;
+    int error = 0;
+
+    if (workers == 0 || workers > TCS3472X_POOL_MAX_WORKERS) {
+        LOG_ERROR("Pool needs 1 to %d workers.\r\n", TCS3472X_POOL_MAX_WORKERS);
+        return -1;
+    }
+
+    pool->workers = workers;
+    pool->generation = 0;
+    pool->finished = workers - 1;
+    pool->stop = 0;
+    pool->runs = 0;
+    atomic_init(&pool->next_worker, 1);
+    atomic_init(&pool->remaining, 0);
+    atomic_init(&pool->batches, 0);
+    atomic_init(&pool->splits, 0);
+    atomic_init(&pool->steals, 0);
+    for (i = 0; i < workers; i++) {
+        atomic_init(&pool->deques[i].top, 0);
+        atomic_init(&pool->deques[i].bottom, 0);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (i = 1; i < workers; i++) {
+        error = pthread_create(&pool->threads[i], NULL, _worker, pool);
+        if (error != 0) {
+            LOG_ERROR("Failed to create pool worker %u (errno %d).\r\n", i, error);
+            pool->workers = i;
+            tcs3472x_pool_stop(pool);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void tcs3472x_pool_run(tcs3472x_pool_t *pool, tcs3472x_pool_fn_t fn, void *context, uint32_t count, uint32_t batch) {
+    if (count == 0) {
+        return;
+    }
+    if (batch == 0) {
+        batch = count / (BATCHES_PER_WORKER * pool->workers);
+        batch = batch == 0 ? 1 : batch;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->context = context;
+    pool->batch = batch;
+    pool->finished = 0;
+    atomic_store_explicit(&pool->remaining, count, memory_order_relaxed);
+    _push(&pool->deques[0], (uint64_t)count);
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    _work(pool, 0, fn, context, batch);
+
+    // Every worker checks in for every job, so none can carry this job's function into the next
+    pthread_mutex_lock(&pool->lock);
+    while (pool->finished < pool->workers - 1) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pool->runs++;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void tcs3472x_pool_get_stats(tcs3472x_pool_t *pool, tcs3472x_pool_stats_t *stats) {
+    pthread_mutex_lock(&pool->lock);
+    stats->runs = pool->runs;
+    pthread_mutex_unlock(&pool->lock);
+    stats->batches = atomic_load(&pool->batches);
+    stats->splits = atomic_load(&pool->splits);
+    stats->steals = atomic_load(&pool->steals);
+}
+
+void tcs3472x_pool_stop(tcs3472x_pool_t *pool) {
+    uint32_t i = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 1; i < pool->workers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * Pushes a range onto the owner's end of a deque. Owner only.
+ */
+static void _push(tcs3472x_pool_deque_t *deque, uint64_t range) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+
+    atomic_store_explicit(&deque->ranges[bottom & DEQUE_MASK], range, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+}
+
+/**
+ * Takes the newest range of a deque. Owner only.
+ *
+ * @return The range, or EMPTY.
+ */
+static uint64_t _pop(tcs3472x_pool_deque_t *deque) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    long long top = 0;
+    uint64_t range = EMPTY;
+
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top <= bottom) {
+        range = atomic_load_explicit(&deque->ranges[bottom & DEQUE_MASK], memory_order_relaxed);
+        if (top == bottom) {
+            // Last range: race the thieves for it
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                range = EMPTY;
+            }
+            atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        }
+    }
+    else {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return range;
+}
+
+/**
+ * Takes the oldest range of another worker's deque.
+ *
+ * @return The range, or EMPTY if the deque is empty or another thread won it.
+ */
+static uint64_t _steal(tcs3472x_pool_deque_t *deque) {
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    long long bottom = 0;
+    uint64_t range = EMPTY;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top < bottom) {
+        range = atomic_load_explicit(&deque->ranges[top & DEQUE_MASK], memory_order_relaxed);
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            range = EMPTY;
+        }
+    }
+    return range;
+}
+
+/**
+ * Processes ranges from the own deque, or stolen ones, until the job has no indexes left.
+ */
+static void _work(tcs3472x_pool_t *pool, uint32_t self, tcs3472x_pool_fn_t fn, void *context, uint32_t batch) {
+    tcs3472x_pool_deque_t *own = &pool->deques[self];
+    uint64_t range = EMPTY;
+    uint32_t begin = 0, end = 0, middle = 0, victim = self, tries = 0;
+
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0) {
+        range = _pop(own);
+        for (tries = 1; range == EMPTY && tries < pool->workers; tries++) {
+            victim = victim + 1 == pool->workers ? 0 : victim + 1;
+            if (victim != self) {
+                range = _steal(&pool->deques[victim]);
+                if (range != EMPTY) {
+                    atomic_fetch_add_explicit(&pool->steals, 1, memory_order_relaxed);
+                }
+            }
+        }
+        if (range == EMPTY) {
+            sched_yield();
+            continue;
+        }
+
+        begin = (uint32_t)(range >> 32);
+        end = (uint32_t)range;
+        while (end - begin > batch) {
+            middle = begin + (end - begin) / 2;
+            _push(own, (uint64_t)middle << 32 | end);
+            atomic_fetch_add_explicit(&pool->splits, 1, memory_order_relaxed);
+            end = middle;
+        }
+        fn(context, begin, end);
+        atomic_fetch_add_explicit(&pool->batches, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&pool->remaining, end - begin, memory_order_release);
+    }
+}
+
+/**
+ * Waits for jobs and works on each of them until the pool stops.
+ */
+static void *_worker(void *arg) {
+    tcs3472x_pool_t *pool = arg;
+    const uint32_t self = atomic_fetch_add(&pool->next_worker, 1);
+    tcs3472x_pool_fn_t fn = NULL;
+    void *context = NULL;
+    uint64_t seen = 0;
+    uint32_t batch = 0;
+
+    // Jobs are counted from the start, so one submitted before this thread ran is not missed
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        fn = pool->fn;
+        context = pool->context;
+        batch = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        _work(pool, self, fn, context, batch);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->finished++;
+        pthread_cond_signal(&pool->idle);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
@@ -0,0 +1,356 @@
+/**
+ * @file tcs3472x_queue.c
+ * @brief Submission/completion queue for TCS3472x operations on Linux i2c-dev buses.
+ *
+ * This file implements the functions declared in tcs3472x_queue.h. Each worker takes its whole pending
+ * list at once and packs it into as few I2C_RDWR ioctls as the message limit allows. The kernel does
+ * not report which message of a failed ioctl went wrong, so a failed batch is replayed one request per
+ * ioctl to fail only the requests that really failed.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>      // For ioctl()
+#include <linux/i2c.h>      // For struct i2c_msg
+#include <linux/i2c-dev.h>  // For I2C_RDWR
+#include <unistd.h>         // For close()
+
+#include "tcs3472x.h"
+#include "tcs3472x_queue.h"
+#include "tcs3472x_trace.h"
+
+#define MAX_MSGS            I2C_RDWR_IOCTL_MAX_MSGS
+#define COLOR_BYTES         8
+
+static int64_t _now_ns(void);
+static void *_worker_thread(void *arg);
+static void _process(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t *list);
+static void _run_batch(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t **batch, uint8_t count);
+static int8_t _transfer(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t **requests, uint8_t count);
+static void _complete(tcs3472x_queue_t *queue, tcs3472x_queue_request_t *request);
+
+int8_t tcs3472x_queue_init(tcs3472x_queue_t *queue, tcs3472x_group_t *group) {
+    tcs3472x_queue_worker_t *worker = NULL;
+    uint8_t b = 0;
+
+    memset(queue, 0, sizeof(*queue));
+    queue->group = group;
+
+    queue->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (queue->event_fd < 0) {
+        LOG_ERROR("Failed to create completion eventfd (errno %d).\r\n", errno);
+        return -1;
+    }
+    pthread_mutex_init(&queue->completion_lock, NULL);
+
+    for (b = 0; b < group->bus_count; b++) {
+        worker = &queue->workers[b];
+        worker->queue = queue;
+        worker->bus_index = b;
+        worker->running = 1;
+        pthread_mutex_init(&worker->lock, NULL);
+        pthread_cond_init(&worker->wake, NULL);
+
+        if (pthread_create(&worker->thread, NULL, _worker_thread, worker) != 0) {
+            LOG_ERROR("Failed to create worker for %s.\r\n", group->buses[b].path);
+            pthread_cond_destroy(&worker->wake);
+            pthread_mutex_destroy(&worker->lock);
+            tcs3472x_queue_close(queue);
+            return -1;
+        }
+        queue->worker_count++;
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_queue_submit(tcs3472x_queue_t *queue, tcs3472x_queue_request_t *request) {
+    tcs3472x_queue_worker_t *worker = NULL;
+
+    if (request->sensor >= queue->group->sensor_count || request->op > TCS3472X_QUEUE_OP_WRITE_REGISTER) {
+        LOG_ERROR("Invalid queue request (sensor %d, op %d).\r\n", request->sensor, request->op);
+        return -1;
+    }
+
+    worker = &queue->workers[queue->group->sensors[request->sensor].bus_index];
+    request->next = NULL;
+
+    pthread_mutex_lock(&worker->lock);
+    if (!worker->running) {
+        pthread_mutex_unlock(&worker->lock);
+        return -1;
+    }
+    if (worker->tail) {
+        worker->tail->next = request;
+    }
+    else {
+        worker->head = request;
+    }
+    worker->tail = request;
+    pthread_cond_signal(&worker->wake);
+    pthread_mutex_unlock(&worker->lock);
+
+    return 0;
+}
+
+int tcs3472x_queue_event_fd(const tcs3472x_queue_t *queue) {
+    return queue->event_fd;
+}
+
+uint32_t tcs3472x_queue_reap(tcs3472x_queue_t *queue, tcs3472x_queue_request_t **requests, uint32_t max) {
+    const uint64_t one = 1;
+    uint64_t counter = 0;
+    uint32_t count = 0;
+
+    // Reset the eventfd first; completions queued after this point signal it again
+    if (read(queue->event_fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+        LOG_ERROR("Failed to read completion eventfd (errno %d).\r\n", errno);
+    }
+
+    pthread_mutex_lock(&queue->completion_lock);
+    while (count < max && queue->completed_head) {
+        requests[count++] = queue->completed_head;
+        queue->completed_head = queue->completed_head->next;
+    }
+    if (!queue->completed_head) {
+        queue->completed_tail = NULL;
+    }
+    else if (write(queue->event_fd, &one, sizeof(one)) < 0) {
+        // More completions than max are waiting: keep the eventfd readable
+        LOG_ERROR("Failed to signal completion eventfd (errno %d).\r\n", errno);
+    }
+    pthread_mutex_unlock(&queue->completion_lock);
+
+    return count;
+}
+
+void tcs3472x_queue_close(tcs3472x_queue_t *queue) {
+    tcs3472x_queue_worker_t *worker = NULL;
+    uint8_t b = 0;
+
+    for (b = 0; b < queue->worker_count; b++) {
+        worker = &queue->workers[b];
+
+        pthread_mutex_lock(&worker->lock);
+        worker->running = 0;
+        pthread_cond_signal(&worker->wake);
+        pthread_mutex_unlock(&worker->lock);
+
+        pthread_join(worker->thread, NULL);
+        pthread_cond_destroy(&worker->wake);
+        pthread_mutex_destroy(&worker->lock);
+    }
+    queue->worker_count = 0;
+
+    if (queue->event_fd >= 0) {
+        close(queue->event_fd);
+        queue->event_fd = -1;
+        pthread_mutex_destroy(&queue->completion_lock);
+    }
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Worker thread body: takes the whole pending list of its bus and processes it, until stopped and empty.
+ */
+static void *_worker_thread(void *arg) {
+    tcs3472x_queue_worker_t *worker = arg;
+    tcs3472x_queue_t *queue = worker->queue;
+    tcs3472x_queue_request_t *list = NULL;
+    int fd = queue->group->buses[worker->bus_index].fd;
+
+    for (;;) {
+        pthread_mutex_lock(&worker->lock);
+        while (worker->running && worker->head == NULL) {
+            pthread_cond_wait(&worker->wake, &worker->lock);
+        }
+        list = worker->head;
+        worker->head = NULL;
+        worker->tail = NULL;
+        pthread_mutex_unlock(&worker->lock);
+
+        if (list == NULL) {
+            break;
+        }
+        _process(queue, fd, list);
+    }
+
+    return NULL;
+}
+
+/**
+ * Packs a list of requests into ioctls of at most MAX_MSGS messages and completes every request.
+ */
+static void _process(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t *list) {
+    tcs3472x_queue_request_t *batch[MAX_MSGS];
+    tcs3472x_queue_request_t *next = NULL;
+    uint8_t count = 0, msgs = 0, needed = 0;
+
+    while (list) {
+        next = list->next;
+        needed = list->op == TCS3472X_QUEUE_OP_WRITE_REGISTER ? 1 : 2;
+
+        if (msgs + needed > MAX_MSGS) {
+            _run_batch(queue, fd, batch, count);
+            count = 0;
+            msgs = 0;
+        }
+
+        batch[count++] = list;
+        msgs += needed;
+        list = next;
+    }
+
+    if (count > 0) {
+        _run_batch(queue, fd, batch, count);
+    }
+}
+
+/**
+ * Transfers a batch, replays it one request at a time if the combined ioctl failed, and completes
+ * every request of it.
+ */
+static void _run_batch(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t **batch, uint8_t count) {
+    uint8_t i = 0;
+
+    if (_transfer(queue, fd, batch, count) < 0 && count > 1) {
+        for (i = 0; i < count; i++) {
+            queue->group->sensors[batch[i]->sensor].stats.retries++;
+            _transfer(queue, fd, &batch[i], 1);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        _complete(queue, batch[i]);
+    }
+}
+
+/**
+ * Issues one I2C_RDWR ioctl for a batch of requests and stores their results.
+ *
+ * A register write is a single message of command byte and value. A register or color read is a
+ * command byte write followed by a read, separated by a repeated start.
+ *
+ * @return 0 on success, -1 if the ioctl failed.
+ */
+static int8_t _transfer(tcs3472x_queue_t *queue, int fd, tcs3472x_queue_request_t **requests, uint8_t count) {
+    struct i2c_msg msgs[MAX_MSGS];
+    struct i2c_rdwr_ioctl_data transfer;
+    uint8_t tx[MAX_MSGS][2];
+    uint8_t rx[MAX_MSGS][COLOR_BYTES];
+    tcs3472x_queue_request_t *request = NULL;
+    tcs3472x_group_sensor_t *sensor = NULL;
+    int64_t t_begin = 0, t_end = 0;
+    uint8_t i = 0, n = 0;
+    int8_t result = 0;
+
+    for (i = 0; i < count; i++) {
+        request = requests[i];
+        sensor = &queue->group->sensors[request->sensor];
+
+        if (request->op == TCS3472X_QUEUE_OP_WRITE_REGISTER) {
+            tx[i][0] = COMMAND_BIT | request->reg_address;
+            tx[i][1] = request->value;
+            msgs[n++] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 2, .buf = tx[i] };
+        }
+        else if (request->op == TCS3472X_QUEUE_OP_READ_REGISTER) {
+            tx[i][0] = COMMAND_BIT | request->reg_address;
+            msgs[n++] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 1, .buf = tx[i] };
+            msgs[n++] = (struct i2c_msg){ .addr = sensor->address, .flags = I2C_M_RD, .len = 1, .buf = rx[i] };
+        }
+        else {
+            tx[i][0] = COMMAND_BIT | COMMAND_AUTO_INCREMENT | CDATAL_REGISTER;
+            msgs[n++] = (struct i2c_msg){ .addr = sensor->address, .flags = 0, .len = 1, .buf = tx[i] };
+            msgs[n++] = (struct i2c_msg){ .addr = sensor->address, .flags = I2C_M_RD, .len = COLOR_BYTES, .buf = rx[i] };
+        }
+    }
+
+    transfer.msgs = msgs;
+    transfer.nmsgs = n;
+
+    TCS3472X_TRACE1(group_start, n);
+    t_begin = _now_ns();
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0) {
+        result = -1;
+        if (count == 1) {
+            LOG_ERROR("I2C queue transfer error (errno %d).\r\n", errno);
+        }
+    }
+    t_end = _now_ns();
+    TCS3472X_TRACE2(group_end, n, result);
+
+    for (i = 0; i < count; i++) {
+        request = requests[i];
+        sensor = &queue->group->sensors[request->sensor];
+
+        request->result = result;
+        request->complete_ns = t_end;
+        tcs3472x_stats_record_transaction(&sensor->stats, (uint32_t)(t_end - t_begin), result);
+        if (result < 0) {
+            continue;
+        }
+
+        if (request->op == TCS3472X_QUEUE_OP_WRITE_REGISTER) {
+            // Keep the group's cached configuration in step for timing predictions
+            if (request->reg_address == ENABLE_REGISTER) {
+                sensor->enable = request->value;
+            }
+            else if (request->reg_address == ATIME_REGISTER) {
+                sensor->atime = request->value;
+            }
+            else if (request->reg_address == WTIME_REGISTER) {
+                sensor->wtime = request->value;
+            }
+        }
+        else if (request->op == TCS3472X_QUEUE_OP_READ_REGISTER) {
+            request->value = rx[i][0];
+        }
+        else {
+            request->colors[0] = (rx[i][1] << 8) | rx[i][0];
+            request->colors[1] = (rx[i][3] << 8) | rx[i][2];
+            request->colors[2] = (rx[i][5] << 8) | rx[i][4];
+            request->colors[3] = (rx[i][7] << 8) | rx[i][6];
+            tcs3472x_stats_record_sample(&sensor->stats, request->colors[0], sensor->atime);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Hands a finished request to its callback or to the completion queue.
+ */
+static void _complete(tcs3472x_queue_t *queue, tcs3472x_queue_request_t *request) {
+    const uint64_t one = 1;
+
+    request->next = NULL;
+    if (request->callback) {
+        request->callback(request);
+        return;
+    }
+
+    pthread_mutex_lock(&queue->completion_lock);
+    if (queue->completed_tail) {
+        queue->completed_tail->next = request;
+    }
+    else {
+        queue->completed_head = request;
+    }
+    queue->completed_tail = request;
+    pthread_mutex_unlock(&queue->completion_lock);
+
+    if (write(queue->event_fd, &one, sizeof(one)) < 0) {
+        LOG_ERROR("Failed to signal completion eventfd (errno %d).\r\n", errno);
+    }
+}
@@ -0,0 +1,186 @@
+/**
+ * @file tcs3472x_sched.c
+ * @brief Earliest-deadline-first read scheduler for sensors of a group.
+ *
+ * This file implements the scheduler declared in tcs3472x_sched.h. The scheduler does not sleep; the
+ * caller calls tcs3472x_sched_poll() and waits until the time it returns.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_sched.h"
+
+static int64_t _now_ns(void);
+static int64_t _next_avalid_ns(const tcs3472x_group_sensor_t *sensor, int64_t at_ns);
+static uint32_t _load_ppm(int64_t cost_ns, int64_t period_ns);
+
+void tcs3472x_sched_init(tcs3472x_sched_t *sched, tcs3472x_group_t *group,
+                         const tcs3472x_bus_config_t *bus, tcs3472x_sched_callback_t callback,
+                         void *context) {
+    uint8_t i = 0;
+
+    for (i = 0; i < TCS3472X_GROUP_MAX_SENSORS; i++) {
+        sched->tasks[i] = (tcs3472x_sched_task_t){ 0 };
+    }
+    for (i = 0; i < TCS3472X_GROUP_MAX_BUSES; i++) {
+        sched->bus_load_ppm[i] = 0;
+    }
+
+    sched->group = group;
+    sched->limit_ppm = TCS3472X_SCHED_DEFAULT_LIMIT_PPM;
+    sched->read_cost_ns = tcs3472x_bus_cost_ns(bus, TCS3472X_BUS_OP_GROUP_READ);
+    sched->callback = callback;
+    sched->context = context;
+}
+
+int8_t tcs3472x_sched_add(tcs3472x_sched_t *sched, uint8_t sensor_index, uint32_t period_us,
+                          uint32_t deadline_us, int64_t now_ns) {
+    const tcs3472x_group_sensor_t *sensor = NULL;
+    tcs3472x_sched_task_t *task = NULL;
+    int64_t period_ns = (int64_t)period_us * 1000;
+    uint32_t load_ppm = 0, bus_load_ppm = 0;
+
+    if (sensor_index >= sched->group->sensor_count || sensor_index >= TCS3472X_GROUP_MAX_SENSORS) {
+        LOG_ERROR("No sensor %d in group.\r\n", sensor_index);
+        return -1;
+    }
+    sensor = &sched->group->sensors[sensor_index];
+    task = &sched->tasks[sensor_index];
+
+    if (period_ns < tcs3472x_group_cycle_ns(sensor)) {
+        LOG_ERROR("Period of sensor %d is shorter than its RGBC cycle.\r\n", sensor_index);
+        return -1;
+    }
+
+    // A task already admitted for this sensor stays in place until the new one passes admission
+    bus_load_ppm = sched->bus_load_ppm[sensor->bus_index];
+    if (task->active) {
+        bus_load_ppm -= _load_ppm(sched->read_cost_ns, task->period_ns);
+    }
+    load_ppm = _load_ppm(sched->read_cost_ns, period_ns);
+    if (bus_load_ppm + load_ppm > sched->limit_ppm) {
+        LOG_ERROR("Bus %d cannot carry sensor %d at the requested rate.\r\n",
+                  sensor->bus_index, sensor_index);
+        return -1;
+    }
+    sched->bus_load_ppm[sensor->bus_index] = bus_load_ppm + load_ppm;
+
+    *task = (tcs3472x_sched_task_t){ 0 };
+    task->active = 1;
+    task->period_ns = period_ns;
+    task->deadline_ns = (int64_t)deadline_us * 1000;
+    task->release_ns = _next_avalid_ns(sensor, now_ns);
+    task->due_ns = task->release_ns + task->deadline_ns;
+
+    return 0;
+}
+
+void tcs3472x_sched_remove(tcs3472x_sched_t *sched, uint8_t sensor_index) {
+    tcs3472x_sched_task_t *task = NULL;
+    uint8_t bus_index = 0;
+
+    if (sensor_index >= sched->group->sensor_count || sensor_index >= TCS3472X_GROUP_MAX_SENSORS) {
+        return;
+    }
+    task = &sched->tasks[sensor_index];
+    bus_index = sched->group->sensors[sensor_index].bus_index;
+
+    if (!task->active) {
+        return;
+    }
+
+    sched->bus_load_ppm[bus_index] -= _load_ppm(sched->read_cost_ns, task->period_ns);
+    task->active = 0;
+}
+
+int64_t tcs3472x_sched_poll(tcs3472x_sched_t *sched, int64_t now_ns) {
+    tcs3472x_group_t *group = sched->group;
+    tcs3472x_sched_task_t *task = NULL;
+    int64_t next_ns = INT64_MAX, done_ns = 0;
+    uint8_t i = 0, earliest = 0;
+
+    for (;;) {
+        earliest = group->sensor_count;
+        for (i = 0; i < group->sensor_count; i++) {
+            task = &sched->tasks[i];
+            if (task->active && task->release_ns <= now_ns &&
+                (earliest == group->sensor_count || task->due_ns < sched->tasks[earliest].due_ns)) {
+                earliest = i;
+            }
+        }
+        if (earliest == group->sensor_count) {
+            break;
+        }
+
+        task = &sched->tasks[earliest];
+        if (tcs3472x_group_read_sensor(group, earliest) < 0) {
+            task->failed++;
+        }
+        else {
+            done_ns = _now_ns();
+            task->completed++;
+            if (done_ns > task->due_ns) {
+                task->missed++;
+            }
+            if (sched->callback != NULL) {
+                sched->callback(sched->context, earliest, &group->sensors[earliest]);
+            }
+        }
+
+        task->release_ns = _next_avalid_ns(&group->sensors[earliest], task->release_ns + task->period_ns);
+        if (task->release_ns + task->period_ns <= now_ns) {
+            // More than a full period behind, drop the backlog instead of reading stale data
+            task->release_ns = _next_avalid_ns(&group->sensors[earliest], now_ns);
+        }
+        task->due_ns = task->release_ns + task->deadline_ns;
+    }
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (sched->tasks[i].active && sched->tasks[i].release_ns < next_ns) {
+            next_ns = sched->tasks[i].release_ns;
+        }
+    }
+    return next_ns;
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Predicts the first AVALID event of a sensor at or after a given time.
+ *
+ * The first result becomes valid one integration time after the sensor was started, and every
+ * following result one full RGBC cycle later.
+ *
+ * @param sensor Sensor to predict for.
+ * @param at_ns Earliest acceptable time.
+ * @return Absolute time of the AVALID event.
+ */
+static int64_t _next_avalid_ns(const tcs3472x_group_sensor_t *sensor, int64_t at_ns) {
+    int64_t first_ns = sensor->start_ns + tcs3472x_group_atime_ns(sensor);
+    int64_t cycle_ns = tcs3472x_group_cycle_ns(sensor);
+    int64_t cycles = 0;
+
+    if (at_ns <= first_ns) {
+        return first_ns;
+    }
+
+    cycles = (at_ns - first_ns + cycle_ns - 1) / cycle_ns;
+    return first_ns + cycles * cycle_ns;
+}
+
+/**
+ * Computes the share of bus time, in parts per million, used by reads of a given cost and period.
+ */
+static uint32_t _load_ppm(int64_t cost_ns, int64_t period_ns) {
+    return (uint32_t)((cost_ns * 1000000LL + period_ns - 1) / period_ns);
+}
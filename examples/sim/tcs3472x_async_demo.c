@@ -0,0 +1,163 @@
+/**
+ * @file tcs3472x_async_demo.c
+ * @brief Runs the asynchronous driver against the simulated asynchronous HAL.
+ *
+ * This program cycles through every configuration write, status reads and color reads with randomized
+ * transfer latencies and injected bus failures. While a transfer is in flight the main loop keeps
+ * doing other work, as an application on an MCU would between I2C interrupts. Every result is
+ * checked against the simulated register file, and the program exits with a non-zero status if any
+ * operation returned wrong data or reported the wrong outcome.
+ *
+ * Usage: tcs3472x_async_demo [operations] [max_latency_ticks] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_async.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_i2c_hal_async_sim.h"
+
+#define DEVICE_ADDRESS      0x29
+#define DEFAULT_OPERATIONS  10000
+#define DEFAULT_MAX_LATENCY 50
+#define DEFAULT_SEED        1
+#define FAILURE_INTERVAL    97      ///< Every this many operations a transfer failure is injected
+#define OPERATION_KINDS     8
+
+/**
+ * Outcome of the operation in progress, written by the done callback.
+ */
+typedef struct {
+    uint8_t finished;
+    int8_t result;
+} completion_t;
+
+static void _on_done(void *context, int8_t result) {
+    completion_t *completion = context;
+
+    completion->result = result;
+    completion->finished = 1;
+}
+
+int main(int argc, char **argv) {
+    uint32_t operations = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_OPERATIONS;
+    uint32_t max_latency = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : DEFAULT_MAX_LATENCY;
+    uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : DEFAULT_SEED;
+    tcs3472x_async_t dev;
+    completion_t completion;
+    uint16_t colors[4], expected[4];
+    uint16_t threshold = 0;
+    uint8_t status = 0, value = 0, inject = 0;
+    uint32_t i = 0, mismatches = 0, failures = 0, busy_ticks = 0, app_work = 0;
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_i2c_hal_async_sim_init(seed, 0, max_latency);
+    tcs3472x_async_init(&dev);
+    srand(seed);
+
+    for (i = 0; i < operations; i++) {
+        completion.finished = 0;
+        inject = (i % FAILURE_INTERVAL) == FAILURE_INTERVAL - 1;
+        if (inject) {
+            tcs3472x_i2c_hal_sim_fail_next(1);
+        }
+
+        value = (uint8_t)rand();
+        threshold = (uint16_t)rand();
+        switch (i % OPERATION_KINDS) {
+            case 0:
+                tcs3472x_async_set_atime(&dev, value, _on_done, &completion);
+                break;
+            case 1:
+                tcs3472x_async_set_enable(&dev, value | ENABLE_PON, _on_done, &completion);
+                break;
+            case 2:
+                tcs3472x_async_get_status(&dev, &status, _on_done, &completion);
+                break;
+            case 3:
+                tcs3472x_async_set_wtime(&dev, value, _on_done, &completion);
+                break;
+            case 4:
+                tcs3472x_async_set_wlong(&dev, value & 1, _on_done, &completion);
+                break;
+            case 5:
+                tcs3472x_async_set_gain(&dev, value & CONTROL_AGAIN_60X, _on_done, &completion);
+                break;
+            case 6:
+                tcs3472x_async_set_isr_threshold_low(&dev, threshold, _on_done, &completion);
+                break;
+            default:
+                expected[0] = (uint16_t)rand();
+                expected[1] = (uint16_t)rand();
+                expected[2] = (uint16_t)rand();
+                expected[3] = (uint16_t)rand();
+                tcs3472x_i2c_hal_sim_set_colors(expected[0], expected[1], expected[2], expected[3]);
+                tcs3472x_async_get_all_colors_data(&dev, colors, _on_done, &completion);
+                break;
+        }
+
+        // The CPU is free until the completion interrupt finishes the operation
+        while (!completion.finished) {
+            app_work++;
+            busy_ticks += tcs3472x_i2c_hal_async_sim_busy();
+            tcs3472x_i2c_hal_async_sim_tick();
+        }
+
+        if (inject) {
+            failures += completion.result < 0;
+            mismatches += completion.result == 0;
+            continue;
+        }
+        if (completion.result < 0) {
+            mismatches++;
+            continue;
+        }
+
+        switch (i % OPERATION_KINDS) {
+            case 0:
+                mismatches += dev.config.atime != value ||
+                              tcs3472x_i2c_hal_sim_get_register(ATIME_REGISTER) != value;
+                break;
+            case 1:
+                mismatches += dev.config.enable != (value | ENABLE_PON) ||
+                              tcs3472x_i2c_hal_sim_get_register(ENABLE_REGISTER) != (value | ENABLE_PON);
+                break;
+            case 2:
+                mismatches += status != tcs3472x_i2c_hal_sim_get_register(STATUS_REGISTER);
+                break;
+            case 3:
+                mismatches += dev.config.wtime != value ||
+                              tcs3472x_i2c_hal_sim_get_register(WTIME_REGISTER) != value;
+                break;
+            case 4:
+                mismatches += dev.config.config != ((value & 1) ? CONFIG_WLONG : 0) ||
+                              tcs3472x_i2c_hal_sim_get_register(CONFIG_REGISTER) != dev.config.config;
+                break;
+            case 5:
+                mismatches += dev.config.control != (value & CONTROL_AGAIN_60X) ||
+                              tcs3472x_i2c_hal_sim_get_register(CONTROL_REGISTER) != dev.config.control;
+                break;
+            case 6:
+                mismatches += dev.config.ailt != threshold ||
+                              tcs3472x_i2c_hal_sim_get_register(AILTL_REGISTER) != (threshold & 0x00FF) ||
+                              tcs3472x_i2c_hal_sim_get_register(AILTH_REGISTER) != (threshold >> 8);
+                break;
+            default:
+                mismatches += colors[0] != expected[0] || colors[1] != expected[1] ||
+                              colors[2] != expected[2] || colors[3] != expected[3];
+                break;
+        }
+    }
+
+    printf("operations:         %u\n", operations);
+    printf("latency:            0..%u ticks\n", max_latency);
+    printf("injected failures:  %u reported of %u\n", failures, operations / FAILURE_INTERVAL);
+    printf("bus busy ticks:     %u, all spent on application work (%u iterations)\n",
+           busy_ticks, app_work);
+    printf("mismatches:         %u\n", mismatches);
+
+    return mismatches == 0 && failures == operations / FAILURE_INTERVAL ? 0 : 1;
+}
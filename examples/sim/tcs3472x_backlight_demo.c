@@ -0,0 +1,166 @@
+/**
+ * @file tcs3472x_backlight_demo.c
+ * @brief Runs the backlight controller against a temporary sysfs backlight and the simulated HAL.
+ *
+ * This program first steps the controller through known illuminance changes and checks the
+ * logarithmic mapping, the hysteresis band and the rate limit against the levels that reach the
+ * backlight file. It then runs the sample-synchronized control loop on the simulated sensor while
+ * the scene alternates between dark and bright, and checks that every level is written within one
+ * integration time of the end of the integration it was computed from. It exits with a non-zero
+ * status on any mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_backlight_sysfs.h"
+
+#define DEVICE_ADDRESS      0x29
+#define MAX_BRIGHTNESS      255
+#define INTEGRATION_TIME_US 24000
+#define LOOP_WRITES         20
+#define MS                  1000000LL
+
+/**
+ * Output of the loop run: writes the level, then changes the simulated scene so the next sample
+ * moves the backlight again.
+ */
+typedef struct {
+    tcs3472x_backlight_sysfs_t *sysfs;
+    atomic_int *running;
+    uint32_t writes;
+} loop_output_t;
+
+static int8_t loop_write(void *context, uint32_t level) {
+    loop_output_t *output = context;
+
+    if (tcs3472x_backlight_sysfs_write(output->sysfs, level) < 0) {
+        return -1;
+    }
+    if (++output->writes % 2) {
+        tcs3472x_i2c_hal_sim_set_colors(20000, 8000, 7000, 5000);
+    }
+    else {
+        tcs3472x_i2c_hal_sim_set_colors(20, 8, 7, 5);
+    }
+    if (output->writes >= LOOP_WRITES) {
+        atomic_store(output->running, 0);
+    }
+    return 0;
+}
+
+/**
+ * Returns the level currently in the backlight file.
+ */
+static long read_level(const char *dir) {
+    char path[256], value[16] = {0};
+    FILE *file = NULL;
+
+    snprintf(path, sizeof(path), "%s/brightness", dir);
+    file = fopen(path, "r");
+    if (file == NULL || fgets(value, sizeof(value), file) == NULL) {
+        if (file != NULL) {
+            fclose(file);
+        }
+        return -1;
+    }
+    fclose(file);
+    return strtol(value, NULL, 10);
+}
+
+static int write_file(const char *dir, const char *name, const char *text) {
+    char path[256];
+    FILE *file = NULL;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+    fputs(text, file);
+    fclose(file);
+    return 0;
+}
+
+int main() {
+    char dir[] = "/tmp/tcs3472x_backlight_XXXXXX";
+    char path[300];
+    tcs3472x_backlight_sysfs_t sysfs;
+    tcs3472x_backlight_config_t config;
+    tcs3472x_backlight_t backlight;
+    tcs3472x_backlight_latency_t latency;
+    loop_output_t output;
+    atomic_int running;
+    int failures = 0;
+
+    if (mkdtemp(dir) == NULL || write_file(dir, "max_brightness", "255\n") < 0 ||
+        write_file(dir, "brightness", "0\n") < 0 || tcs3472x_backlight_sysfs_open(&sysfs, dir) < 0) {
+        printf("Failed to create the backlight directory.\n");
+        return 1;
+    }
+
+    // 1 lux to 10000 lux onto 0 to 255: each decade is a quarter of the range
+    tcs3472x_lux_params_default(&config.lux);
+    config.min_mlux = 1000;
+    config.max_mlux = 10000000;
+    config.min_level = 0;
+    config.max_level = MAX_BRIGHTNESS;
+    config.hysteresis_permille = 100;
+    config.max_levels_per_s = 500;
+    config.output = tcs3472x_backlight_sysfs_write;
+    config.context = &sysfs;
+    failures += tcs3472x_backlight_init(&backlight, &config) != 0;
+
+    failures += tcs3472x_backlight_map(&config, 500) != 0;
+    failures += tcs3472x_backlight_map(&config, 100000) != 127;
+    failures += tcs3472x_backlight_map(&config, 20000000) != MAX_BRIGHTNESS;
+
+    // First sample jumps, a change inside the band is ignored, a larger one fades at 500 levels/s
+    failures += tcs3472x_backlight_update_lux(&backlight, 100000, 0) != 1 || read_level(dir) != 127;
+    failures += tcs3472x_backlight_update_lux(&backlight, 105000, 10 * MS) != 0 || read_level(dir) != 127;
+    failures += tcs3472x_backlight_update_lux(&backlight, 1000000, 20 * MS) != 1 || read_level(dir) != 132;
+    failures += tcs3472x_backlight_update_lux(&backlight, 1000000, 21 * MS) != 0 || read_level(dir) != 132;
+    failures += tcs3472x_backlight_update_lux(&backlight, 1000000, 24 * MS) != 1 || read_level(dir) != 134;
+    failures += tcs3472x_backlight_update_lux(&backlight, 1000000, 500 * MS) != 1 || read_level(dir) != 191;
+    printf("controller: map, hysteresis and rate limit %s, %u writes\n", failures ? "FAILED" : "ok",
+           backlight.writes);
+
+    // Sample-synchronized loop on the simulated sensor, immediate changes
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_i2c_hal_sim_set_colors(20, 8, 7, 5);
+    tcs3472x_init();
+    tcs3472x_set_atime_us(INTEGRATION_TIME_US);
+
+    atomic_init(&running, 1);
+    output.sysfs = &sysfs;
+    output.running = &running;
+    output.writes = 0;
+    config.max_levels_per_s = 0;
+    config.output = loop_write;
+    config.context = &output;
+    failures += tcs3472x_backlight_init(&backlight, &config) != 0;
+    failures += tcs3472x_backlight_run(&backlight, &running, &latency) != 0;
+    failures += latency.writes != LOOP_WRITES || latency.max_latency_ns >= INTEGRATION_TIME_US * 1000LL;
+    failures += read_level(dir) != (long)backlight.level;
+
+    printf("loop: %u samples, %u writes, %u read errors, latency avg %.3f ms max %.3f ms (integration %.1f ms)\n",
+           latency.samples, latency.writes, latency.errors,
+           latency.samples ? latency.sum_latency_ns / 1e6 / latency.samples : 0.0,
+           latency.max_latency_ns / 1e6, INTEGRATION_TIME_US / 1000.0);
+
+    tcs3472x_backlight_sysfs_close(&sysfs);
+    tcs3472x_i2c_hal_close();
+    snprintf(path, sizeof(path), "%s/brightness", dir);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/max_brightness", dir);
+    unlink(path);
+    rmdir(dir);
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file tcs3472x_bus_plan.c
+ * @brief Bus capacity planner for TCS3472x deployments.
+ *
+ * This program first runs every single-device driver API against the simulated HAL and checks that
+ * the traffic it counts matches the cost model, then prints the predicted bus time per API and how
+ * many sensors the bus supports at the requested sample rate.
+ *
+ * Usage: tcs3472x_bus_plan <bus_khz> <rate_hz> [overhead_us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_bus_cost.h"
+
+#define DEVICE_ADDRESS      0x29
+#define UTILIZATION_LIMIT   900000  // 90 % of the bus time, in parts per million
+
+static const char *op_names[TCS3472X_BUS_OP_COUNT] = {
+    [TCS3472X_BUS_OP_INIT]                  = "init",
+    [TCS3472X_BUS_OP_GET_ENABLE]            = "get_enable",
+    [TCS3472X_BUS_OP_GET_ID]                = "get_id",
+    [TCS3472X_BUS_OP_SET_ATIME]             = "set_atime",
+    [TCS3472X_BUS_OP_GET_ATIME]             = "get_atime",
+    [TCS3472X_BUS_OP_SET_ISR_THRESHOLD_LOW] = "set_isr_threshold_reg_low",
+    [TCS3472X_BUS_OP_GET_ALL_COLORS]        = "get_all_colors_data",
+    [TCS3472X_BUS_OP_GET_STATUS_COLORS]     = "get_status_colors",
+    [TCS3472X_BUS_OP_GET_COLOR]             = "get_clear_data",
+    [TCS3472X_BUS_OP_APPLY_CONFIG]          = "restore_config",
+    [TCS3472X_BUS_OP_RESTART_INTEGRATION]   = "restart_integration",
+    [TCS3472X_BUS_OP_GROUP_CONFIGURE]       = "group_configure",
+    [TCS3472X_BUS_OP_GROUP_START]           = "group_start",
+    [TCS3472X_BUS_OP_GROUP_READ]            = "group_read",
+};
+
+/**
+ * Runs one single-device API against the simulated HAL.
+ *
+ * @return 0 if the operation exists on the single-device API, -1 otherwise.
+ */
+static int run_op(tcs3472x_bus_op_t op) {
+    uint16_t colors[4];
+    uint8_t status = 0;
+
+    switch (op) {
+        case TCS3472X_BUS_OP_INIT:                  tcs3472x_init(); break;
+        case TCS3472X_BUS_OP_GET_ENABLE:            tcs3472x_get_enable(); break;
+        case TCS3472X_BUS_OP_GET_ID:                tcs3472x_get_id(); break;
+        case TCS3472X_BUS_OP_SET_ATIME:             tcs3472x_set_atime(24); break;
+        case TCS3472X_BUS_OP_GET_ATIME:             tcs3472x_get_atime(); break;
+        case TCS3472X_BUS_OP_SET_ISR_THRESHOLD_LOW: tcs3472x_set_isr_threshold_reg_low(1000); break;
+        case TCS3472X_BUS_OP_GET_ALL_COLORS:        tcs3472x_get_all_colors_data(colors); break;
+        case TCS3472X_BUS_OP_GET_STATUS_COLORS:     tcs3472x_get_status_colors(&status, colors); break;
+        case TCS3472X_BUS_OP_GET_COLOR:             tcs3472x_get_clear_data(); break;
+        case TCS3472X_BUS_OP_APPLY_CONFIG:          tcs3472x_restore_config(); break;
+        case TCS3472X_BUS_OP_RESTART_INTEGRATION:   tcs3472x_restart_integration(); break;
+        default:                                    return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    tcs3472x_bus_config_t config;
+    tcs3472x_i2c_hal_sim_stats_t stats;
+    const tcs3472x_bus_ops_t *ops = NULL;
+    uint32_t rate_mhz = 0, bytes = 0;
+    int op = 0, ok = 0, mismatches = 0;
+
+    if (argc < 3) {
+        printf("Usage: %s <bus_khz> <rate_hz> [overhead_us]\n", argv[0]);
+        return -1;
+    }
+
+    tcs3472x_bus_config_default(&config, (uint32_t)(atof(argv[1]) * 1000));
+    rate_mhz = (uint32_t)(atof(argv[2]) * 1000);
+    if (argc > 3) {
+        config.overhead_ns = (uint32_t)(atof(argv[3]) * 1000);
+    }
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+
+    printf("%-28s %6s %6s %10s %s\n", "operation", "model", "sim", "time_us", "check");
+    for (op = 0; op < TCS3472X_BUS_OP_COUNT; op++) {
+        ops = tcs3472x_bus_cost_ops(op);
+
+        tcs3472x_i2c_hal_sim_reset_stats();
+        if (run_op(op) < 0) {
+            printf("%-28s %6d %6s %10.1f %s\n", op_names[op], ops->bytes, "-",
+                   tcs3472x_bus_cost_ns(&config, op) / 1000.0, "not simulated");
+            continue;
+        }
+        tcs3472x_i2c_hal_sim_get_stats(&stats);
+
+        bytes = stats.bytes_written + stats.bytes_read;
+        ok = (stats.transactions == ops->transactions && bytes == ops->bytes);
+        if (!ok) {
+            mismatches++;
+        }
+        printf("%-28s %6d %6u %10.1f %s\n", op_names[op], ops->bytes, bytes,
+               tcs3472x_bus_cost_ns(&config, op) / 1000.0, ok ? "ok" : "MISMATCH");
+    }
+
+    printf("\nAt %u kHz and %.3f Hz per sensor (limit %d%% of bus time):\n",
+           config.bus_hz / 1000, rate_mhz / 1000.0, UTILIZATION_LIMIT / 10000);
+    printf("  tcs3472x_get_all_colors_data: this bus supports %u sensors\n",
+           tcs3472x_bus_max_sensors(&config, TCS3472X_BUS_OP_GET_ALL_COLORS, rate_mhz, UTILIZATION_LIMIT));
+    printf("  tcs3472x_group_read:          this bus supports %u sensors\n",
+           tcs3472x_bus_max_sensors(&config, TCS3472X_BUS_OP_GROUP_READ, rate_mhz, UTILIZATION_LIMIT));
+    printf("  (without a multiplexer a bus can address at most two sensors, at 0x29 and 0x39)\n");
+
+    tcs3472x_i2c_hal_close();
+    return mismatches ? 1 : 0;
+}
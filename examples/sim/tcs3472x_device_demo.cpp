@@ -0,0 +1,82 @@
+/**
+ * @file tcs3472x_device_demo.cpp
+ * @brief Runs the compile-time specialized C++ device against the simulated HAL.
+ *
+ * This program probes the simulated sensor as a TCS34725 (matching ID) and as a TCS34727 (different
+ * ID), reads colors, writes ATIME and applies a compile-time configuration, and checks the results and
+ * the bus traffic against the simulated register file. It exits with a non-zero status on any mismatch.
+ */
+
+#include <cstdio>
+
+#include "tcs3472x_config.hpp"
+
+extern "C" {
+#include "tcs3472x_i2c_hal_sim.h"
+}
+
+using tcs34725_device = tcs3472x::device<tcs3472x::tcs34725, tcs3472x::c_hal_transport>;
+using tcs34727_device = tcs3472x::device<tcs3472x::tcs34727, tcs3472x::c_hal_transport>;
+
+static_assert(tcs34725_device::address == 0x29 && tcs34725_device::expected_id == 0x44);
+static_assert(tcs34727_device::address == 0x29 && tcs34727_device::expected_id == 0x4D);
+static_assert(tcs3472x::device<tcs3472x::tcs34721, tcs3472x::c_hal_transport>::address == 0x39);
+
+// Changing any value to an out-of-range one (e.g. gain(8)) fails to compile
+constexpr tcs3472x::burst_config config = tcs3472x::config_builder()
+                                              .integration_time_us(24000)
+                                              .wait_time_us(1440000)
+                                              .gain(16)
+                                              .persistence(5)
+                                              .thresholds(100, 8000)
+                                              .build();
+
+int main() {
+    tcs3472x::c_hal_transport bus;
+    tcs34725_device dev(bus);
+    tcs34727_device wrong_variant(bus);
+    std::array<uint16_t, 4> colors{};
+    tcs3472x_i2c_hal_sim_stats_t stats;
+    uint32_t read_transactions;
+    int failures = 0;
+
+    tcs3472x_i2c_hal_init(tcs34725_device::address);
+    tcs3472x_i2c_hal_sim_set_colors(1000, 400, 350, 250);
+
+    failures += dev.init() != 0;
+    failures += dev.probe() != 0;
+    failures += wrong_variant.probe() != -1;
+    failures += dev.set_atime(tcs3472x::atime_for_us(24000)) != 0;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::atime) != 0xF6;
+
+    tcs3472x_i2c_hal_sim_reset_stats();
+    failures += dev.read_colors(colors) != 0;
+    failures += colors[0] != 1000 || colors[1] != 400 || colors[2] != 350 || colors[3] != 250;
+    tcs3472x_i2c_hal_sim_get_stats(&stats);
+    failures += stats.bytes_written != 1 || stats.bytes_read != 8;
+    read_transactions = stats.transactions;
+
+    tcs3472x_i2c_hal_sim_fail_next(1);
+    failures += dev.read_colors(colors) != -1;
+
+    tcs3472x_i2c_hal_sim_reset_stats();
+    failures += tcs3472x::configure(dev, config) != 0;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::atime) != 0xF6;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::wtime) != 256 - 50;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::ailtl) != 100;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::aihtl) != (8000 & 0xFF);
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::aihtl + 1) != (8000 >> 8);
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::pers) != 4;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::config) != 0x02;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::control) != 2;
+    failures += tcs3472x_i2c_hal_sim_get_register(tcs3472x::reg::enable) != 0x1B;
+    failures += tcs3472x_i2c_hal_sim_get_register(0x02) != 0;
+    tcs3472x_i2c_hal_sim_get_stats(&stats);
+    failures += stats.transactions != config.segment_count || stats.bytes_written != config.size;
+
+    printf("C = %u | R = %u | G = %u | B = %u | %u bus transactions per read\n",
+           colors[0], colors[1], colors[2], colors[3], read_transactions);
+    printf("configuration: %u bytes in %u writes\n", config.size, config.segment_count);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file tcs3472x_format_bench.c
+ * @brief Compares the integer sample formatter with snprintf.
+ *
+ * This program formats the same samples as CSV and NDJSON with tcs3472x_format_sample() and with
+ * snprintf, checks that both produce identical text, checks that binary records decode back to the
+ * samples, and prints the time per sample of each. It exits with a non-zero status on any mismatch.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "tcs3472x_format.h"
+
+#define SAMPLES         200000
+#define BUFFER_SIZE     (SAMPLES * 112)
+#define NS_PER_SEC      1000000000LL
+
+static char formatted[BUFFER_SIZE];
+static char printed[BUFFER_SIZE];
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static void make_sample(uint32_t n, tcs3472x_format_sample_t *sample) {
+    sample->timestamp_ns = 1700000000000000000LL + (int64_t)n * 2403917;
+    sample->device = (uint16_t)(n % 3);
+    sample->colors[0] = (uint16_t)(n * 7);
+    sample->colors[1] = (uint16_t)(n % 10 == 0 ? 0 : n * 3);
+    sample->colors[2] = (uint16_t)(n % 1000);
+    sample->colors[3] = (uint16_t)(65535 - n % 100);
+}
+
+/**
+ * Formats all samples with both implementations and compares the output.
+ *
+ * @return 0 if the outputs match, 1 otherwise.
+ */
+static int compare(const char *name, tcs3472x_format_t format, const char *pattern) {
+    tcs3472x_format_sample_t sample;
+    size_t formatted_length = 0, printed_length = 0;
+    int64_t begin = 0, formatter_ns = 0, printf_ns = 0;
+    uint32_t n = 0;
+    int ok = 0;
+
+    begin = now_ns();
+    for (n = 0; n < SAMPLES; n++) {
+        make_sample(n, &sample);
+        formatted_length += tcs3472x_format_sample(formatted + formatted_length, format, &sample);
+    }
+    formatter_ns = now_ns() - begin;
+
+    begin = now_ns();
+    for (n = 0; n < SAMPLES; n++) {
+        make_sample(n, &sample);
+        printed_length += (size_t)snprintf(printed + printed_length, BUFFER_SIZE - printed_length, pattern,
+                                           sample.timestamp_ns, sample.device, sample.colors[0], sample.colors[1],
+                                           sample.colors[2], sample.colors[3]);
+    }
+    printf_ns = now_ns() - begin;
+
+    ok = formatted_length == printed_length && memcmp(formatted, printed, formatted_length) == 0;
+    printf("%-7s formatter %6.1f ns/sample, snprintf %6.1f ns/sample, %4.1fx, %zu bytes %s\n", name,
+           (double)formatter_ns / SAMPLES, (double)printf_ns / SAMPLES, (double)printf_ns / (double)formatter_ns,
+           formatted_length, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/**
+ * Checks that binary records decode back to the samples.
+ *
+ * @return 0 if they do, 1 otherwise.
+ */
+static int check_binary(void) {
+    tcs3472x_format_sample_t sample;
+    const uint8_t *record = (const uint8_t *)formatted;
+    uint64_t timestamp = 0;
+    uint32_t n = 0, mismatches = 0;
+    uint8_t i = 0;
+
+    for (n = 0; n < SAMPLES; n++) {
+        make_sample(n, &sample);
+        if (tcs3472x_format_sample(formatted, TCS3472X_FORMAT_BINARY, &sample) != TCS3472X_FORMAT_BINARY_SIZE) {
+            mismatches++;
+            continue;
+        }
+        timestamp = 0;
+        for (i = 0; i < 8; i++) {
+            timestamp |= (uint64_t)record[i] << (8 * i);
+        }
+        mismatches += (int64_t)timestamp != sample.timestamp_ns ||
+                      (record[8] | record[9] << 8) != sample.device ||
+                      (record[10] | record[11] << 8) != sample.colors[0] ||
+                      (record[12] | record[13] << 8) != sample.colors[1] ||
+                      (record[14] | record[15] << 8) != sample.colors[2] ||
+                      (record[16] | record[17] << 8) != sample.colors[3];
+    }
+    printf("binary  %u mismatches %s\n", mismatches, mismatches == 0 ? "ok" : "FAILED");
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main() {
+    char text[24];
+    int failures = 0;
+
+    // Fault the buffers in first so page faults do not count against either implementation
+    memset(formatted, 0, sizeof(formatted));
+    memset(printed, 0, sizeof(printed));
+
+    failures += compare("csv", TCS3472X_FORMAT_CSV, "%" PRId64 ",%u,%u,%u,%u,%u\n");
+    failures += compare("ndjson", TCS3472X_FORMAT_NDJSON,
+                        "{\"timestamp_ns\":%" PRId64 ",\"device\":%u,\"clear\":%u,\"red\":%u,\"green\":%u,\"blue\":%u}\n");
+    failures += check_binary();
+
+    text[tcs3472x_format_i64(text, INT64_MIN)] = '\0';
+    failures += strcmp(text, "-9223372036854775808") != 0;
+    text[tcs3472x_format_i64(text, 0)] = '\0';
+    failures += strcmp(text, "0") != 0;
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
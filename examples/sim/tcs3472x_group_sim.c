@@ -0,0 +1,224 @@
+/**
+ * @file tcs3472x_group_sim.c
+ * @brief Sensor group on top of the simulated HAL, for running the scheduler and frame buffer
+ *        without i2c-dev buses.
+ *
+ * This file implements the bus side of the group API declared in tcs3472x_group.h and is linked
+ * instead of tcs3472x_group.c, together with tcs3472x_group_timing.c. Bus paths only group the
+ * sensors; every sensor is backed by the single register file of tcs3472x_i2c_hal_sim.c, so all
+ * sensors return the colors set with tcs3472x_i2c_hal_sim_set_colors(). Each sensor is accessed
+ * with its own HAL calls, and start and read times are taken from CLOCK_MONOTONIC.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_group.h"
+#include "tcs3472x_i2c_hal.h"
+
+typedef enum {
+    GROUP_OP_CONFIGURE,
+    GROUP_OP_START,
+    GROUP_OP_READ,
+} group_op_t;
+
+static int64_t _now_ns(void);
+static int8_t _transfer_sensor(tcs3472x_group_sensor_t *sensor, group_op_t op);
+static int8_t _transfer_all(tcs3472x_group_t *group, group_op_t op);
+
+int8_t tcs3472x_group_init(tcs3472x_group_t *group, tcs3472x_group_sensor_t *sensors, uint8_t count) {
+    uint8_t i = 0, b = 0;
+
+    if (count > TCS3472X_GROUP_MAX_SENSORS) {
+        LOG_ERROR("Too many sensors in group (%d).\r\n", count);
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (sensors[i].bus_path == NULL) {
+            LOG_ERROR("Sensor %d has no bus path.\r\n", i);
+            return -1;
+        }
+    }
+
+    memset(group, 0, sizeof(*group));
+    group->sensors = sensors;
+    group->sensor_count = count;
+
+    for (i = 0; i < count; i++) {
+        for (b = 0; b < group->bus_count; b++) {
+            if (strncmp(group->buses[b].path, sensors[i].bus_path, TCS3472X_GROUP_PATH_LEN) == 0) {
+                break;
+            }
+        }
+
+        if (b == group->bus_count) {
+            if (group->bus_count == TCS3472X_GROUP_MAX_BUSES) {
+                LOG_ERROR("Too many buses in group.\r\n");
+                return -1;
+            }
+            snprintf(group->buses[b].path, TCS3472X_GROUP_PATH_LEN, "%s", sensors[i].bus_path);
+            group->buses[b].fd = -1;
+            group->bus_count++;
+        }
+
+        sensors[i].bus_index = b;
+    }
+
+    return tcs3472x_i2c_hal_init(0);
+}
+
+int8_t tcs3472x_group_configure(tcs3472x_group_t *group) {
+    return _transfer_all(group, GROUP_OP_CONFIGURE);
+}
+
+int8_t tcs3472x_group_start(tcs3472x_group_t *group) {
+    int64_t earliest = INT64_MAX;
+    uint8_t i = 0;
+
+    if (_transfer_all(group, GROUP_OP_START) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (group->sensors[i].start_ns < earliest) {
+            earliest = group->sensors[i].start_ns;
+        }
+    }
+
+    group->max_start_skew_ns = 0;
+    for (i = 0; i < group->sensor_count; i++) {
+        group->sensors[i].start_skew_ns = group->sensors[i].start_ns - earliest;
+        if (group->sensors[i].start_skew_ns > group->max_start_skew_ns) {
+            group->max_start_skew_ns = group->sensors[i].start_skew_ns;
+        }
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_read(tcs3472x_group_t *group) {
+    int64_t earliest = INT64_MAX;
+    uint8_t i = 0;
+
+    if (_transfer_all(group, GROUP_OP_READ) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (group->sensors[i].read_ns < earliest) {
+            earliest = group->sensors[i].read_ns;
+        }
+    }
+
+    group->max_read_skew_ns = 0;
+    for (i = 0; i < group->sensor_count; i++) {
+        group->sensors[i].read_skew_ns = group->sensors[i].read_ns - earliest;
+        if (group->sensors[i].read_skew_ns > group->max_read_skew_ns) {
+            group->max_read_skew_ns = group->sensors[i].read_skew_ns;
+        }
+    }
+
+    return 0;
+}
+
+int8_t tcs3472x_group_read_sensor(tcs3472x_group_t *group, uint8_t index) {
+    if (index >= group->sensor_count) {
+        LOG_ERROR("No sensor %d in group.\r\n", index);
+        return -1;
+    }
+
+    return _transfer_sensor(&group->sensors[index], GROUP_OP_READ);
+}
+
+int8_t tcs3472x_group_close(tcs3472x_group_t *group) {
+    group->bus_count = 0;
+
+    return tcs3472x_i2c_hal_close();
+}
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+static int64_t _now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Runs every sensor of a group through a group operation, one sensor after the other.
+ *
+ * @param group The group to run.
+ * @param op Operation to perform.
+ * @return 0 on success, -1 on error.
+ */
+static int8_t _transfer_all(tcs3472x_group_t *group, group_op_t op) {
+    uint8_t i = 0;
+
+    for (i = 0; i < group->sensor_count; i++) {
+        if (_transfer_sensor(&group->sensors[i], op) < 0) {
+            LOG_ERROR("Failed to access simulated sensor %d.\r\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Performs a group operation on one sensor through the simulated HAL.
+ *
+ * The register traffic matches tcs3472x_group.c: a configuration writes ATIME and WTIME, a start
+ * writes ENABLE without and then with AEN, and a read fetches the 8 data bytes.
+ *
+ * @param sensor The sensor to access.
+ * @param op Operation to perform.
+ * @return 0 on success, -1 on error.
+ */
+static int8_t _transfer_sensor(tcs3472x_group_sensor_t *sensor, group_op_t op) {
+    uint8_t tx[2][2];
+    uint8_t rx[8];
+    int64_t t_begin = _now_ns();
+    int8_t result = 0;
+
+    if (op == GROUP_OP_CONFIGURE) {
+        tx[0][0] = COMMAND_BIT | ATIME_REGISTER;
+        tx[0][1] = sensor->atime;
+        tx[1][0] = COMMAND_BIT | WTIME_REGISTER;
+        tx[1][1] = sensor->wtime;
+        result = (tcs3472x_i2c_hal_write(tx[0], 2) < 0 || tcs3472x_i2c_hal_write(tx[1], 2) < 0) ? -1 : 0;
+    }
+    else if (op == GROUP_OP_START) {
+        tx[0][0] = COMMAND_BIT | ENABLE_REGISTER;
+        tx[0][1] = (sensor->enable | ENABLE_PON) & (uint8_t)~ENABLE_AEN;
+        tx[1][0] = COMMAND_BIT | ENABLE_REGISTER;
+        tx[1][1] = sensor->enable | ENABLE_PON | ENABLE_AEN;
+        result = (tcs3472x_i2c_hal_write(tx[0], 2) < 0 || tcs3472x_i2c_hal_write(tx[1], 2) < 0) ? -1 : 0;
+    }
+    else {
+        tx[0][0] = COMMAND_BIT | COMMAND_AUTO_INCREMENT | CDATAL_REGISTER;
+        result = tcs3472x_i2c_hal_write_read(tx[0], 1, rx, sizeof(rx));
+    }
+
+    tcs3472x_stats_record_transaction(&sensor->stats, (uint32_t)(_now_ns() - t_begin), result);
+    if (result < 0) {
+        return -1;
+    }
+
+    if (op == GROUP_OP_START) {
+        sensor->start_ns = _now_ns();
+    }
+    else if (op == GROUP_OP_READ) {
+        sensor->colors[0] = (rx[1] << 8) | rx[0];
+        sensor->colors[1] = (rx[3] << 8) | rx[2];
+        sensor->colors[2] = (rx[5] << 8) | rx[4];
+        sensor->colors[3] = (rx[7] << 8) | rx[6];
+        sensor->read_ns = _now_ns();
+        tcs3472x_stats_record_sample(&sensor->stats, sensor->colors[0], sensor->atime);
+    }
+
+    return 0;
+}
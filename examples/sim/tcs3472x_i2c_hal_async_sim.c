@@ -0,0 +1,124 @@
+/**
+ * @file tcs3472x_i2c_hal_async_sim.c
+ * @brief Simulated asynchronous I2C HAL with randomized completion latency.
+ *
+ * This file implements the HAL declared in tcs3472x_i2c_hal_async.h plus the control functions
+ * declared in tcs3472x_i2c_hal_async_sim.h. The bytes are moved through the synchronous simulated
+ * HAL when a transfer completes, so both HALs share one register file and one set of counters.
+ */
+
+#include <stddef.h>
+
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_async.h"
+#include "tcs3472x_i2c_hal_async_sim.h"
+
+/**
+ * The transfer in flight.
+ */
+typedef struct {
+    uint8_t active;                         ///< 1 while a transfer is in flight.
+    uint8_t is_read;                        ///< 1 for a read, 0 for a write.
+    uint8_t *buffer;                        ///< Bytes to move.
+    uint16_t length;                        ///< Number of bytes.
+    uint32_t remaining_ticks;               ///< Ticks until completion.
+    tcs3472x_i2c_hal_async_cb_t callback;   ///< Completion callback.
+    void *context;                          ///< Pointer handed to the callback.
+} sim_transfer_t;
+
+static sim_transfer_t transfer;
+static uint32_t rng_state = 1;
+static uint32_t latency_min = 0;
+static uint32_t latency_max = 0;
+
+static int8_t _start(uint8_t is_read, uint8_t *buffer, uint16_t length,
+                     tcs3472x_i2c_hal_async_cb_t callback, void *context);
+static void _complete(void);
+static uint32_t _random(void);
+
+int8_t tcs3472x_i2c_hal_async_write(const uint8_t *buffer, uint16_t length,
+                                    tcs3472x_i2c_hal_async_cb_t callback, void *context) {
+    // The simulated register file only reads from the buffer of a write
+    return _start(0, (uint8_t *)buffer, length, callback, context);
+}
+
+int8_t tcs3472x_i2c_hal_async_read(uint8_t *buffer, uint16_t length,
+                                   tcs3472x_i2c_hal_async_cb_t callback, void *context) {
+    return _start(1, buffer, length, callback, context);
+}
+
+void tcs3472x_i2c_hal_async_sim_init(uint32_t seed, uint32_t min_ticks, uint32_t max_ticks) {
+    rng_state = seed ? seed : 1;
+    latency_min = min_ticks;
+    latency_max = max_ticks < min_ticks ? min_ticks : max_ticks;
+    transfer.active = 0;
+}
+
+uint8_t tcs3472x_i2c_hal_async_sim_tick(void) {
+    if (!transfer.active) {
+        return 0;
+    }
+    if (transfer.remaining_ticks > 1) {
+        transfer.remaining_ticks--;
+        return 0;
+    }
+    _complete();
+    return 1;
+}
+
+uint8_t tcs3472x_i2c_hal_async_sim_busy(void) {
+    return transfer.active;
+}
+
+/**
+ * Queues a transfer, or completes it immediately when its latency is zero ticks.
+ */
+static int8_t _start(uint8_t is_read, uint8_t *buffer, uint16_t length,
+                     tcs3472x_i2c_hal_async_cb_t callback, void *context) {
+    if (transfer.active || callback == NULL) {
+        return -1;
+    }
+
+    transfer.active = 1;
+    transfer.is_read = is_read;
+    transfer.buffer = buffer;
+    transfer.length = length;
+    transfer.callback = callback;
+    transfer.context = context;
+    transfer.remaining_ticks = latency_min + _random() % (latency_max - latency_min + 1);
+
+    if (transfer.remaining_ticks == 0) {
+        _complete();
+    }
+    return 0;
+}
+
+/**
+ * Moves the bytes of the transfer in flight and runs its callback, as a completion interrupt would.
+ */
+static void _complete(void) {
+    tcs3472x_i2c_hal_async_cb_t callback = transfer.callback;
+    void *context = transfer.context;
+    int8_t result = 0;
+
+    if (transfer.is_read) {
+        result = tcs3472x_i2c_hal_read(transfer.buffer, transfer.length);
+    }
+    else {
+        result = tcs3472x_i2c_hal_write(transfer.buffer, transfer.length);
+    }
+
+    // The bus is free again before the callback runs, so it can start the next transfer
+    transfer.active = 0;
+    callback(context, result < 0 ? -1 : 0);
+}
+
+/**
+ * xorshift32 pseudo-random generator.
+ */
+static uint32_t _random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file tcs3472x_i2c_hal_sim.c
+ * @brief Simulated TCS3472x implementing the I2C HAL in memory.
+ *
+ * This file implements the HAL declared in tcs3472x_i2c_hal.h without any hardware, plus the
+ * inspection functions declared in tcs3472x_i2c_hal_sim.h. It is linked instead of a platform HAL.
+ */
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+
+#define REGISTER_COUNT      32
+#define REGISTER_MASK       (REGISTER_COUNT - 1)
+#define STATUS_AVALID       0x01
+
+static uint8_t registers[REGISTER_COUNT];
+static uint8_t pointer = 0;
+static uint8_t auto_increment = 0;
+static uint32_t fail_count = 0;
+static uint8_t absent = 0;
+static tcs3472x_i2c_hal_sim_stats_t sim_stats;
+
+static void _reset_registers(void);
+static int8_t _transaction_fails(void);
+static void _store(const uint8_t *buffer, uint16_t length);
+static void _load(uint8_t *buffer, uint16_t length);
+
+int8_t tcs3472x_i2c_hal_init(int device_address) {
+    (void)device_address;
+
+    _reset_registers();
+    return 0;
+}
+
+int8_t tcs3472x_i2c_hal_write(uint8_t *buffer, uint16_t length) {
+    if (_transaction_fails()) {
+        return -1;
+    }
+    _store(buffer, length);
+
+    sim_stats.transactions++;
+    sim_stats.bytes_written += length;
+    return 0;
+}
+
+int8_t tcs3472x_i2c_hal_read(uint8_t *buffer, uint16_t length) {
+    if (_transaction_fails()) {
+        return -1;
+    }
+    _load(buffer, length);
+
+    sim_stats.transactions++;
+    sim_stats.bytes_read += length;
+    return 0;
+}
+
+int8_t tcs3472x_i2c_hal_write_read(const uint8_t *tx, uint16_t tx_length, uint8_t *rx, uint16_t rx_length) {
+    if (_transaction_fails()) {
+        return -1;
+    }
+    _store(tx, tx_length);
+    _load(rx, rx_length);
+
+    sim_stats.transactions++;
+    sim_stats.bytes_written += tx_length;
+    sim_stats.bytes_read += rx_length;
+    return 0;
+}
+
+int8_t tcs3472x_i2c_hal_close(void) {
+    return 0;
+}
+
+void tcs3472x_i2c_hal_sim_set_colors(uint16_t clear, uint16_t red, uint16_t green, uint16_t blue) {
+    registers[CDATAL_REGISTER] = clear & 0xFF;
+    registers[CDATAH_REGISTER] = clear >> 8;
+    registers[RDATAL_REGISTER] = red & 0xFF;
+    registers[RDATAH_REGISTER] = red >> 8;
+    registers[GDATAL_REGISTER] = green & 0xFF;
+    registers[GDATAH_REGISTER] = green >> 8;
+    registers[BDATAL_REGISTER] = blue & 0xFF;
+    registers[BDATAH_REGISTER] = blue >> 8;
+}
+
+uint8_t tcs3472x_i2c_hal_sim_get_register(uint8_t reg_address) {
+    return registers[reg_address & REGISTER_MASK];
+}
+
+void tcs3472x_i2c_hal_sim_set_register(uint8_t reg_address, uint8_t value) {
+    registers[reg_address & REGISTER_MASK] = value;
+}
+
+void tcs3472x_i2c_hal_sim_power_cycle(void) {
+    _reset_registers();
+}
+
+void tcs3472x_i2c_hal_sim_set_present(uint8_t present) {
+    if (present && absent) {
+        _reset_registers();
+    }
+    absent = !present;
+}
+
+void tcs3472x_i2c_hal_sim_fail_next(uint32_t count) {
+    fail_count = count;
+}
+
+void tcs3472x_i2c_hal_sim_get_stats(tcs3472x_i2c_hal_sim_stats_t *stats) {
+    *stats = sim_stats;
+}
+
+void tcs3472x_i2c_hal_sim_reset_stats(void) {
+    sim_stats = (tcs3472x_i2c_hal_sim_stats_t){ 0 };
+}
+
+/**
+ * Decides whether the next transaction fails because the sensor is absent or a failure is injected.
+ *
+ * @return 1 if the transaction fails, 0 otherwise.
+ */
+static int8_t _transaction_fails(void) {
+    if (absent) {
+        sim_stats.errors++;
+        return 1;
+    }
+    if (fail_count > 0) {
+        fail_count--;
+        sim_stats.errors++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Handles the bytes of a write: an optional command byte, then data stored from the pointer on.
+ */
+static void _store(const uint8_t *buffer, uint16_t length) {
+    uint16_t i = 0;
+
+    if (length > 0 && (buffer[0] & COMMAND_BIT)) {
+        pointer = buffer[0] & REGISTER_MASK;
+        auto_increment = (buffer[0] & COMMAND_AUTO_INCREMENT) != 0;
+        i = 1;
+    }
+
+    for (; i < length; i++) {
+        registers[pointer] = buffer[i];
+        if (auto_increment) {
+            pointer = (pointer + 1) & REGISTER_MASK;
+        }
+    }
+}
+
+/**
+ * Returns the bytes of a read from the pointer on.
+ */
+static void _load(uint8_t *buffer, uint16_t length) {
+    uint16_t i = 0;
+
+    for (i = 0; i < length; i++) {
+        buffer[i] = registers[pointer];
+        if (auto_increment) {
+            pointer = (pointer + 1) & REGISTER_MASK;
+        }
+    }
+}
+
+/**
+ * Puts the register file into its power-on state.
+ */
+static void _reset_registers(void) {
+    uint8_t i = 0;
+
+    for (i = 0; i < REGISTER_COUNT; i++) {
+        registers[i] = 0;
+    }
+    registers[ATIME_REGISTER] = 0xFF;
+    registers[WTIME_REGISTER] = 0xFF;
+    registers[ID_REGISTER] = TCS3472X_SIM_DEFAULT_ID;
+    registers[STATUS_REGISTER] = STATUS_AVALID;
+    pointer = 0;
+    auto_increment = 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file tcs3472x_iio_demo.c
+ * @brief Runs the IIO backend against a fake sysfs tree and a FIFO standing in for the chardev.
+ *
+ * This program builds a temporary directory that looks like /sys and /dev with a tcs3472 IIO device
+ * behind an unrelated one, and a child process that writes packed scans into a FIFO in chunks that
+ * do not line up with the scan size, the way the kernel's buffer would. The backend opens the device,
+ * and the program checks the attributes it wrote, that every scan arrives unpacked in order, and
+ * how many scans each read() delivered. It exits with a non-zero status on any mismatch.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <ftw.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "tcs3472x_iio.h"
+
+#define SCANS               5000
+#define SCAN_SIZE           16          ///< Four le:u16 channels, then an le:s64 timestamp
+#define CHUNK_SIZE          1000        ///< Bytes per write, not a multiple of SCAN_SIZE
+#define BATCH               512
+#define PERIOD_NS           5000000LL   ///< 200 Hz
+
+static char root[] = "/tmp/tcs3472x_iio.XXXXXX";
+
+static const char *channels[] = { "in_intensity_clear", "in_intensity_red", "in_intensity_green",
+                                  "in_intensity_blue", "in_timestamp" };
+
+/**
+ * Creates a file below the root, with its parent directories, holding a value.
+ */
+static void put(const char *relative, const char *value) {
+    char path[TCS3472X_IIO_PATH_SIZE];
+    char *slash = NULL;
+    FILE *file = NULL;
+
+    snprintf(path, sizeof(path), "%s/%s", root, relative);
+    for (slash = strchr(path + strlen(root) + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(path, 0755);
+        *slash = '/';
+    }
+    file = fopen(path, "w");
+    if (file != NULL) {
+        fputs(value, file);
+        fclose(file);
+    }
+}
+
+/**
+ * Returns the value of a file below the root without its trailing newline.
+ */
+static const char *get(const char *relative) {
+    static char value[64];
+    char path[TCS3472X_IIO_PATH_SIZE];
+    FILE *file = NULL;
+
+    value[0] = '\0';
+    snprintf(path, sizeof(path), "%s/%s", root, relative);
+    file = fopen(path, "r");
+    if (file != NULL) {
+        if (fgets(value, sizeof(value), file) == NULL) {
+            value[0] = '\0';
+        }
+        fclose(file);
+    }
+    value[strcspn(value, "\n")] = '\0';
+    return value;
+}
+
+static void scan_colors(uint32_t n, uint16_t colors[4]) {
+    colors[0] = (uint16_t)(1000 + n * 13);
+    colors[1] = (uint16_t)(400 + n % 251);
+    colors[2] = (uint16_t)(350 + n % 241);
+    colors[3] = (uint16_t)(60000 + n % 5000);
+}
+
+/**
+ * Writes SCANS packed scans to the FIFO in CHUNK_SIZE pieces, as the kernel would fill its buffer.
+ */
+static void write_scans(const char *fifo) {
+    static uint8_t data[SCANS * SCAN_SIZE];
+    uint16_t colors[4];
+    int64_t timestamp = 0;
+    uint32_t n = 0, c = 0, b = 0, offset = 0;
+    int fd = open(fifo, O_WRONLY);
+
+    if (fd < 0) {
+        _exit(1);
+    }
+    for (n = 0; n < SCANS; n++) {
+        scan_colors(n, colors);
+        for (c = 0; c < 4; c++) {
+            data[n * SCAN_SIZE + 2 * c] = colors[c] & 0xFF;
+            data[n * SCAN_SIZE + 2 * c + 1] = colors[c] >> 8;
+        }
+        timestamp = n * PERIOD_NS;
+        for (b = 0; b < 8; b++) {
+            data[n * SCAN_SIZE + 8 + b] = (uint8_t)((uint64_t)timestamp >> (8 * b));
+        }
+    }
+    for (offset = 0; offset < sizeof(data); offset += CHUNK_SIZE) {
+        if (write(fd, data + offset, sizeof(data) - offset < CHUNK_SIZE ? sizeof(data) - offset : CHUNK_SIZE) < 0) {
+            _exit(1);
+        }
+    }
+    close(fd);
+    _exit(0);
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)st;
+    (void)flag;
+    (void)ftw;
+    return remove(path);
+}
+
+int main() {
+    static uint16_t colors[BATCH][4];
+    static int64_t timestamps[BATCH];
+    char path[TCS3472X_IIO_PATH_SIZE];
+    char name[TCS3472X_IIO_PATH_SIZE];
+    tcs3472x_iio_config_t config;
+    tcs3472x_iio_t iio;
+    uint16_t expected[4];
+    uint32_t received = 0, mismatches = 0, i = 0;
+    int32_t count = 0;
+    int failures = 0, status = 0, ok = 0;
+    pid_t child = 0;
+
+    if (mkdtemp(root) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    // An unrelated device first, then the sensor, an hrtimer trigger and the chardev
+    put("sys/bus/iio/devices/iio:device0/name", "ads1015\n");
+    put("sys/bus/iio/devices/iio:device3/name", "tcs3472\n");
+    put("sys/bus/iio/devices/iio:device3/buffer/enable", "0\n");
+    put("sys/bus/iio/devices/iio:device3/buffer/length", "2\n");
+    put("sys/bus/iio/devices/iio:device3/buffer/watermark", "1\n");
+    put("sys/bus/iio/devices/iio:device3/trigger/current_trigger", "\n");
+    for (i = 0; i < 5; i++) {
+        snprintf(name, sizeof(name), "sys/bus/iio/devices/iio:device3/scan_elements/%s_en", channels[i]);
+        put(name, "0\n");
+        snprintf(name, sizeof(name), "sys/bus/iio/devices/iio:device3/scan_elements/%s_index", channels[i]);
+        snprintf(path, sizeof(path), "%u\n", i);
+        put(name, path);
+        snprintf(name, sizeof(name), "sys/bus/iio/devices/iio:device3/scan_elements/%s_type", channels[i]);
+        put(name, i < 4 ? "le:u16/16>>0\n" : "le:s64/64>>0\n");
+    }
+    put("sys/bus/iio/devices/trigger0/name", "tcs3472x\n");
+    put("sys/bus/iio/devices/trigger0/sampling_frequency", "100\n");
+    put("dev/.keep", "");
+    snprintf(path, sizeof(path), "%s/dev/iio:device3", root);
+    mkfifo(path, 0600);
+
+    child = fork();
+    if (child == 0) {
+        write_scans(path);
+    }
+
+    tcs3472x_iio_config_default(&config);
+    snprintf(name, sizeof(name), "%s/sys", root);
+    config.sysfs_root = name;
+    snprintf(path, sizeof(path), "%s/dev", root);
+    config.dev_root = path;
+    config.sampling_hz = 200;
+
+    if (tcs3472x_iio_open(&iio, &config) < 0) {
+        printf("open FAILED\n");
+        kill(child, SIGKILL);
+        failures++;
+    }
+    else {
+        ok = strcmp(get("sys/bus/iio/devices/iio:device3/buffer/enable"), "1") == 0 &&
+             strcmp(get("sys/bus/iio/devices/iio:device3/buffer/length"), "1024") == 0 &&
+             strcmp(get("sys/bus/iio/devices/iio:device3/buffer/watermark"), "128") == 0 &&
+             strcmp(get("sys/bus/iio/devices/iio:device3/trigger/current_trigger"), "tcs3472x") == 0 &&
+             strcmp(get("sys/bus/iio/devices/iio:device3/scan_elements/in_timestamp_en"), "1") == 0 &&
+             strcmp(get("sys/bus/iio/devices/trigger0/sampling_frequency"), "200") == 0 &&
+             iio.scan_size == SCAN_SIZE;
+        printf("configured %s, scan size %u %s\n", iio.device_dir + strlen(root), iio.scan_size, ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+
+        while ((count = tcs3472x_iio_read(&iio, colors, timestamps, BATCH)) > 0) {
+            for (i = 0; i < (uint32_t)count; i++, received++) {
+                scan_colors(received, expected);
+                if (memcmp(colors[i], expected, sizeof(expected)) != 0 ||
+                    timestamps[i] != (int64_t)received * PERIOD_NS) {
+                    mismatches++;
+                }
+            }
+        }
+        tcs3472x_iio_close(&iio);
+
+        ok = count == 0 && received == SCANS && mismatches == 0 && iio.pending == 0;
+        printf("%u scans in %llu reads, %.1f scans per read, %u mismatches %s\n", received,
+               (unsigned long long)iio.reads, (double)received / (double)iio.reads, mismatches, ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+
+        ok = strcmp(get("sys/bus/iio/devices/iio:device3/buffer/enable"), "0") == 0;
+        printf("buffer disabled on close %s\n", ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+    }
+
+    waitpid(child, &status, 0);
+    nftw(root, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
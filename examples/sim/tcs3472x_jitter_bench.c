@@ -0,0 +1,109 @@
+/**
+ * @file tcs3472x_jitter_bench.c
+ * @brief Acquisition jitter benchmark against the simulated HAL under synthetic CPU load.
+ *
+ * This program runs the acquisition runner on the simulated sensor while a configurable number of
+ * busy threads compete for the CPUs, then prints the wake-up lateness percentiles. Running it once
+ * with priority 0 and once with a SCHED_FIFO priority (as root) shows what the real-time options buy.
+ *
+ * Usage: tcs3472x_jitter_bench [period_us] [seconds] [load_threads] [cpu] [priority] [lock_memory]
+ *
+ * By default one load thread runs per online CPU; pass 0 load threads to measure an idle system.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_acq.h"
+
+#define DEVICE_ADDRESS  0x29
+#define RING_CAPACITY   1024
+#define MAX_LOAD        64
+
+static tcs3472x_acq_sample_t samples[RING_CAPACITY];
+static atomic_int load_running = 1;
+
+/**
+ * Synthetic CPU load: spins on arithmetic until told to stop.
+ */
+static void *load_thread(void *arg) {
+    volatile uint64_t x = (uintptr_t)arg;
+
+    while (atomic_load_explicit(&load_running, memory_order_relaxed)) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    tcs3472x_acq_config_t config = {
+        .period_us = 1000,
+        .cpu = -1,
+        .priority = 0,
+        .lock_memory = 0,
+        .sync_window = 1,
+        .samples = samples,
+        .capacity = RING_CAPACITY,
+    };
+    tcs3472x_acq_t acq;
+    tcs3472x_acq_sample_t sample = { 0 };
+    tcs3472x_jitter_hist_t jitter;
+    pthread_t load[MAX_LOAD];
+    int seconds = 5, load_count = (int)sysconf(_SC_NPROCESSORS_ONLN), i = 0;
+    uint32_t received = 0;
+
+    if (argc > 1) config.period_us = atoi(argv[1]);
+    if (argc > 2) seconds = atoi(argv[2]);
+    if (argc > 3) load_count = atoi(argv[3]);
+    if (argc > 4) config.cpu = atoi(argv[4]);
+    if (argc > 5) config.priority = atoi(argv[5]);
+    if (argc > 6) config.lock_memory = atoi(argv[6]);
+    if (load_count > MAX_LOAD) load_count = MAX_LOAD;
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_init();
+
+    for (i = 0; i < load_count; i++) {
+        pthread_create(&load[i], NULL, load_thread, (void *)(uintptr_t)(i + 1));
+    }
+
+    if (tcs3472x_acq_start(&acq, &config) < 0) {
+        printf("Failed to start acquisition (real-time options may need privileges).\n");
+        return -1;
+    }
+
+    for (i = 0; i < seconds * 100; i++) {
+        while (tcs3472x_acq_pop(&acq, &sample)) {
+            received++;
+        }
+        usleep(10000);
+    }
+
+    tcs3472x_acq_stop(&acq);
+    atomic_store(&load_running, 0);
+    for (i = 0; i < load_count; i++) {
+        pthread_join(load[i], NULL);
+    }
+
+    tcs3472x_acq_get_jitter(&acq, &jitter);
+
+    printf("period %u us, %d s, %d load threads, cpu %d, priority %d, mlockall %d\n",
+           config.period_us, seconds, load_count, config.cpu, config.priority, config.lock_memory);
+    printf("wake-ups %u, samples %u, dropped %u, overruns %u, read errors %u\n",
+           jitter.count, received, acq.dropped, acq.overruns, acq.errors);
+    printf("lateness us: p50 %u  p90 %u  p99 %u  p99.9 %u  max %lld (>= %d means overflow)\n",
+           tcs3472x_jitter_percentile_us(&jitter, 500), tcs3472x_jitter_percentile_us(&jitter, 900),
+           tcs3472x_jitter_percentile_us(&jitter, 990), tcs3472x_jitter_percentile_us(&jitter, 999),
+           (long long)(jitter.max_ns / 1000), TCS3472X_ACQ_JITTER_BUCKETS);
+    printf("last sample: read latency %lld us, completed %lld us after its window midpoint\n",
+           (long long)(sample.read_latency_ns / 1000),
+           (long long)((sample.timestamp_ns - (sample.window_start_ns + sample.window_end_ns) / 2) / 1000));
+
+    tcs3472x_i2c_hal_close();
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file tcs3472x_lifecycle_demo.c
+ * @brief Unplugs and replugs the simulated sensor and checks that the lifecycle recovers.
+ *
+ * This program polls the lifecycle on a simulated clock, one poll per integration cycle. It starts
+ * with the sensor unplugged, plugs it in, unplugs it for a few seconds and plugs it back in, and
+ * finally reseats it so quickly that no read fails. After every recovery it checks that the sensor
+ * holds the desired configuration, including a gain the application changed while running, and that
+ * valid samples flow again. It exits with a non-zero status on any mismatch.
+ */
+
+#include <stdio.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_lifecycle.h"
+
+#define DEVICE_ADDRESS      0x29
+#define POLL_NS             24000000LL      ///< One 24 ms integration cycle per poll
+#define NS_PER_MS           1000000LL
+
+static const char *state_names[TCS3472X_LIFECYCLE_STATE_COUNT] = {
+    [TCS3472X_LIFECYCLE_ABSENT]         = "absent",
+    [TCS3472X_LIFECYCLE_PROBING]        = "probing",
+    [TCS3472X_LIFECYCLE_CONFIGURING]    = "configuring",
+    [TCS3472X_LIFECYCLE_RUNNING]        = "running",
+    [TCS3472X_LIFECYCLE_FAULTED]        = "faulted",
+};
+
+static int64_t now_ns = 0;
+static uint32_t sample_index = 0;
+
+/**
+ * Polls the lifecycle for a duration with varying light.
+ *
+ * @return The number of valid samples.
+ */
+static uint32_t run(tcs3472x_lifecycle_t *lifecycle, int64_t duration_ns) {
+    const int64_t end_ns = now_ns + duration_ns;
+    uint16_t colors[4];
+    uint32_t samples = 0;
+
+    while (now_ns < end_ns) {
+        sample_index++;
+        tcs3472x_i2c_hal_sim_set_colors(1000 + sample_index % 97, 400 + sample_index % 7,
+                                        350 + sample_index % 5, 250 + sample_index % 3);
+        samples += tcs3472x_lifecycle_poll(lifecycle, now_ns, colors) == 1;
+        now_ns += POLL_NS;
+    }
+    return samples;
+}
+
+/**
+ * Checks that the sensor holds the desired configuration and delivers samples.
+ *
+ * @return 0 if it does, 1 otherwise.
+ */
+static int check(tcs3472x_lifecycle_t *lifecycle, const char *name, uint32_t samples, uint8_t control) {
+    const tcs3472x_config_cache_t *config = &lifecycle->desired;
+    int ok = lifecycle->state == TCS3472X_LIFECYCLE_RUNNING && samples > 0 &&
+             tcs3472x_i2c_hal_sim_get_register(ATIME_REGISTER) == config->atime &&
+             tcs3472x_i2c_hal_sim_get_register(WTIME_REGISTER) == config->wtime &&
+             tcs3472x_i2c_hal_sim_get_register(AILTL_REGISTER) == (config->ailt & 0xFF) &&
+             tcs3472x_i2c_hal_sim_get_register(AILTH_REGISTER) == (config->ailt >> 8) &&
+             tcs3472x_i2c_hal_sim_get_register(CONTROL_REGISTER) == control &&
+             tcs3472x_i2c_hal_sim_get_register(ENABLE_REGISTER) == config->enable;
+
+    printf("%-18s %-8s %4u samples, %3u probes, %u configurations %s\n", name, state_names[lifecycle->state],
+           samples, lifecycle->probes, lifecycle->configurations, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main() {
+    tcs3472x_lifecycle_config_t config;
+    tcs3472x_lifecycle_t lifecycle;
+    tcs3472x_config_cache_t desired;
+    uint32_t probes = 0;
+    int failures = 0;
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_i2c_hal_sim_set_present(0);
+
+    // The desired configuration is known before the sensor is
+    desired = *tcs3472x_get_config_cache();
+    desired.atime = 0xF6;   // 24 ms
+    desired.ailt = 500;
+    desired.control = CONTROL_AGAIN_4X;
+    desired.enable = ENABLE_PON | ENABLE_AEN;
+
+    tcs3472x_lifecycle_config_default(&config);
+    tcs3472x_lifecycle_init(&lifecycle, &config, &desired, now_ns);
+
+    run(&lifecycle, 5000 * NS_PER_MS);
+    probes = lifecycle.probes;
+    printf("%-18s %-8s %4u probes in 5 s, backoff %lld ms %s\n", "boot unplugged", state_names[lifecycle.state],
+           probes, (long long)(lifecycle.backoff_ns / NS_PER_MS),
+           lifecycle.backoff_ns == config.max_backoff_ns && probes < 16 ? "ok" : "FAILED");
+    failures += lifecycle.backoff_ns == config.max_backoff_ns && probes < 16 ? 0 : 1;
+
+    tcs3472x_i2c_hal_sim_set_present(1);
+    failures += check(&lifecycle, "plugged in", run(&lifecycle, 2500 * NS_PER_MS), CONTROL_AGAIN_4X);
+
+    // A change made while running must survive the next disappearance
+    tcs3472x_set_gain(CONTROL_AGAIN_16X);
+
+    tcs3472x_i2c_hal_sim_set_present(0);
+    run(&lifecycle, 3000 * NS_PER_MS);
+    tcs3472x_i2c_hal_sim_set_present(1);
+    failures += check(&lifecycle, "unplug, replug", run(&lifecycle, 2500 * NS_PER_MS), CONTROL_AGAIN_16X);
+
+    tcs3472x_i2c_hal_sim_power_cycle();
+    failures += check(&lifecycle, "quick reseat", run(&lifecycle, 1000 * NS_PER_MS), CONTROL_AGAIN_16X);
+
+    printf("entries: absent %u, probing %u, configuring %u, running %u, faulted %u\n",
+           lifecycle.entries[TCS3472X_LIFECYCLE_ABSENT], lifecycle.entries[TCS3472X_LIFECYCLE_PROBING],
+           lifecycle.entries[TCS3472X_LIFECYCLE_CONFIGURING], lifecycle.entries[TCS3472X_LIFECYCLE_RUNNING],
+           lifecycle.entries[TCS3472X_LIFECYCLE_FAULTED]);
+    failures += lifecycle.entries[TCS3472X_LIFECYCLE_FAULTED] == 1 ? 0 : 1;
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+
+    tcs3472x_i2c_hal_close();
+    return failures == 0 ? 0 : 1;
+}
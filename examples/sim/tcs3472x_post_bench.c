@@ -0,0 +1,117 @@
+/**
+ * @file tcs3472x_post_bench.c
+ * @brief Runs the post-processing stage of a 256-sensor rig serially and on the work-stealing pool.
+ *
+ * This program generates batches of raw samples for 256 devices, processes them on one thread as a
+ * reference and then on pools of increasing size, and checks that every device ends in exactly the
+ * same state. It prints the time per batch, the speedup over the serial run and the pool's split and
+ * steal counts. The speedup is bounded by the number of CPUs the program runs on. It exits with a
+ * non-zero status on any mismatch.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_post.h"
+#include "tcs3472x_pool.h"
+
+#define DEVICES         256
+#define SAMPLES         64          ///< Samples per device and batch
+#define ROUNDS          200
+#define NS_PER_SEC      1000000000LL
+
+static uint16_t samples[DEVICES * SAMPLES][4];
+static tcs3472x_post_device_t reference[DEVICES];
+static tcs3472x_post_device_t devices[DEVICES];
+static tcs3472x_pool_t pool;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * Fills the batch of a round with varying light, a different level per device.
+ */
+static void generate(uint32_t round) {
+    uint32_t d = 0, s = 0, light = 0;
+
+    for (d = 0; d < DEVICES; d++) {
+        for (s = 0; s < SAMPLES; s++) {
+            light = 200 + d * 37 + (round * SAMPLES + s) % 500;
+            samples[d * SAMPLES + s][0] = (uint16_t)(light * 3);
+            samples[d * SAMPLES + s][1] = (uint16_t)(light + s % 7);
+            samples[d * SAMPLES + s][2] = (uint16_t)(light + light / 4);
+            samples[d * SAMPLES + s][3] = (uint16_t)(light - light / 4);
+        }
+    }
+}
+
+/**
+ * Gives every device its own calibration.
+ */
+static void init_devices(tcs3472x_post_device_t *set) {
+    uint32_t d = 0;
+    uint8_t c = 0;
+
+    for (d = 0; d < DEVICES; d++) {
+        tcs3472x_post_init(&set[d], 3, 0xF6, CONTROL_AGAIN_4X);
+        for (c = 0; c < 4; c++) {
+            set[d].dark[c] = (uint16_t)(d % 5 + c);
+            set[d].gain_q16[c] = TCS3472X_POST_GAIN_ONE + (d % 11) * 256 - c * 128;
+        }
+    }
+}
+
+int main() {
+    const uint32_t sizes[] = { 1, 2, 4, 8 };
+    tcs3472x_post_batch_t batch = { .samples = (const uint16_t (*)[4])samples, .count = SAMPLES };
+    tcs3472x_pool_stats_t stats;
+    int64_t begin = 0, serial_ns = 0, pool_ns = 0;
+    uint32_t round = 0, i = 0;
+    int failures = 0, ok = 0;
+
+    printf("%u devices, %u samples per device and batch, %ld CPUs\n", DEVICES, SAMPLES, sysconf(_SC_NPROCESSORS_ONLN));
+
+    init_devices(reference);
+    batch.devices = reference;
+    for (round = 0; round < ROUNDS; round++) {
+        generate(round);
+        begin = now_ns();
+        tcs3472x_post_range(&batch, 0, DEVICES);
+        serial_ns += now_ns() - begin;
+    }
+    printf("serial     %8.1f us/batch\n", (double)serial_ns / ROUNDS / 1000);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        init_devices(devices);
+        batch.devices = devices;
+        if (tcs3472x_pool_start(&pool, sizes[i]) < 0) {
+            return 1;
+        }
+        pool_ns = 0;
+        for (round = 0; round < ROUNDS; round++) {
+            generate(round);
+            begin = now_ns();
+            tcs3472x_pool_run(&pool, tcs3472x_post_range, &batch, DEVICES, 0);
+            pool_ns += now_ns() - begin;
+        }
+        tcs3472x_pool_get_stats(&pool, &stats);
+        tcs3472x_pool_stop(&pool);
+
+        ok = memcmp(devices, reference, sizeof(devices)) == 0 && stats.runs == ROUNDS;
+        printf("%u workers  %8.1f us/batch, %.2fx, %llu batches, %llu splits, %llu steals %s\n", sizes[i],
+               (double)pool_ns / ROUNDS / 1000, (double)serial_ns / (double)pool_ns,
+               (unsigned long long)stats.batches, (unsigned long long)stats.splits,
+               (unsigned long long)stats.steals, ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+    }
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file tcs3472x_power_plan.c
+ * @brief Power planner for TCS3472x deployments.
+ *
+ * This program finds the lowest-power configuration for the requested sample rate and scene
+ * brightness, applies it to the simulated sensor through the driver setters, and prints the power
+ * estimate of the configuration the driver now caches next to the estimate of the power-on default
+ * driven by tcs3472x_init().
+ *
+ * Usage: tcs3472x_power_plan <rate_hz> <min_counts_per_s> <max_counts_per_s> <min_snr> [noise_counts]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_power.h"
+
+#define DEVICE_ADDRESS      0x29
+#define DEFAULT_NOISE_COUNTS 1
+
+/**
+ * Prints one estimate.
+ */
+static void print_estimate(const char *name, const tcs3472x_config_cache_t *config,
+                           const tcs3472x_power_estimate_t *estimate) {
+    printf("%-10s ENABLE 0x%02X ATIME 0x%02X WTIME 0x%02X CONFIG 0x%02X CONTROL 0x%02X | cycle %8.1f ms | "
+           "sensor %7.1f uA %8.1f mJ/h | bus %7.1f mJ/h\n",
+           name, config->enable, config->atime, config->wtime, config->config, config->control,
+           estimate->cycle_us / 1000.0, estimate->sensor_na / 1000.0, estimate->sensor_uj_per_hour / 1000.0,
+           estimate->bus_uj_per_hour / 1000.0);
+}
+
+int main(int argc, char **argv) {
+    tcs3472x_power_params_t params;
+    tcs3472x_power_requirement_t requirement;
+    tcs3472x_config_cache_t plan;
+    tcs3472x_power_estimate_t estimate;
+    const tcs3472x_config_cache_t *cache = NULL;
+
+    if (argc < 5) {
+        printf("Usage: %s <rate_hz> <min_counts_per_s> <max_counts_per_s> <min_snr> [noise_counts]\n", argv[0]);
+        return -1;
+    }
+
+    requirement.rate_mhz = (uint32_t)(atof(argv[1]) * 1000);
+    requirement.min_counts_per_s = (uint32_t)strtoul(argv[2], NULL, 0);
+    requirement.max_counts_per_s = (uint32_t)strtoul(argv[3], NULL, 0);
+    requirement.min_snr = (uint16_t)strtoul(argv[4], NULL, 0);
+    requirement.noise_counts = argc > 5 ? (uint16_t)strtoul(argv[5], NULL, 0) : DEFAULT_NOISE_COUNTS;
+
+    tcs3472x_power_params_default(&params);
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+
+    tcs3472x_init();
+    tcs3472x_power_estimate(&params, tcs3472x_get_config_cache(), requirement.rate_mhz, &estimate);
+    print_estimate("default", tcs3472x_get_config_cache(), &estimate);
+
+    if (tcs3472x_power_plan(&params, &requirement, &plan, &estimate) < 0) {
+        printf("No configuration meets the requirement.\n");
+        tcs3472x_i2c_hal_close();
+        return 1;
+    }
+
+    if (tcs3472x_set_enable(0) < 0 ||
+        tcs3472x_set_atime_us((256 - plan.atime) * 2400) < 0 ||
+        tcs3472x_set_wtime(plan.wtime) < 0 ||
+        tcs3472x_set_wlong(plan.config & CONFIG_WLONG) < 0 ||
+        tcs3472x_set_gain(plan.control) < 0 ||
+        tcs3472x_set_enable(plan.enable) < 0) {
+        printf("Failed to apply the planned configuration.\n");
+        tcs3472x_i2c_hal_close();
+        return 1;
+    }
+
+    cache = tcs3472x_get_config_cache();
+    tcs3472x_power_estimate(&params, cache, requirement.rate_mhz, &estimate);
+    print_estimate("planned", cache, &estimate);
+
+    tcs3472x_i2c_hal_close();
+    return (cache->enable == plan.enable && cache->atime == plan.atime && cache->wtime == plan.wtime &&
+            cache->config == plan.config && cache->control == plan.control) ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file tcs3472x_sched_demo.c
+ * @brief Runs the read scheduler and the frame buffer on a simulated sensor group.
+ *
+ * This program builds a group of four simulated sensors on two buses, all integrating for 24 ms.
+ * It checks that the scheduler rejects an index outside the group and a period below the RGBC
+ * cycle, that reads released at the same AVALID event are issued earliest deadline first, and that
+ * a re-add rejected by bus admission leaves the sensor's running task and bus load untouched. It
+ * then captures the group into a 2 x 2 frame buffer and checks the planes, the frame the consumer
+ * holds and the skipped capture. It exits with a non-zero status on any mismatch.
+ */
+
+#include <stdio.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_bus_cost.h"
+#include "tcs3472x_frame.h"
+#include "tcs3472x_group.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_sched.h"
+
+#define SENSORS         4
+#define FRAME_WIDTH     2
+#define FRAME_HEIGHT    2
+#define SENSOR_ATIME    0xF6        ///< 24 ms integration
+#define CYCLE_US        24000
+#define PERIOD_US       (2 * CYCLE_US)
+#define NS_PER_US       1000LL
+
+static _Alignas(TCS3472X_FRAME_ALIGN) uint8_t frame_storage[TCS3472X_FRAME_STORAGE_SIZE(FRAME_WIDTH, FRAME_HEIGHT)];
+
+static uint8_t read_order[SENSORS];
+static uint8_t read_count;
+
+/**
+ * Records the order in which the scheduler reads the sensors.
+ */
+static void on_read(void *context, uint8_t sensor_index, const tcs3472x_group_sensor_t *sensor) {
+    (void)context;
+    (void)sensor;
+
+    if (read_count < SENSORS) {
+        read_order[read_count] = sensor_index;
+    }
+    read_count++;
+}
+
+/**
+ * Prints the outcome of one check.
+ *
+ * @return 0 if the check passed, 1 otherwise.
+ */
+static int check(const char *name, int ok) {
+    printf("%-46s %s\n", name, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/**
+ * Checks that every pixel of a frame holds the given colors.
+ */
+static int frame_holds(const tcs3472x_frame_t *frame, const uint16_t *colors) {
+    uint8_t c = 0, i = 0;
+
+    for (c = 0; c < TCS3472X_FRAME_CHANNELS; c++) {
+        for (i = 0; i < SENSORS; i++) {
+            if (frame->planes[c][i] != colors[c]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int main() {
+    tcs3472x_group_sensor_t sensors[SENSORS] = {
+        { .bus_path = "sim-0", .address = 0x29, .atime = SENSOR_ATIME, .wtime = 0xFF },
+        { .bus_path = "sim-0", .address = 0x39, .atime = SENSOR_ATIME, .wtime = 0xFF },
+        { .bus_path = "sim-1", .address = 0x29, .atime = SENSOR_ATIME, .wtime = 0xFF },
+        { .bus_path = "sim-1", .address = 0x39, .atime = SENSOR_ATIME, .wtime = 0xFF },
+    };
+    const uint16_t first[4] = { 1000, 400, 350, 250 };
+    const uint16_t second[4] = { 1200, 500, 420, 300 };
+    tcs3472x_group_t group;
+    tcs3472x_bus_config_t bus;
+    tcs3472x_sched_t sched;
+    tcs3472x_frame_buffer_t fb;
+    const tcs3472x_frame_t *frame = NULL;
+    int64_t start_ns = 0;
+    uint32_t bus_load_ppm = 0;
+    int failures = 0, skipped = 0;
+    uint8_t i = 0;
+
+    if (tcs3472x_group_init(&group, sensors, SENSORS) < 0 || tcs3472x_group_configure(&group) < 0 ||
+        tcs3472x_group_start(&group) < 0) {
+        printf("Failed to start the simulated group.\n");
+        return 1;
+    }
+    tcs3472x_i2c_hal_sim_set_colors(first[0], first[1], first[2], first[3]);
+    for (i = 0; i < SENSORS; i++) {
+        if (sensors[i].start_ns > start_ns) {
+            start_ns = sensors[i].start_ns;
+        }
+    }
+
+    tcs3472x_bus_config_default(&bus, TCS3472X_BUS_STANDARD_MODE_HZ);
+    tcs3472x_sched_init(&sched, &group, &bus, on_read, NULL);
+
+    // Admission checks that do not depend on the bus load
+    failures += check("index outside the group rejected",
+                      tcs3472x_sched_add(&sched, SENSORS, PERIOD_US, 10000, start_ns) < 0);
+    failures += check("period below the RGBC cycle rejected",
+                      tcs3472x_sched_add(&sched, 0, CYCLE_US / 2, 10000, start_ns) < 0 &&
+                      !sched.tasks[0].active);
+
+    // Three sensors become valid at the same AVALID event; deadline order is 1, 2, 0
+    if (tcs3472x_sched_add(&sched, 0, PERIOD_US, 20000, start_ns) < 0 ||
+        tcs3472x_sched_add(&sched, 1, PERIOD_US, 5000, start_ns) < 0 ||
+        tcs3472x_sched_add(&sched, 2, PERIOD_US, 10000, start_ns) < 0) {
+        failures += check("sensors admitted", 0);
+    }
+    tcs3472x_sched_poll(&sched, start_ns + (CYCLE_US + 1000) * NS_PER_US);
+    failures += check("released reads issued earliest deadline first",
+                      read_count == 3 && read_order[0] == 1 && read_order[1] == 2 && read_order[2] == 0);
+    failures += check("no deadline missed",
+                      sched.tasks[0].missed + sched.tasks[1].missed + sched.tasks[2].missed == 0);
+
+    // Fill bus 1 to its limit, then ask for a faster rate on a sensor that is already running
+    if (tcs3472x_sched_add(&sched, 3, PERIOD_US, 10000, start_ns) < 0) {
+        failures += check("sensor 3 admitted", 0);
+    }
+    bus_load_ppm = sched.bus_load_ppm[1];
+    sched.limit_ppm = bus_load_ppm;
+    failures += check("faster re-add over the bus limit rejected",
+                      tcs3472x_sched_add(&sched, 3, CYCLE_US, 10000, start_ns) < 0);
+    failures += check("rejected re-add keeps the running task",
+                      sched.tasks[3].active && sched.tasks[3].period_ns == PERIOD_US * NS_PER_US &&
+                      sched.bus_load_ppm[1] == bus_load_ppm);
+    failures += check("re-add at the same rate admitted",
+                      tcs3472x_sched_add(&sched, 3, PERIOD_US, 10000, start_ns) == 0 &&
+                      sched.bus_load_ppm[1] == bus_load_ppm);
+
+    // Double-buffered capture of the group as a 2 x 2 frame
+    if (tcs3472x_frame_buffer_init(&fb, FRAME_WIDTH, FRAME_HEIGHT, frame_storage, sizeof(frame_storage)) < 0) {
+        printf("Failed to initialize the frame buffer.\n");
+        return 1;
+    }
+    failures += check("nothing to acquire before the first capture", tcs3472x_frame_buffer_acquire(&fb) == NULL);
+    failures += check("first capture", tcs3472x_frame_buffer_capture(&fb, &group) == 0);
+    frame = tcs3472x_frame_buffer_acquire(&fb);
+    failures += check("first frame holds the sensor colors",
+                      frame != NULL && frame->sequence == 1 && frame_holds(frame, first));
+
+    tcs3472x_i2c_hal_sim_set_colors(second[0], second[1], second[2], second[3]);
+    failures += check("capture into the other frame while one is held",
+                      tcs3472x_frame_buffer_capture(&fb, &group) == 0);
+    skipped = tcs3472x_frame_buffer_capture(&fb, &group);
+    failures += check("capture skipped while the back frame is held", skipped == 1 && fb.skipped == 1);
+    failures += check("held frame unchanged", frame->sequence == 1 && frame_holds(frame, first));
+    tcs3472x_frame_buffer_release(&fb);
+
+    frame = tcs3472x_frame_buffer_acquire(&fb);
+    failures += check("next frame holds the new colors",
+                      frame != NULL && frame->sequence == 2 && frame_holds(frame, second));
+    tcs3472x_frame_buffer_release(&fb);
+
+    for (i = 0; i < SENSORS; i++) {
+        printf("sensor %u on bus %u: %u reads, %u missed, %u failed\n", i, sensors[i].bus_index,
+               sched.tasks[i].completed, sched.tasks[i].missed, sched.tasks[i].failed);
+    }
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+
+    tcs3472x_group_close(&group);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file tcs3472x_sort_demo.c
+ * @brief Sorts simulated parts on a conveyor by color and reports the trigger-to-decision latency.
+ *
+ * This program teaches in a palette of nine part colors on the simulated HAL, then sends parts of
+ * random color past the sensor at 60 to 120 % of the teach-in brightness, each with a few percent of
+ * channel noise, plus some empty triggers. Every part is sorted through trigger and poll, and the
+ * program checks the decision, the latency and the bus transactions per part. It also checks that
+ * grid lookups return the same reference as full scans over a sweep of the a*b* plane and times
+ * both. It exits with a non-zero status on any wrong decision or lookup mismatch.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_bus_cost.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_sort.h"
+
+#define DEVICE_ADDRESS  0x29
+#define PARTS           300
+#define EMPTY_EVERY     10          ///< Every tenth trigger has no part in view
+#define SWEEP_RANGE     (64 * TCS3472X_SORT_DELTA_E_ONE) ///< The sweep covers a* and b* from -64 to 64
+#define SWEEP_STEP      2           ///< Sweep step in 1/16 units
+#define NS_PER_SEC      1000000000LL
+
+/**
+ * Clear, red, green and blue counts of each part at the nominal distance, at ATIME 0xFF and 16x gain.
+ */
+static const uint16_t parts[][4] = {
+    { 600, 330, 120,  90 },     // red
+    { 640, 330, 200, 100 },     // orange
+    { 700, 300, 290, 110 },     // yellow
+    { 520, 130, 270, 130 },     // green
+    { 480, 100, 170, 240 },     // blue
+    { 500, 200, 120, 210 },     // purple
+    { 560, 120, 220, 220 },     // cyan
+    { 580, 280, 140, 170 },     // pink
+    { 800, 260, 280, 260 },     // white
+};
+
+#define PART_COUNT  (sizeof(parts) / sizeof(parts[0]))
+
+static const char *const part_names[PART_COUNT] = {
+    "red", "orange", "yellow", "green", "blue", "purple", "cyan", "pink", "white",
+};
+
+static tcs3472x_sorter_t sorter;
+static tcs3472x_sorter_t scanner;
+static uint32_t seed = 4711;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * Returns a uniform value in [0, range).
+ */
+static uint32_t random_below(uint32_t range) {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % range;
+}
+
+/**
+ * Puts a part in front of the simulated sensor, scaled to a brightness in percent and with up to
+ * 3 % noise per channel.
+ */
+static void show_part(uint32_t part, uint32_t brightness) {
+    uint16_t colors[4];
+    uint32_t c = 0, count = 0;
+
+    for (c = 0; c < 4; c++) {
+        count = parts[part][c] * brightness / 100;
+        colors[c] = (uint16_t)(count * (97 + random_below(7)) / 100);
+    }
+    tcs3472x_i2c_hal_sim_set_colors(colors[0], colors[1], colors[2], colors[3]);
+}
+
+/**
+ * Runs one trigger to its decision, busy polling like a sorting loop would.
+ *
+ * @return The end-to-end latency in nanoseconds, or -1 on error.
+ */
+static int64_t sort_one(tcs3472x_sort_decision_t *decision) {
+    int64_t trigger_ns = now_ns();
+    int8_t result = 0;
+
+    if (tcs3472x_sort_trigger(&sorter, trigger_ns) < 0) {
+        return -1;
+    }
+    while ((result = tcs3472x_sort_poll(&sorter, now_ns(), decision)) == 0) {
+    }
+    return result < 0 ? -1 : now_ns() - trigger_ns;
+}
+
+static int teach_in(void) {
+    tcs3472x_sort_decision_t decision;
+    uint32_t part = 0;
+
+    for (part = 0; part < PART_COUNT; part++) {
+        tcs3472x_i2c_hal_sim_set_colors(parts[part][0], parts[part][1], parts[part][2], parts[part][3]);
+        if (sort_one(&decision) < 0 || tcs3472x_sort_add_reference(&sorter, &decision.color) < 0) {
+            return -1;
+        }
+        printf("  %-7s a* %7.2f b* %7.2f\n", part_names[part], decision.color.a / 16.0, decision.color.b / 16.0);
+    }
+    return tcs3472x_sort_build_index(&sorter);
+}
+
+/**
+ * Compares grid lookups with full scans over the whole grid and prints the time per lookup of both.
+ *
+ * @return The number of mismatches.
+ */
+static uint32_t check_index(void) {
+    tcs3472x_sort_reference_t color;
+    volatile int32_t sink = 0;
+    int64_t begin = 0, grid_ns = 0, scan_ns = 0;
+    uint32_t lookups = 0, mismatches = 0;
+    uint16_t grid_delta = 0, scan_delta = 0;
+    int32_t a = 0, b = 0;
+
+    scanner = sorter;
+    scanner.indexed = 0;
+
+    for (a = -SWEEP_RANGE; a < SWEEP_RANGE; a += SWEEP_STEP) {
+        for (b = -SWEEP_RANGE; b < SWEEP_RANGE; b += SWEEP_STEP) {
+            color.a = (int16_t)a;
+            color.b = (int16_t)b;
+            if (tcs3472x_sort_match(&sorter, &color, &grid_delta) !=
+                    tcs3472x_sort_match(&scanner, &color, &scan_delta) || grid_delta != scan_delta) {
+                mismatches++;
+            }
+            lookups++;
+        }
+    }
+
+    begin = now_ns();
+    for (a = -SWEEP_RANGE; a < SWEEP_RANGE; a += SWEEP_STEP) {
+        for (b = -SWEEP_RANGE; b < SWEEP_RANGE; b += SWEEP_STEP) {
+            color.a = (int16_t)a;
+            color.b = (int16_t)b;
+            sink += tcs3472x_sort_match(&sorter, &color, NULL);
+        }
+    }
+    grid_ns = now_ns() - begin;
+
+    begin = now_ns();
+    for (a = -SWEEP_RANGE; a < SWEEP_RANGE; a += SWEEP_STEP) {
+        for (b = -SWEEP_RANGE; b < SWEEP_RANGE; b += SWEEP_STEP) {
+            color.a = (int16_t)a;
+            color.b = (int16_t)b;
+            sink += tcs3472x_sort_match(&scanner, &color, NULL);
+        }
+    }
+    scan_ns = now_ns() - begin;
+
+    printf("grid: %u candidates in %u cells; %u lookups, %u mismatches, grid %.1f ns, scan %.1f ns per lookup\n",
+           sorter.cell_start[TCS3472X_SORT_GRID_SIZE * TCS3472X_SORT_GRID_SIZE],
+           TCS3472X_SORT_GRID_SIZE * TCS3472X_SORT_GRID_SIZE, lookups, mismatches,
+           (double)grid_ns / lookups, (double)scan_ns / lookups);
+    return mismatches;
+}
+
+int main() {
+    tcs3472x_sort_config_t config;
+    tcs3472x_sort_decision_t decision;
+    tcs3472x_i2c_hal_sim_stats_t stats;
+    tcs3472x_bus_config_t bus;
+    int64_t latency_ns = 0, min_ns = INT64_MAX, max_ns = 0, sum_ns = 0, poll_sum_ns = 0;
+    uint32_t i = 0, part = 0, wrong = 0, rejects = 0, max_delta_e = 0;
+    int8_t expected = 0;
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_sort_config_default(&config);
+    if (tcs3472x_sort_init(&sorter, &config) < 0) {
+        return 1;
+    }
+
+    printf("teach-in:\n");
+    if (teach_in() < 0) {
+        printf("teach-in FAILED\n");
+        return 1;
+    }
+
+    tcs3472x_i2c_hal_sim_reset_stats();
+    for (i = 0; i < PARTS; i++) {
+        part = random_below(PART_COUNT);
+        if (i % EMPTY_EVERY == EMPTY_EVERY - 1) {
+            tcs3472x_i2c_hal_sim_set_colors(3, 1, 1, 1);
+            expected = TCS3472X_SORT_REJECT;
+        }
+        else {
+            show_part(part, 60 + random_below(61));
+            expected = (int8_t)part;
+        }
+
+        latency_ns = sort_one(&decision);
+        if (latency_ns < 0) {
+            printf("part %u: sorting FAILED\n", i);
+            return 1;
+        }
+        wrong += decision.reference != expected ? 1 : 0;
+        rejects += decision.reference == TCS3472X_SORT_REJECT ? 1 : 0;
+        if (decision.reference != TCS3472X_SORT_REJECT && decision.delta_e > max_delta_e) {
+            max_delta_e = decision.delta_e;
+        }
+        min_ns = latency_ns < min_ns ? latency_ns : min_ns;
+        max_ns = latency_ns > max_ns ? latency_ns : max_ns;
+        sum_ns += latency_ns;
+        poll_sum_ns += decision.latency_ns;
+    }
+    tcs3472x_i2c_hal_sim_get_stats(&stats);
+
+    tcs3472x_bus_config_default(&bus, TCS3472X_BUS_FAST_MODE_HZ);
+    printf("%u triggers: %u wrong, %u rejected, largest accepted Delta E %.2f\n", PARTS, wrong, rejects,
+           max_delta_e / 16.0);
+    printf("trigger to decision: min %.3f ms, mean %.3f ms, max %.3f ms (decision poll at %.3f ms mean)\n",
+           min_ns / 1e6, sum_ns / 1e6 / PARTS, max_ns / 1e6, poll_sum_ns / 1e6 / PARTS);
+    printf("bus: %.1f transactions per trigger, %.0f us at 400 kHz\n", (double)stats.transactions / PARTS,
+           (tcs3472x_bus_cost_ns(&bus, TCS3472X_BUS_OP_RESTART_INTEGRATION) +
+            tcs3472x_bus_cost_ns(&bus, TCS3472X_BUS_OP_GET_STATUS_COLORS)) / 1000.0);
+
+    wrong += check_index();
+    tcs3472x_i2c_hal_close();
+
+    printf("%s\n", wrong == 0 ? "ok" : "FAILED");
+    return wrong == 0 ? 0 : 1;
+}
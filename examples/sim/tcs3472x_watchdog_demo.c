@@ -0,0 +1,147 @@
+/**
+ * @file tcs3472x_watchdog_demo.c
+ * @brief Injects sensor faults into the simulated HAL and checks that the watchdog catches them.
+ *
+ * This program configures the simulated sensor, feeds the watchdog a healthy varying stream, and
+ * then injects one fault at a time: frozen data, a brownout that zeroes every register, a brownout
+ * that only clears ENABLE, implausible channel data and a different device ID. For each it prints
+ * how many samples the watchdog took to report the fault and checks that the configuration was
+ * written back. It also checks that steady saturated, dim and, with the zero check disabled, dark
+ * scenes raise no fault. It exits with a non-zero status on any mismatch.
+ */
+
+#include <stdio.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_i2c_hal_sim.h"
+#include "tcs3472x_watchdog.h"
+
+#define DEVICE_ADDRESS      0x29
+#define MAX_SAMPLES         200
+#define FULL_SCALE_24MS     10240   ///< Clear count full scale at 24 ms integration
+
+static uint32_t read_errors;
+
+static const char *fault_names[TCS3472X_WATCHDOG_FAULT_COUNT] = {
+    [TCS3472X_WATCHDOG_OK]          = "ok",
+    [TCS3472X_WATCHDOG_FROZEN]      = "frozen",
+    [TCS3472X_WATCHDOG_ZERO]        = "zero",
+    [TCS3472X_WATCHDOG_IMPLAUSIBLE] = "implausible",
+    [TCS3472X_WATCHDOG_ID_CHANGED]  = "id_changed",
+    [TCS3472X_WATCHDOG_DISABLED]    = "disabled",
+};
+
+typedef enum {
+    SCENE_VARYING,      ///< Healthy data that changes every sample
+    SCENE_FROZEN,       ///< Whatever the data registers hold, unchanged
+    SCENE_IMPLAUSIBLE,  ///< R + G + B five times the clear count
+    SCENE_SATURATED,    ///< Every channel at full scale
+    SCENE_DIM,          ///< Steady counts below min_clear
+    SCENE_DARK,         ///< All channels zero
+} scene_t;
+
+/**
+ * Reads samples until the watchdog reports a fault or MAX_SAMPLES pass.
+ *
+ * @return The number of samples read, with the fault in *fault.
+ */
+static int run(tcs3472x_watchdog_t *watchdog, scene_t scene, tcs3472x_watchdog_fault_t *fault) {
+    uint16_t colors[4];
+    int i = 0;
+
+    for (i = 1; i <= MAX_SAMPLES; i++) {
+        if (scene == SCENE_VARYING) {
+            tcs3472x_i2c_hal_sim_set_colors(1000 + i, 400 + i % 7, 350 + i % 5, 250 + i % 3);
+        }
+        else if (scene == SCENE_IMPLAUSIBLE) {
+            tcs3472x_i2c_hal_sim_set_colors(1000 + i, 2000, 2000, 1000);
+        }
+        else if (scene == SCENE_SATURATED) {
+            tcs3472x_i2c_hal_sim_set_colors(FULL_SCALE_24MS, FULL_SCALE_24MS, FULL_SCALE_24MS, FULL_SCALE_24MS);
+        }
+        else if (scene == SCENE_DIM) {
+            tcs3472x_i2c_hal_sim_set_colors(20, 8, 7, 5);
+        }
+        else if (scene == SCENE_DARK) {
+            tcs3472x_i2c_hal_sim_set_colors(0, 0, 0, 0);
+        }
+        if (tcs3472x_get_all_colors_data(colors) < 0) {
+            read_errors++;
+            continue;
+        }
+        *fault = tcs3472x_watchdog_feed(watchdog, colors);
+        if (*fault != TCS3472X_WATCHDOG_OK) {
+            return i;
+        }
+    }
+    return MAX_SAMPLES;
+}
+
+/**
+ * Runs one scenario and checks the fault and the restored registers.
+ *
+ * @return 0 if the expected fault was reported and the configuration restored, 1 otherwise.
+ */
+static int scenario(tcs3472x_watchdog_t *watchdog, const char *name, scene_t scene,
+                    tcs3472x_watchdog_fault_t expected) {
+    const tcs3472x_config_cache_t *config = tcs3472x_get_config_cache();
+    tcs3472x_watchdog_fault_t fault = TCS3472X_WATCHDOG_OK;
+    uint32_t recoveries = watchdog->recoveries;
+    int samples = run(watchdog, scene, &fault);
+    int ok = fault == expected &&
+             (expected == TCS3472X_WATCHDOG_OK || watchdog->recoveries == recoveries + 1) &&
+             tcs3472x_i2c_hal_sim_get_register(ENABLE_REGISTER) == config->enable &&
+             tcs3472x_i2c_hal_sim_get_register(ATIME_REGISTER) == config->atime &&
+             tcs3472x_i2c_hal_sim_get_register(CONTROL_REGISTER) == config->control;
+
+    printf("%-26s %-12s after %3d samples %s\n", name, fault_names[fault], samples, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main() {
+    tcs3472x_watchdog_config_t config;
+    tcs3472x_watchdog_t watchdog, dark_watchdog;
+    int failures = 0;
+
+    tcs3472x_i2c_hal_init(DEVICE_ADDRESS);
+    tcs3472x_init();
+    tcs3472x_set_atime_us(24000);
+    tcs3472x_set_gain(CONTROL_AGAIN_16X);
+
+    tcs3472x_watchdog_config_default(&config);
+    tcs3472x_watchdog_init(&watchdog, &config, tcs3472x_get_id());
+
+    failures += scenario(&watchdog, "healthy", SCENE_VARYING, TCS3472X_WATCHDOG_OK);
+    failures += scenario(&watchdog, "frozen data", SCENE_FROZEN, TCS3472X_WATCHDOG_FROZEN);
+
+    tcs3472x_i2c_hal_sim_power_cycle();
+    failures += scenario(&watchdog, "brownout", SCENE_FROZEN, TCS3472X_WATCHDOG_ZERO);
+
+    tcs3472x_i2c_hal_sim_set_register(ENABLE_REGISTER, 0);
+    failures += scenario(&watchdog, "enable cleared", SCENE_VARYING, TCS3472X_WATCHDOG_DISABLED);
+
+    failures += scenario(&watchdog, "implausible channels", SCENE_IMPLAUSIBLE, TCS3472X_WATCHDOG_IMPLAUSIBLE);
+
+    tcs3472x_i2c_hal_sim_set_register(ID_REGISTER, 0x4D);
+    failures += scenario(&watchdog, "different device", SCENE_VARYING, TCS3472X_WATCHDOG_ID_CHANGED);
+    tcs3472x_i2c_hal_sim_set_register(ID_REGISTER, TCS3472X_SIM_DEFAULT_ID);
+
+    failures += scenario(&watchdog, "saturated scene", SCENE_SATURATED, TCS3472X_WATCHDOG_OK);
+    failures += scenario(&watchdog, "dim scene", SCENE_DIM, TCS3472X_WATCHDOG_OK);
+
+    // Where complete darkness is possible, brownouts are left to the register check
+    config.zero_limit = 0;
+    tcs3472x_watchdog_init(&dark_watchdog, &config, tcs3472x_get_id());
+    failures += scenario(&dark_watchdog, "dark scene, no zero check", SCENE_DARK, TCS3472X_WATCHDOG_OK);
+    tcs3472x_i2c_hal_sim_power_cycle();
+    failures += scenario(&dark_watchdog, "brownout, no zero check", SCENE_DARK, TCS3472X_WATCHDOG_DISABLED);
+
+    failures += read_errors != 0;
+    printf("%u recoveries, %u failed, %u read errors\n", watchdog.recoveries, watchdog.failed_recoveries,
+           read_errors);
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+
+    tcs3472x_i2c_hal_close();
+    return failures == 0 ? 0 : 1;
+}
@@ -4,8 +4,24 @@
 #include <stdint.h>
 
 // Macros
+// TCS3472X_MCU selects the microcontroller profile: no stdio, no floating point and no heap.
+#if defined(TCS3472X_MCU)
+#define LOG_DEBUG(format, ...) ((void)0)
+#define LOG_ERROR(format, ...) ((void)0)
+#elif defined(TCS3472X_LOG_DEFERRED)
+#include "tcs3472x_log.h"
+// Debug events would crowd errors out of the ring, so they are only recorded on request
+#if defined(TCS3472X_LOG_DEFERRED_DEBUG)
+#define LOG_DEBUG(format, ...) TCS3472X_LOG_EVENT(TCS3472X_LOG_LEVEL_DEBUG, "TCS3472X Debug: " format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) ((void)0)
+#endif
+#define LOG_ERROR(format, ...) TCS3472X_LOG_EVENT(TCS3472X_LOG_LEVEL_ERROR, "TCS3472X Error: " format, ##__VA_ARGS__)
+#else
+#include <stdio.h>
 #define LOG_DEBUG(format, ...) fprintf(stderr, "TCS3472X Debug: " format, ##__VA_ARGS__)
 #define LOG_ERROR(format, ...) fprintf(stderr, "TCS3472X Error: " format, ##__VA_ARGS__)
+#endif
 
 
 /* Register Map */
@@ -30,6 +46,35 @@
 #define BDATAL_REGISTER     0x1A    ///< Blue data low byte (Read only)
 #define BDATAH_REGISTER     0x1B    ///< Blue data high byte (Read only)
 
+/* Command byte */
+#define COMMAND_BIT             0x80    ///< Must be set in every command byte
+#define COMMAND_AUTO_INCREMENT  0x20    ///< Auto-increment protocol transaction type
+
+/* Enable register bits */
+#define ENABLE_PON      0x01    ///< Power on
+#define ENABLE_AEN      0x02    ///< RGBC enable
+#define ENABLE_WEN      0x08    ///< Wait enable
+#define ENABLE_AIEN     0x10    ///< RGBC interrupt enable
+
+/* Configuration register bits */
+#define CONFIG_WLONG    0x02    ///< Wait long: WTIME steps are 12 times longer (28.8 ms)
+
+/* Control register gain values (AGAIN) */
+#define CONTROL_AGAIN_1X    0x00    ///< 1x gain
+#define CONTROL_AGAIN_4X    0x01    ///< 4x gain
+#define CONTROL_AGAIN_16X   0x02    ///< 16x gain
+#define CONTROL_AGAIN_60X   0x03    ///< 60x gain
+
+/* Status register bits */
+#define STATUS_AVALID   0x01    ///< RGBC integration cycle completed
+#define STATUS_AINT     0x10    ///< RGBC clear channel interrupt
+
+/* Power-on register values */
+#define ATIME_DEFAULT   0xFF    ///< 2.4 ms integration time
+#define WTIME_DEFAULT   0xFF    ///< 2.4 ms wait time
+#define CONFIG_DEFAULT  0x00    ///< WLONG cleared
+#define CONTROL_DEFAULT 0x00    ///< 1x gain
+
 
 
 /**
@@ -47,6 +92,21 @@ typedef union {
     uint8_t byte;           ///< Combined byte representation of the enable register.
 } enable_register_t;
 
+/**
+ * @brief Register values last written by the driver.
+ *
+ * The driver keeps a copy of every configuration register it writes, so timing and planning code
+ * can use the active configuration without reading it back over the bus.
+ */
+typedef struct {
+    uint8_t enable;         ///< ENABLE register.
+    uint8_t atime;          ///< ATIME register.
+    uint8_t wtime;          ///< WTIME register.
+    uint8_t config;         ///< CONFIG register (WLONG).
+    uint8_t control;        ///< CONTROL register (AGAIN).
+    uint16_t ailt;          ///< Clear interrupt low threshold (AILTL, AILTH).
+} tcs3472x_config_cache_t;
+
 
 /**
  * @brief Initializes the TCS3472x sensor by setting the power on and enabling RGB color detection.
@@ -60,6 +120,73 @@ void tcs3472x_init(void);
  */
 uint8_t tcs3472x_get_enable(void); ///< Retrieves the current state of the enable register.
 
+/**
+ * @brief Writes the enable register of the TCS3472x sensor.
+ *
+ * Clearing and setting AEN restarts the RGBC integration cycle.
+ *
+ * @param enable New value of the enable register (see ENABLE_PON, ENABLE_AEN, ...).
+ * @return Returns 0 on success, or -1 if the write fails.
+ */
+int8_t tcs3472x_set_enable(uint8_t enable);
+
+/**
+ * @brief Restarts the RGBC integration cycle so the next sample only covers light from now on.
+ *
+ * Writes ENABLE with AEN cleared and then set within a single repeated byte transaction, keeping the
+ * other cached enable bits and PON set. AVALID is cleared until the new integration completes.
+ *
+ * @return Returns 0 on success, or -1 if the write fails.
+ */
+int8_t tcs3472x_restart_integration(void);
+
+/**
+ * @brief Retrieves the status register of the TCS3472x sensor.
+ *
+ * @return Current value of the status register (see STATUS_AVALID, STATUS_AINT). Returns 0 if the
+ *         read operation fails.
+ */
+uint8_t tcs3472x_get_status(void);
+
+/**
+ * @brief Returns the register values last written by the driver.
+ *
+ * @return Pointer to the driver's configuration cache.
+ */
+const tcs3472x_config_cache_t *tcs3472x_get_config_cache(void);
+
+/**
+ * @brief Replaces the configuration cache without touching the bus.
+ *
+ * For code that writes configuration registers through its own transactions, such as
+ * tcs3472x_apply_config(), to record what the sensor now runs with.
+ *
+ * @param config Register values the sensor was set to.
+ */
+void tcs3472x_set_config_cache(const tcs3472x_config_cache_t *config);
+
+/**
+ * @brief Writes a complete configuration to the sensor and caches it.
+ *
+ * Writes ATIME, then WTIME and the low interrupt threshold in one auto-increment write, then CONFIG
+ * and CONTROL, and ENABLE last so the sensor only starts once everything else is in place. The
+ * reserved registers between them keep this from being a single write.
+ *
+ * @param config Register values to write.
+ * @return Returns 0 on success, or -1 if a write fails. The cache is only updated on success.
+ */
+int8_t tcs3472x_apply_config(const tcs3472x_config_cache_t *config);
+
+/**
+ * @brief Writes every cached configuration register back to the sensor.
+ *
+ * Calls tcs3472x_apply_config() with the configuration cache, for example after the sensor lost power
+ * and came back with its power-on values.
+ *
+ * @return Returns 0 on success, or -1 if a write fails.
+ */
+int8_t tcs3472x_restore_config(void);
+
 /**
  * @brief Retrieves the ID of the TCS3472x sensor.
  *
@@ -69,6 +196,49 @@ uint8_t tcs3472x_get_enable(void); ///< Retrieves the current state of the enabl
  */
 uint8_t tcs3472x_get_id(void); ///< Retrieves the ID of the TCS3472x sensor.
 
+/**
+ * @brief Sets the integration time of the RGBC sensor using integer arithmetic only.
+ *
+ * The requested time is converted with tcs3472x_us_to_atime(), so it is rounded up to the next
+ * multiple of 2.4 milliseconds.
+ *
+ * @param integration_time_us Requested integration time in microseconds.
+ * @return The actual integration time in microseconds. Returns -1 on error.
+ */
+int32_t tcs3472x_set_atime_us(uint32_t integration_time_us);
+
+/**
+ * @brief Retrieves the integration time of the RGBC sensor using integer arithmetic only.
+ *
+ * @return The integration time in microseconds. Returns -1 on error.
+ */
+int32_t tcs3472x_get_atime_us(void);
+
+/**
+ * @brief Converts an ATIME register value to the integration time using integer arithmetic only.
+ *
+ * Follows the datasheet: (256 − ATIME) × 2.4 milliseconds, except for ATIME = 0, which the datasheet
+ * lists as 700 milliseconds. Timing code built on the driver uses this conversion so that it agrees
+ * with the driver.
+ *
+ * @param atime ATIME register value.
+ * @return The integration time in microseconds.
+ */
+int32_t tcs3472x_atime_to_us(uint8_t atime);
+
+/**
+ * @brief Converts an integration time to the ATIME register value using integer arithmetic only.
+ *
+ * The time is rounded up to the next multiple of 2.4 milliseconds:
+ * ATIME = 256 − ceil(integration time / 2.4 milliseconds), with at least one step. Times of 614.4
+ * milliseconds or more select ATIME = 0.
+ *
+ * @param integration_time_us Requested integration time in microseconds.
+ * @return The ATIME register value.
+ */
+uint8_t tcs3472x_us_to_atime(uint32_t integration_time_us);
+
+#ifndef TCS3472X_MCU
 /**
  * @brief Sets the integration time of the RGBC sensor.
  *
@@ -90,6 +260,34 @@ float tcs3472x_set_atime(float integration_time);
  * @return The integration time in milliseconds. Returns a negative value on error.
  */
 float tcs3472x_get_atime(void);
+#endif // TCS3472X_MCU
+
+/**
+ * @brief Writes the WTIME register of the TCS3472x sensor.
+ *
+ * The wait time is (256 − WTIME) × 2.4 milliseconds, or 12 times that with WLONG set. It only applies
+ * while WEN is set in the enable register.
+ *
+ * @param wtime New value of the WTIME register.
+ * @return Returns 0 on success, or -1 if the write fails.
+ */
+int8_t tcs3472x_set_wtime(uint8_t wtime);
+
+/**
+ * @brief Sets or clears WLONG in the configuration register.
+ *
+ * @param wlong Non-zero to multiply the wait time by 12.
+ * @return Returns 0 on success, or -1 if the write fails.
+ */
+int8_t tcs3472x_set_wlong(uint8_t wlong);
+
+/**
+ * @brief Sets the RGBC analog gain.
+ *
+ * @param again Gain value (CONTROL_AGAIN_1X, CONTROL_AGAIN_4X, CONTROL_AGAIN_16X or CONTROL_AGAIN_60X).
+ * @return Returns 0 on success, or -1 if the value is invalid or the write fails.
+ */
+int8_t tcs3472x_set_gain(uint8_t again);
 
 /**
  * @brief Sets the low threshold value for the interrupt persistence filter.
@@ -100,16 +298,32 @@ float tcs3472x_get_atime(void);
  * provided as a 16-bit unsigned integer.
  *
  * @param value The low threshold value to set (0 to 65535).
- * @return uint8_t Returns 0 if the operation was successful, or -1 otherwise.
+ * @return int8_t Returns 0 if the operation was successful, or -1 otherwise.
  */
-uint8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value);
+int8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value);
 
 /**
  * @brief Retrieves all color data from the sensor.
+ *
+ * The command byte and the 8 data bytes go over the bus as one combined write/read transaction.
+ *
  * @param buff Pointer to a buffer where the color data will be stored.
  * Buffer must be large enough to hold 4 uint16_t values.
+ * @return Returns 0 on success, or -1 if the bus transfer fails. The buffer is unchanged on failure.
+ */
+int8_t tcs3472x_get_all_colors_data(uint16_t *buff);
+
+/**
+ * @brief Retrieves the status register and all color data in one combined write/read transaction.
+ *
+ * Reading STATUS along with the data tells whether the sample belongs to a completed integration
+ * without a second bus transaction. Reads with AVALID set count as samples in tcs3472x_get_stats().
+ *
+ * @param status Destination for the status register (see STATUS_AVALID).
+ * @param buff Destination for the clear, red, green and blue data (4 uint16_t values).
+ * @return Returns 0 on success, or -1 if the bus transfer fails. Both outputs are unchanged on failure.
  */
-void tcs3472x_get_all_colors_data(uint16_t *buff);
+int8_t tcs3472x_get_status_colors(uint8_t *status, uint16_t *buff);
 
 /**
  * Reads and returns the clear channel data from the sensor.
@@ -0,0 +1,139 @@
+/**
+ * @file tcs3472x_acq.h
+ * @brief Periodic acquisition thread with real-time options and period jitter histogram.
+ *
+ * The acquisition runner reads all color channels of the sensor at a fixed period from a dedicated
+ * thread. The thread can be pinned to a CPU and run under SCHED_FIFO, memory can be locked with
+ * mlockall, and samples go into a caller-provided ring so nothing is allocated after start. The
+ * lateness of every wake-up against its absolute deadline is recorded into a histogram.
+ *
+ * With sync_window set, the thread restarts the integration cycle on start, times the first AVALID
+ * event and tags every sample with the estimated start and end of the integration window it covers,
+ * which is what sensor fusion should use instead of the read completion time.
+ */
+
+#ifndef TCS3472X_ACQ_H
+#define TCS3472X_ACQ_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "tcs3472x_timing.h"
+
+#define TCS3472X_ACQ_JITTER_BUCKETS 256 ///< Histogram buckets, 1 microsecond each.
+
+/**
+ * @brief One acquired sample.
+ */
+typedef struct {
+    int64_t timestamp_ns;       ///< CLOCK_MONOTONIC time the read completed.
+    int64_t read_latency_ns;    ///< Duration of the data read transaction.
+    int64_t window_start_ns;    ///< Estimated start of the integration window, or 0 if unknown.
+    int64_t window_end_ns;      ///< Estimated end of the integration window, or 0 if unknown.
+    uint16_t colors[4];         ///< Clear, red, green and blue data.
+} tcs3472x_acq_sample_t;
+
+/**
+ * @brief Histogram of wake-up lateness.
+ */
+typedef struct {
+    uint32_t buckets[TCS3472X_ACQ_JITTER_BUCKETS]; ///< Count per microsecond of lateness.
+    uint32_t overflow;                             ///< Wake-ups later than the last bucket.
+    uint32_t count;                                ///< Total recorded wake-ups.
+    int64_t max_ns;                                ///< Largest lateness seen.
+} tcs3472x_jitter_hist_t;
+
+/**
+ * @brief Acquisition runner options.
+ */
+typedef struct {
+    uint32_t period_us;             ///< Sampling period.
+    int cpu;                        ///< CPU to pin the thread to, or -1 to leave it unpinned.
+    int priority;                   ///< SCHED_FIFO priority (1 to 99), or 0 for the default policy.
+    uint8_t lock_memory;            ///< Non-zero to call mlockall before starting.
+    uint8_t sync_window;            ///< Non-zero to restart integration and estimate sample windows.
+    tcs3472x_acq_sample_t *samples; ///< Caller-provided sample ring.
+    uint32_t capacity;              ///< Number of entries in samples, must be a power of two.
+} tcs3472x_acq_config_t;
+
+/**
+ * @brief Acquisition runner state.
+ */
+typedef struct {
+    tcs3472x_acq_config_t config;   ///< Options the runner was started with.
+    pthread_t thread;               ///< Acquisition thread.
+    atomic_int running;             ///< Cleared to stop the thread.
+    atomic_uint head;               ///< Next ring slot written by the thread.
+    atomic_uint tail;               ///< Next ring slot read by the consumer.
+    uint32_t dropped;               ///< Samples lost because the ring was full.
+    uint32_t overruns;              ///< Periods skipped because a read took too long.
+    uint32_t errors;                ///< Failed reads, not published to the ring.
+    tcs3472x_jitter_hist_t jitter;  ///< Wake-up lateness, written by the thread only.
+    atomic_uint jitter_seq;         ///< Odd while the thread updates jitter.
+    tcs3472x_timing_t timing;       ///< Integration window model, valid if sync_window is set.
+} tcs3472x_acq_t;
+
+/**
+ * @brief Starts the acquisition thread.
+ *
+ * The sensor must already be initialized. The sample ring is touched before the thread starts so
+ * its pages are resident.
+ *
+ * @param acq Runner to start.
+ * @param config Options, copied into the runner.
+ * @return Returns 0 on success, or -1 if memory could not be locked, the ring capacity is not a
+ *         power of two, the CPU index is out of range, or the thread could not be created with the
+ *         requested CPU and priority.
+ */
+int8_t tcs3472x_acq_start(tcs3472x_acq_t *acq, const tcs3472x_acq_config_t *config);
+
+/**
+ * @brief Stops the acquisition thread and waits for it to exit.
+ *
+ * @param acq Runner to stop.
+ */
+void tcs3472x_acq_stop(tcs3472x_acq_t *acq);
+
+/**
+ * @brief Takes the oldest sample from the ring.
+ *
+ * @param acq Runner to take the sample from.
+ * @param sample Destination for the sample.
+ * @return Returns 1 if a sample was taken, or 0 if the ring is empty.
+ */
+int8_t tcs3472x_acq_pop(tcs3472x_acq_t *acq, tcs3472x_acq_sample_t *sample);
+
+/**
+ * @brief Restarts the integration cycle and anchors a window model to the first AVALID event.
+ *
+ * Every bus access is timestamped at its CLOCK_MONOTONIC midpoint. AVALID is polled every 100
+ * microseconds, so the first integration end is known to lie between the last poll that saw it clear
+ * and the first that saw it set. The runner calls this on start when sync_window is set.
+ *
+ * @param timing Model to initialize from the driver's configuration cache and anchor.
+ * @return Returns 0 on success, or -1 if the bus fails or AVALID never shows up.
+ */
+int8_t tcs3472x_acq_sync(tcs3472x_timing_t *timing);
+
+/**
+ * @brief Copies the current jitter histogram.
+ *
+ * May be called while the thread runs. The copy is retried until it did not overlap an update, so all
+ * fields belong to the same moment.
+ *
+ * @param acq Runner to read from.
+ * @param hist Destination for the copy.
+ */
+void tcs3472x_acq_get_jitter(tcs3472x_acq_t *acq, tcs3472x_jitter_hist_t *hist);
+
+/**
+ * @brief Computes a lateness percentile from a jitter histogram.
+ *
+ * @param hist Histogram to evaluate.
+ * @param permille Percentile in tenths of a percent (500 = median, 999 = 99.9th percentile).
+ * @return The percentile in microseconds, or TCS3472X_ACQ_JITTER_BUCKETS if it lies in the overflow.
+ */
+uint32_t tcs3472x_jitter_percentile_us(const tcs3472x_jitter_hist_t *hist, uint32_t permille);
+
+#endif // TCS3472X_ACQ_H
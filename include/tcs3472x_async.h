@@ -0,0 +1,160 @@
+/**
+ * @file tcs3472x_async.h
+ * @brief Non-blocking TCS3472x operations running on the asynchronous I2C HAL.
+ *
+ * Each operation is a small state machine advanced by the HAL completion callbacks of
+ * tcs3472x_i2c_hal_async.h: a start function queues the first transfer and returns, and the done
+ * callback runs from the completion context once the last transfer has finished. The CPU is free
+ * while bytes are on the bus. All state lives in a caller-provided tcs3472x_async_t, and one
+ * operation per state machine may be in progress at a time.
+ */
+
+#ifndef TCS3472X_ASYNC_H
+#define TCS3472X_ASYNC_H
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+
+/**
+ * @brief Called once when an operation has finished.
+ *
+ * Runs in the HAL completion context and may start the next operation.
+ *
+ * @param context Pointer passed to the start function.
+ * @param result 0 on success, -1 if a transfer failed.
+ */
+typedef void (*tcs3472x_async_done_t)(void *context, int8_t result);
+
+/**
+ * @brief State of the asynchronous driver. All fields are maintained by the tcs3472x_async functions.
+ */
+typedef struct {
+    tcs3472x_config_cache_t config; ///< Register values last written through this state machine.
+    uint8_t op;                     ///< Operation in progress.
+    uint8_t step;                   ///< Transfer of the operation in progress.
+    uint8_t reg_address;            ///< Register the operation targets.
+    uint8_t tx[3];                  ///< Bytes being written.
+    uint8_t rx[8];                  ///< Bytes being read.
+    uint16_t *colors;               ///< Destination of a color read.
+    uint8_t *value;                 ///< Destination of a register read.
+    tcs3472x_async_done_t done;     ///< Completion callback of the operation.
+    void *context;                  ///< Pointer handed to the completion callback.
+} tcs3472x_async_t;
+
+/**
+ * @brief Resets a state machine to idle with the power-on configuration.
+ *
+ * @param dev State machine to initialize.
+ */
+void tcs3472x_async_init(tcs3472x_async_t *dev);
+
+/**
+ * @brief Returns whether an operation is in progress.
+ *
+ * @param dev State machine.
+ * @return 1 if busy, 0 if idle.
+ */
+uint8_t tcs3472x_async_busy(const tcs3472x_async_t *dev);
+
+/**
+ * @brief Starts writing the enable register.
+ *
+ * @param dev State machine.
+ * @param enable New value of the enable register (see ENABLE_PON, ENABLE_AEN, ...).
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_set_enable(tcs3472x_async_t *dev, uint8_t enable, tcs3472x_async_done_t done,
+                                 void *context);
+
+/**
+ * @brief Starts writing the ATIME register.
+ *
+ * @param dev State machine.
+ * @param atime New ATIME register value.
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_set_atime(tcs3472x_async_t *dev, uint8_t atime, tcs3472x_async_done_t done,
+                                void *context);
+
+/**
+ * @brief Starts writing the WTIME register.
+ *
+ * @param dev State machine.
+ * @param wtime New WTIME register value.
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_set_wtime(tcs3472x_async_t *dev, uint8_t wtime, tcs3472x_async_done_t done,
+                                void *context);
+
+/**
+ * @brief Starts writing the CONFIG register.
+ *
+ * @param dev State machine.
+ * @param wlong Non-zero to multiply the wait time by 12 (WLONG).
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_set_wlong(tcs3472x_async_t *dev, uint8_t wlong, tcs3472x_async_done_t done,
+                                void *context);
+
+/**
+ * @brief Starts writing the CONTROL register.
+ *
+ * @param dev State machine.
+ * @param again Gain, CONTROL_AGAIN_1X to CONTROL_AGAIN_60X.
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if the gain is invalid, busy or the transfer
+ *         could not start.
+ */
+int8_t tcs3472x_async_set_gain(tcs3472x_async_t *dev, uint8_t again, tcs3472x_async_done_t done,
+                               void *context);
+
+/**
+ * @brief Starts writing the clear interrupt low threshold.
+ *
+ * Both bytes go out in a single auto-increment write, so the sensor never compares against half of
+ * an update.
+ *
+ * @param dev State machine.
+ * @param value New low threshold (AILTL, AILTH).
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_set_isr_threshold_low(tcs3472x_async_t *dev, uint16_t value, tcs3472x_async_done_t done,
+                                            void *context);
+
+/**
+ * @brief Starts reading the status register.
+ *
+ * @param dev State machine.
+ * @param status Destination of the status register, written before done runs.
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_get_status(tcs3472x_async_t *dev, uint8_t *status, tcs3472x_async_done_t done,
+                                 void *context);
+
+/**
+ * @brief Starts reading the clear, red, green and blue data.
+ *
+ * @param dev State machine.
+ * @param colors Destination of the four channels, written before done runs.
+ * @param done Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the operation was started, or -1 if busy or the transfer could not start.
+ */
+int8_t tcs3472x_async_get_all_colors_data(tcs3472x_async_t *dev, uint16_t *colors,
+                                          tcs3472x_async_done_t done, void *context);
+
+#endif // TCS3472X_ASYNC_H
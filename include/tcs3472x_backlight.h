@@ -0,0 +1,104 @@
+/**
+ * @file tcs3472x_backlight.h
+ * @brief Closed-loop display backlight controller driven by TCS3472x samples.
+ *
+ * Each sample is converted to lux with tcs3472x_lux.h and mapped to a backlight level on a
+ * logarithmic scale, which matches how brightness is perceived: every doubling of the ambient light
+ * between min_mlux and max_mlux raises the level by the same amount. A new target is only taken when
+ * the lux moves outside a relative hysteresis band around the lux of the current target, so sensor
+ * noise and flicker of the ambient light do not reach the display. The level moves towards the target
+ * at a limited rate so changes fade instead of jumping.
+ *
+ * The controller does no I/O of its own: levels are handed to a pluggable output, and time is a
+ * plain nanosecond count of whatever monotonic clock the caller uses. All arithmetic is integer.
+ */
+
+#ifndef TCS3472X_BACKLIGHT_H
+#define TCS3472X_BACKLIGHT_H
+
+#include <stdint.h>
+
+#include "tcs3472x_lux.h"
+
+/**
+ * @brief Output that applies a backlight level.
+ *
+ * @param context Context given in the configuration.
+ * @param level Level between min_level and max_level.
+ * @return 0 on success, -1 on error.
+ */
+typedef int8_t (*tcs3472x_backlight_output_t)(void *context, uint32_t level);
+
+/**
+ * @brief Controller configuration.
+ */
+typedef struct {
+    tcs3472x_lux_params_t lux;          ///< Lux calculation coefficients.
+    uint32_t min_mlux;                  ///< Ambient light mapped to min_level, in millilux (at least 1).
+    uint32_t max_mlux;                  ///< Ambient light mapped to max_level, in millilux.
+    uint32_t min_level;                 ///< Lowest output level.
+    uint32_t max_level;                 ///< Highest output level.
+    uint16_t hysteresis_permille;       ///< Relative lux change that sets a new target (100 = 10 %).
+    uint32_t max_levels_per_s;          ///< Fastest level change, 0 for immediate changes.
+    tcs3472x_backlight_output_t output; ///< Output the levels are written to.
+    void *context;                      ///< Passed to output.
+} tcs3472x_backlight_config_t;
+
+/**
+ * @brief Controller state.
+ */
+typedef struct {
+    tcs3472x_backlight_config_t config; ///< Configuration the controller was initialized with.
+    uint32_t anchor_mlux;       ///< Lux the current target was computed from.
+    uint32_t target;            ///< Level the controller moves towards.
+    uint32_t level;             ///< Level last written to the output.
+    int64_t moved_ns;           ///< Time of the last level change, the base of the rate limit.
+    uint32_t writes;            ///< Levels written to the output.
+    uint8_t started;            ///< Non-zero once the first level has been written.
+} tcs3472x_backlight_t;
+
+/**
+ * @brief Initializes a controller.
+ *
+ * @param backlight Controller to initialize.
+ * @param config Configuration, copied into the controller.
+ * @return Returns 0 on success, or -1 if the lux or level range is empty or there is no output.
+ */
+int8_t tcs3472x_backlight_init(tcs3472x_backlight_t *backlight, const tcs3472x_backlight_config_t *config);
+
+/**
+ * @brief Maps an illuminance to a level on the logarithmic scale of a configuration.
+ *
+ * @param config Configuration to map with.
+ * @param mlux Illuminance in millilux.
+ * @return Level between min_level and max_level.
+ */
+uint32_t tcs3472x_backlight_map(const tcs3472x_backlight_config_t *config, uint32_t mlux);
+
+/**
+ * @brief Feeds one illuminance value to the controller.
+ *
+ * The first call writes the mapped level directly. Later calls retarget only outside the hysteresis
+ * band and move the level by at most max_levels_per_s times the time since the last change.
+ *
+ * @param backlight Controller to update.
+ * @param mlux Illuminance in millilux.
+ * @param now_ns Current time.
+ * @return Returns 1 if a level was written, 0 if the level is unchanged, or -1 if the output failed.
+ */
+int8_t tcs3472x_backlight_update_lux(tcs3472x_backlight_t *backlight, uint32_t mlux, int64_t now_ns);
+
+/**
+ * @brief Feeds one sample to the controller.
+ *
+ * @param backlight Controller to update.
+ * @param colors Clear, red, green and blue data.
+ * @param atime ATIME register value the sample was taken with.
+ * @param again AGAIN value the sample was taken with.
+ * @param now_ns Current time.
+ * @return Same as tcs3472x_backlight_update_lux().
+ */
+int8_t tcs3472x_backlight_update(tcs3472x_backlight_t *backlight, const uint16_t colors[4], uint8_t atime,
+                                 uint8_t again, int64_t now_ns);
+
+#endif // TCS3472X_BACKLIGHT_H
@@ -0,0 +1,83 @@
+/**
+ * @file tcs3472x_backlight_sysfs.h
+ * @brief Linux sysfs backlight output and sample-synchronized control loop.
+ *
+ * The output writes levels to the brightness attribute of a /sys/class/backlight/<name> directory and
+ * reads the range from its max_brightness attribute. The attribute stays open, so a level change is a
+ * single pwrite. Any directory with the same two files works, which lets tests point the output at a
+ * temporary directory.
+ *
+ * The control loop restarts the integration cycle, anchors a window model to the first AVALID event
+ * with tcs3472x_acq_sync(), and then wakes shortly after each predicted integration end to read the
+ * sample and feed the controller. The time from the end of an integration to the level write is
+ * recorded, and stays well below one integration time.
+ */
+
+#ifndef TCS3472X_BACKLIGHT_SYSFS_H
+#define TCS3472X_BACKLIGHT_SYSFS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "tcs3472x_backlight.h"
+
+/**
+ * @brief Open sysfs backlight.
+ */
+typedef struct {
+    int fd;                     ///< Open brightness attribute.
+    uint32_t max_brightness;    ///< Value of max_brightness.
+    uint8_t regular_file;       ///< Non-zero if brightness is a regular file, which needs truncating.
+} tcs3472x_backlight_sysfs_t;
+
+/**
+ * @brief Latency of the control loop.
+ */
+typedef struct {
+    uint32_t samples;           ///< Samples fed to the controller.
+    uint32_t writes;            ///< Samples that changed the level.
+    uint32_t errors;            ///< Failed reads, skipped without updating the controller.
+    int64_t max_latency_ns;     ///< Longest time from an integration end to the controller's output.
+    int64_t sum_latency_ns;     ///< Sum of the times from integration end to the controller's output.
+} tcs3472x_backlight_latency_t;
+
+/**
+ * @brief Opens a sysfs backlight.
+ *
+ * @param sysfs Backlight to open.
+ * @param dir Backlight directory containing brightness and max_brightness.
+ * @return Returns 0 on success, or -1 if a file cannot be opened or max_brightness cannot be parsed.
+ */
+int8_t tcs3472x_backlight_sysfs_open(tcs3472x_backlight_sysfs_t *sysfs, const char *dir);
+
+/**
+ * @brief Output callback writing a level to an open sysfs backlight.
+ *
+ * @param context The tcs3472x_backlight_sysfs_t to write to.
+ * @param level Level to write, clamped to max_brightness.
+ * @return 0 on success, -1 on error.
+ */
+int8_t tcs3472x_backlight_sysfs_write(void *context, uint32_t level);
+
+/**
+ * @brief Closes a sysfs backlight.
+ *
+ * @param sysfs Backlight to close.
+ */
+void tcs3472x_backlight_sysfs_close(tcs3472x_backlight_sysfs_t *sysfs);
+
+/**
+ * @brief Runs the control loop on the sensor of the core driver until running is cleared.
+ *
+ * The sensor must already be initialized and configured. Samples are converted with the ATIME and
+ * gain of the driver's configuration cache.
+ *
+ * @param backlight Initialized controller.
+ * @param running Flag the loop checks once per cycle.
+ * @param latency Destination for the loop's latency counters, reset on start.
+ * @return Returns 0 when stopped, or -1 if synchronizing to the sensor or the output fails.
+ */
+int8_t tcs3472x_backlight_run(tcs3472x_backlight_t *backlight, atomic_int *running,
+                              tcs3472x_backlight_latency_t *latency);
+
+#endif // TCS3472X_BACKLIGHT_SYSFS_H
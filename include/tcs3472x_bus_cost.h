@@ -0,0 +1,110 @@
+/**
+ * @file tcs3472x_bus_cost.h
+ * @brief Bus time cost model and capacity planner for the TCS3472x driver.
+ *
+ * The model counts the I2C transactions, address phases and bytes each driver API puts on the bus
+ * and converts them to time for a given bus configuration. Every byte takes 9 bit times including
+ * its acknowledge, START, repeated START and STOP take one bit time each, and every STOP is followed
+ * by the bus free time before the next START. An optional fixed host overhead per transaction covers
+ * the software path (for example the i2c-dev syscall).
+ *
+ * All arithmetic is integer so the planner can run on the target as well as on a host.
+ */
+
+#ifndef TCS3472X_BUS_COST_H
+#define TCS3472X_BUS_COST_H
+
+#include <stdint.h>
+
+#define TCS3472X_BUS_STANDARD_MODE_HZ   100000  ///< I2C standard mode clock.
+#define TCS3472X_BUS_FAST_MODE_HZ       400000  ///< I2C fast mode clock.
+
+/**
+ * @brief Driver operations whose bus traffic is modeled.
+ */
+typedef enum {
+    TCS3472X_BUS_OP_INIT,                   ///< tcs3472x_init()
+    TCS3472X_BUS_OP_GET_ENABLE,             ///< tcs3472x_get_enable()
+    TCS3472X_BUS_OP_GET_ID,                 ///< tcs3472x_get_id()
+    TCS3472X_BUS_OP_SET_ATIME,              ///< tcs3472x_set_atime()
+    TCS3472X_BUS_OP_GET_ATIME,              ///< tcs3472x_get_atime()
+    TCS3472X_BUS_OP_SET_ISR_THRESHOLD_LOW,  ///< tcs3472x_set_isr_threshold_reg_low()
+    TCS3472X_BUS_OP_GET_ALL_COLORS,         ///< tcs3472x_get_all_colors_data()
+    TCS3472X_BUS_OP_GET_STATUS_COLORS,      ///< tcs3472x_get_status_colors()
+    TCS3472X_BUS_OP_GET_COLOR,              ///< tcs3472x_get_clear_data() and the other single channels
+    TCS3472X_BUS_OP_APPLY_CONFIG,           ///< tcs3472x_apply_config() and tcs3472x_restore_config()
+    TCS3472X_BUS_OP_RESTART_INTEGRATION,    ///< tcs3472x_restart_integration()
+    TCS3472X_BUS_OP_GROUP_CONFIGURE,        ///< tcs3472x_group_configure(), per sensor
+    TCS3472X_BUS_OP_GROUP_START,            ///< tcs3472x_group_start(), per sensor
+    TCS3472X_BUS_OP_GROUP_READ,             ///< tcs3472x_group_read() and tcs3472x_group_read_sensor(), per sensor
+    TCS3472X_BUS_OP_COUNT,
+} tcs3472x_bus_op_t;
+
+/**
+ * @brief Bus traffic of one operation.
+ */
+typedef struct {
+    uint8_t transactions;   ///< START ... STOP sequences.
+    uint8_t messages;       ///< Address phases, including those following a repeated START.
+    uint8_t bytes;          ///< Command and data bytes after the address phases.
+} tcs3472x_bus_ops_t;
+
+/**
+ * @brief Bus parameters the cost model depends on.
+ */
+typedef struct {
+    uint32_t bus_hz;        ///< SCL frequency.
+    uint32_t bus_free_ns;   ///< Bus free time between a STOP and the next START (tBUF).
+    uint32_t overhead_ns;   ///< Host software overhead per transaction.
+} tcs3472x_bus_config_t;
+
+/**
+ * @brief Fills a bus configuration with the I2C specification minimum bus free time for a clock.
+ *
+ * @param config Configuration to fill. overhead_ns is set to 0.
+ * @param bus_hz SCL frequency.
+ */
+void tcs3472x_bus_config_default(tcs3472x_bus_config_t *config, uint32_t bus_hz);
+
+/**
+ * @brief Returns the bus traffic the driver issues for an operation.
+ *
+ * @param op Operation to look up.
+ * @return Pointer to the traffic description, or NULL for an unknown operation.
+ */
+const tcs3472x_bus_ops_t *tcs3472x_bus_cost_ops(tcs3472x_bus_op_t op);
+
+/**
+ * @brief Predicts the bus time of one operation.
+ *
+ * @param config Bus configuration.
+ * @param op Operation to cost.
+ * @return Bus occupancy in nanoseconds, or 0 for an unknown operation.
+ */
+uint32_t tcs3472x_bus_cost_ns(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op);
+
+/**
+ * @brief Predicts the bus utilization of one sensor running an operation at a fixed rate.
+ *
+ * @param config Bus configuration.
+ * @param op Operation issued per sample.
+ * @param rate_mhz Sample rate in millihertz (1000 = 1 Hz).
+ * @return Utilization in parts per million of the bus time.
+ */
+uint32_t tcs3472x_bus_occupancy_ppm(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op,
+                                    uint32_t rate_mhz);
+
+/**
+ * @brief Computes how many sensors a bus can carry at a given rate.
+ *
+ * @param config Bus configuration.
+ * @param op Operation issued per sample.
+ * @param rate_mhz Sample rate of every sensor in millihertz (1000 = 1 Hz).
+ * @param limit_ppm Share of the bus time that may be used, in parts per million.
+ * @return The number of sensors that fit within the limit, or 0 if the operation is unknown or the
+ *         rate is 0.
+ */
+uint32_t tcs3472x_bus_max_sensors(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op,
+                                  uint32_t rate_mhz, uint32_t limit_ppm);
+
+#endif // TCS3472X_BUS_COST_H
@@ -0,0 +1,112 @@
+/**
+ * @file tcs3472x_classify.h
+ * @brief Light-source classification from channel ratios.
+ *
+ * Every sample is reduced to four features in 10-bit fixed point (1024 = 1.0): R/C, G/C, B/C and
+ * IR/C, with the IR estimate IR = (R + G + B − C) / 2 of DN40. The sample is assigned to the light
+ * source whose centroid is nearest in squared distance. This costs one division and a few dozen
+ * multiplications per sample, so it can run inline on every read, also in the microcontroller profile.
+ *
+ * The default centroids follow a channel model of daylight, incandescent, fluorescent and white LED
+ * light: incandescent light stands out by its IR share and red tilt, daylight by moderate IR with a
+ * flat spectrum, fluorescent light by its green share and LED light by its blue share with almost no
+ * IR. Sensors behind glass or a diffuser shift these ratios; centroids measured on the product
+ * should then replace the defaults.
+ *
+ * DN40 publishes a single set of open-air lux coefficients, so tcs3472x_classify_init() loads that set
+ * for every class. Lux values only depend on the class once the caller stores coefficients calibrated
+ * under each light source in lux[], for example by fitting each set against a reference lux meter.
+ *
+ * Samples darker than min_clear are classified as unknown. The streaming update only switches to a
+ * new class after switch_count samples in a row agree on it, so noise at a class boundary does not
+ * make the class, and with it the lux coefficients, flicker.
+ */
+
+#ifndef TCS3472X_CLASSIFY_H
+#define TCS3472X_CLASSIFY_H
+
+#include <stdint.h>
+
+#include "tcs3472x_lux.h"
+
+#define TCS3472X_CLASSIFY_FEATURES  4       ///< R/C, G/C, B/C and IR/C.
+#define TCS3472X_CLASSIFY_ONE       1024    ///< A ratio of 1.0 in feature units.
+
+/**
+ * @brief Light sources.
+ */
+typedef enum {
+    TCS3472X_LIGHT_UNKNOWN,         ///< Too dark to tell, or no sample yet.
+    TCS3472X_LIGHT_DAYLIGHT,        ///< Sun and sky light.
+    TCS3472X_LIGHT_INCANDESCENT,    ///< Incandescent and halogen lamps.
+    TCS3472X_LIGHT_FLUORESCENT,     ///< Fluorescent tubes and compact fluorescent lamps.
+    TCS3472X_LIGHT_LED,             ///< White LEDs.
+    TCS3472X_LIGHT_COUNT,
+} tcs3472x_light_t;
+
+/**
+ * @brief Classifier settings and streaming state.
+ */
+typedef struct {
+    uint16_t centroids[TCS3472X_LIGHT_COUNT][TCS3472X_CLASSIFY_FEATURES]; ///< Per light source; unknown is unused.
+    tcs3472x_lux_params_t lux[TCS3472X_LIGHT_COUNT];  ///< Lux coefficients per light source, set by the caller.
+    uint16_t min_clear;             ///< Clear count below which a sample is unknown.
+    uint16_t switch_count;          ///< Samples in a row needed to change the current class.
+    tcs3472x_light_t current;       ///< Current class of the stream.
+    tcs3472x_light_t candidate;     ///< Class the recent samples vote for.
+    uint16_t votes;                 ///< Samples in a row voting for candidate.
+    uint32_t counts[TCS3472X_LIGHT_COUNT]; ///< Samples classified, per class.
+} tcs3472x_classifier_t;
+
+/**
+ * @brief Initializes a classifier with the default centroids, DN40 lux coefficients for every class,
+ *        a minimum clear count of 64 and a switch count of 3.
+ *
+ * The lux coefficients are the same for every class; replace them with per-class calibrations.
+ *
+ * @param classifier Classifier to initialize.
+ */
+void tcs3472x_classify_init(tcs3472x_classifier_t *classifier);
+
+/**
+ * @brief Computes the ratio features of a sample.
+ *
+ * @param colors Clear, red, green and blue data.
+ * @param features Destination for R/C, G/C, B/C and IR/C in 10-bit fixed point, each at most 2047.
+ */
+void tcs3472x_classify_features(const uint16_t colors[4], uint16_t features[TCS3472X_CLASSIFY_FEATURES]);
+
+/**
+ * @brief Classifies one sample without touching the streaming state.
+ *
+ * @param classifier Classifier with the centroids.
+ * @param colors Clear, red, green and blue data.
+ * @param margin If not NULL, receives the distance to the second nearest centroid minus the distance
+ *               to the nearest one; small margins mark samples near a class boundary.
+ * @return The nearest light source, or TCS3472X_LIGHT_UNKNOWN below min_clear.
+ */
+tcs3472x_light_t tcs3472x_classify_sample(const tcs3472x_classifier_t *classifier, const uint16_t colors[4],
+                                          uint32_t *margin);
+
+/**
+ * @brief Classifies one sample of a stream and updates the current class.
+ *
+ * @param classifier Classifier to update.
+ * @param colors Clear, red, green and blue data.
+ * @return The current class after this sample.
+ */
+tcs3472x_light_t tcs3472x_classify_update(tcs3472x_classifier_t *classifier, const uint16_t colors[4]);
+
+/**
+ * @brief Computes the illuminance of a sample with the lux coefficients of the current class.
+ *
+ * @param classifier Classifier with the current class.
+ * @param colors Clear, red, green and blue data.
+ * @param atime ATIME register value the sample was taken with.
+ * @param again AGAIN value of the control register the sample was taken with.
+ * @return Illuminance in millilux, or TCS3472X_LUX_SATURATED if the clear channel is at full scale.
+ */
+uint32_t tcs3472x_classify_mlux(const tcs3472x_classifier_t *classifier, const uint16_t colors[4], uint8_t atime,
+                                uint8_t again);
+
+#endif // TCS3472X_CLASSIFY_H
@@ -0,0 +1,234 @@
+/**
+ * @file tcs3472x_config.hpp
+ * @brief Compile-time validated TCS3472x configuration with a precomputed burst write.
+ *
+ * tcs3472x::config_builder collects integration time, wait time, gain, interrupt persistence and
+ * thresholds in consteval setters. An out-of-range value stops compilation with an error pointing at
+ * config_error() and its message, instead of being clamped at runtime. build() converts the values to
+ * the exact register bytes and lays them out as auto-increment bursts over the writable register
+ * ranges, skipping the reserved addresses. ENABLE is written last so the sensor starts with the
+ * complete configuration.
+ *
+ *     constexpr auto cfg = tcs3472x::config_builder()
+ *                              .integration_time_us(24000)
+ *                              .gain(16)
+ *                              .persistence(5)
+ *                              .thresholds(100, 8000)
+ *                              .build();
+ *     tcs3472x::configure(dev, cfg);
+ */
+
+#ifndef TCS3472X_CONFIG_HPP
+#define TCS3472X_CONFIG_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "tcs3472x_device.hpp"
+
+namespace tcs3472x {
+
+/**
+ * @brief Reports an invalid configuration value.
+ *
+ * Deliberately not constexpr: reaching it during constant evaluation is a compile error whose
+ * diagnostic shows the message.
+ */
+inline void config_error(const char *message) { (void)message; }
+
+/**
+ * @brief One auto-increment write of the burst: command byte followed by register values.
+ */
+struct burst_segment {
+    uint8_t offset;     ///< Start of the segment in the burst buffer.
+    uint8_t length;     ///< Command byte plus data bytes.
+};
+
+/**
+ * @brief Register bytes of a configuration, ready to send.
+ */
+struct burst_config {
+    static constexpr uint8_t size = 15;         ///< Bytes of all segments.
+    static constexpr uint8_t segment_count = 5; ///< Separate write transactions.
+
+    std::array<uint8_t, size> bytes;                        ///< Command and data bytes of all segments.
+    std::array<burst_segment, segment_count> segments;      ///< Layout of bytes.
+    uint8_t enable;                                         ///< ENABLE value written last.
+    uint8_t atime;                                          ///< ATIME value.
+    uint8_t wtime;                                          ///< WTIME value.
+    uint8_t wlong;                                          ///< 1 if WLONG multiplies the wait by 12.
+};
+
+/**
+ * @brief consteval builder of a burst_config.
+ */
+class config_builder {
+public:
+    /** RGBC integration time; a multiple of 2.4 ms from 2.4 ms to 614.4 ms. */
+    consteval config_builder integration_time_us(uint32_t us) const {
+        config_builder next = *this;
+
+        if (us < 2400 || us > 614400 || us % 2400 != 0) {
+            config_error("integration time must be a multiple of 2400 us between 2400 and 614400 us");
+        }
+        next.atime_ = static_cast<uint8_t>(256 - us / 2400);
+        return next;
+    }
+
+    /**
+     * Wait time between cycles, which also enables the wait state; a multiple of 2.4 ms up to
+     * 614.4 ms, or a multiple of 28.8 ms (WLONG) up to 7.37 s.
+     */
+    consteval config_builder wait_time_us(uint32_t us) const {
+        config_builder next = *this;
+
+        if (us >= 2400 && us <= 614400 && us % 2400 == 0) {
+            next.wtime_ = static_cast<uint8_t>(256 - us / 2400);
+            next.wlong_ = 0;
+        }
+        else if (us > 614400 && us <= 7372800 && us % 28800 == 0) {
+            next.wtime_ = static_cast<uint8_t>(256 - us / 28800);
+            next.wlong_ = 1;
+        }
+        else {
+            config_error("wait time must be a multiple of 2400 us up to 614400 us, or of 28800 us up to 7372800 us");
+        }
+        next.wait_enable_ = 1;
+        return next;
+    }
+
+    /** Analog gain: 1, 4, 16 or 60. */
+    consteval config_builder gain(uint8_t multiplier) const {
+        config_builder next = *this;
+
+        for (uint8_t i = 0; i < again_multiplier.size(); i++) {
+            if (again_multiplier[i] == multiplier) {
+                next.again_ = i;
+                return next;
+            }
+        }
+        config_error("gain must be 1, 4, 16 or 60");
+        return next;
+    }
+
+    /** Consecutive out-of-range cycles before an interrupt: 0, 1, 2, 3 or a multiple of 5 up to 60. */
+    consteval config_builder persistence(uint8_t cycles) const {
+        config_builder next = *this;
+
+        if (cycles <= 3) {
+            next.apers_ = cycles;
+        }
+        else if (cycles % 5 == 0 && cycles <= 60) {
+            next.apers_ = static_cast<uint8_t>(3 + cycles / 5);
+        }
+        else {
+            config_error("persistence must be 0, 1, 2, 3 or a multiple of 5 up to 60");
+        }
+        return next;
+    }
+
+    /** Clear channel interrupt thresholds; enables the RGBC interrupt. */
+    consteval config_builder thresholds(uint16_t low, uint16_t high) const {
+        config_builder next = *this;
+
+        if (low > high) {
+            config_error("low threshold must not exceed high threshold");
+        }
+        next.low_ = low;
+        next.high_ = high;
+        next.interrupt_enable_ = 1;
+        return next;
+    }
+
+    /** Converts the values to register bytes; checks settings that depend on each other. */
+    consteval burst_config build() const {
+        burst_config cfg{};
+        uint8_t n = 0;
+
+        if (interrupt_enable_ && high_ > full_scale(atime_)) {
+            config_error("high threshold is above the full-scale count of the integration time");
+        }
+
+        cfg.atime = atime_;
+        cfg.wtime = wtime_;
+        cfg.wlong = wlong_;
+        cfg.enable = static_cast<uint8_t>(enable::pon | enable::aen | (wait_enable_ ? enable::wen : 0) |
+                                          (interrupt_enable_ ? enable::aien : 0));
+
+        // ATIME (0x01); 0x02 is reserved
+        cfg.segments[0] = { n, 2 };
+        cfg.bytes[n++] = command(reg::atime, command_type::auto_increment);
+        cfg.bytes[n++] = atime_;
+
+        // WTIME, AILTL, AILTH, AIHTL, AIHTH (0x03 to 0x07)
+        cfg.segments[1] = { n, 6 };
+        cfg.bytes[n++] = command(reg::wtime, command_type::auto_increment);
+        cfg.bytes[n++] = wtime_;
+        cfg.bytes[n++] = static_cast<uint8_t>(low_ & 0xFF);
+        cfg.bytes[n++] = static_cast<uint8_t>(low_ >> 8);
+        cfg.bytes[n++] = static_cast<uint8_t>(high_ & 0xFF);
+        cfg.bytes[n++] = static_cast<uint8_t>(high_ >> 8);
+
+        // PERS, CONFIG (0x0C, 0x0D); WLONG is bit 1 of CONFIG
+        cfg.segments[2] = { n, 3 };
+        cfg.bytes[n++] = command(reg::pers, command_type::auto_increment);
+        cfg.bytes[n++] = apers_;
+        cfg.bytes[n++] = static_cast<uint8_t>(wlong_ << 1);
+
+        // CONTROL (0x0F); AGAIN is bits 1:0
+        cfg.segments[3] = { n, 2 };
+        cfg.bytes[n++] = command(reg::control);
+        cfg.bytes[n++] = again_;
+
+        // ENABLE last, so the cycle starts with everything else in place
+        cfg.segments[4] = { n, 2 };
+        cfg.bytes[n++] = command(reg::enable);
+        cfg.bytes[n++] = cfg.enable;
+
+        return cfg;
+    }
+
+private:
+    uint8_t atime_ = 0xFF;
+    uint8_t wtime_ = 0xFF;
+    uint8_t wlong_ = 0;
+    uint8_t again_ = 0;
+    uint8_t apers_ = 0;
+    uint8_t wait_enable_ = 0;
+    uint8_t interrupt_enable_ = 0;
+    uint16_t low_ = 0;
+    uint16_t high_ = 0xFFFF;
+};
+
+/**
+ * @brief Writes a precomputed configuration to a device, one transport write per segment.
+ *
+ * @return 0 on success, -1 if a write failed.
+ */
+template <variant Variant, transport Transport>
+int8_t configure(device<Variant, Transport> &dev, const burst_config &cfg) {
+    for (const burst_segment &segment : cfg.segments) {
+        if (dev.write_bytes(&cfg.bytes[segment.offset], segment.length) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static_assert(config_builder().build().bytes[0] == 0xA1, "ATIME segment uses auto-increment");
+static_assert(config_builder().integration_time_us(24000).build().atime == 0xF6, "ATIME conversion");
+static_assert(config_builder().wait_time_us(1440000).build().wlong == 1, "long waits use WLONG");
+static_assert(config_builder().gain(60).persistence(60).build().bytes[9] == 0x0F, "PERS encoding");
+// The usage example in the file comment
+static_assert(config_builder()
+                  .integration_time_us(24000)
+                  .gain(16)
+                  .persistence(5)
+                  .thresholds(100, 8000)
+                  .build()
+                  .bytes[7] == (8000 >> 8),
+              "file comment example");
+
+} // namespace tcs3472x
+
+#endif // TCS3472X_CONFIG_HPP
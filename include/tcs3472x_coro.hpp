@@ -0,0 +1,482 @@
+/**
+ * @file tcs3472x_coro.hpp
+ * @brief Header-only C++20 coroutine interface over the TCS3472x request queue on Linux.
+ *
+ * A reactor waits in epoll on the completion eventfd of one or more request queues
+ * (tcs3472x_queue.h) and on a timerfd. Awaiting a device operation submits a queue request and
+ * suspends the coroutine; the reactor resumes it on the reactor thread when the bus worker has
+ * finished. wait_valid() sleeps on the timerfd until the sensor's next predicted AVALID and confirms
+ * it with a status read.
+ *
+ * Awaiters carry their queue request and timer link themselves and live in the coroutine frame, so a
+ * coroutine looping over co_await dev.read_sample() allocates nothing after it has started.
+ *
+ *     tcs3472x::task sampler(tcs3472x::async_device &dev) {
+ *         for (;;) {
+ *             co_await dev.wait_valid();
+ *             tcs3472x::sample s = co_await dev.read_sample();
+ *             ...
+ *         }
+ *     }
+ */
+
+#ifndef TCS3472X_CORO_HPP
+#define TCS3472X_CORO_HPP
+
+#include <array>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+#include "tcs3472x.h"
+#include "tcs3472x_group.h"
+#include "tcs3472x_queue.h"
+}
+
+namespace tcs3472x {
+
+/**
+ * @brief Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+inline int64_t now_ns() {
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Something the reactor completes: a finished queue request or an expired timer.
+ */
+class operation {
+public:
+    virtual void complete() = 0;
+
+protected:
+    ~operation() = default;
+};
+
+/**
+ * @brief A deadline registered with the reactor. Entries are linked in place, so none are allocated.
+ */
+class timer_entry : public operation {
+public:
+    int64_t deadline_ns = 0;    ///< CLOCK_MONOTONIC time at which complete() runs.
+
+protected:
+    ~timer_entry() = default;
+
+private:
+    friend class reactor;
+    timer_entry *next_ = nullptr;
+};
+
+/**
+ * @brief Fire-and-forget coroutine type; the coroutine starts immediately and frees itself when done.
+ */
+struct task {
+    struct promise_type {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Single-threaded epoll/timerfd event loop resuming coroutines.
+ */
+class reactor {
+public:
+    static constexpr int max_events = 16;   ///< Events handled per epoll_wait().
+    static constexpr uint32_t reap_batch = 16;  ///< Completions taken per tcs3472x_queue_reap().
+
+    reactor()
+        : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+          timer_fd_(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) {
+        epoll_event event{};
+
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_fd_ >= 0 && timer_fd_ >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event);
+        }
+    }
+
+    ~reactor() {
+        if (timer_fd_ >= 0) {
+            close(timer_fd_);
+        }
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    reactor(const reactor &) = delete;
+    reactor &operator=(const reactor &) = delete;
+
+    /**
+     * @brief Returns whether the epoll and timer descriptors were created.
+     */
+    bool valid() const { return epoll_fd_ >= 0 && timer_fd_ >= 0; }
+
+    /**
+     * @brief Watches the completion eventfd of a queue.
+     *
+     * @return 0 on success, -1 if an error occurs.
+     */
+    int8_t attach(tcs3472x_queue_t &queue) {
+        epoll_event event{};
+
+        event.events = EPOLLIN;
+        event.data.ptr = &queue;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, tcs3472x_queue_event_fd(&queue), &event) < 0) {
+            LOG_ERROR("Failed to watch queue eventfd (errno %d).\r\n", errno);
+            return -1;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Dispatches completions and timers until stop() is called.
+     */
+    void run() {
+        epoll_event events[max_events];
+        int count = 0;
+
+        running_ = true;
+        while (running_) {
+            count = epoll_wait(epoll_fd_, events, max_events, -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("Reactor wait failed (errno %d).\r\n", errno);
+                break;
+            }
+
+            for (int i = 0; i < count; i++) {
+                if (events[i].data.ptr == nullptr) {
+                    expire_timers();
+                }
+                else {
+                    drain(*static_cast<tcs3472x_queue_t *>(events[i].data.ptr));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Makes run() return after the current round of events. Call on the reactor thread.
+     */
+    void stop() { running_ = false; }
+
+    /**
+     * @brief Registers a timer entry; its complete() runs on the reactor thread once it is due.
+     */
+    void schedule(timer_entry &entry) {
+        timer_entry **link = &timers_;
+
+        while (*link != nullptr && (*link)->deadline_ns <= entry.deadline_ns) {
+            link = &(*link)->next_;
+        }
+        entry.next_ = *link;
+        *link = &entry;
+
+        if (timers_ == &entry) {
+            arm();
+        }
+    }
+
+private:
+    /**
+     * Completes every request on the queue's completion list.
+     */
+    void drain(tcs3472x_queue_t &queue) {
+        tcs3472x_queue_request_t *done[reap_batch];
+        uint32_t count = 0;
+
+        while ((count = tcs3472x_queue_reap(&queue, done, reap_batch)) > 0) {
+            for (uint32_t i = 0; i < count; i++) {
+                static_cast<operation *>(done[i]->context)->complete();
+            }
+        }
+    }
+
+    /**
+     * Completes every timer entry that is due and rearms the timerfd for the next one.
+     */
+    void expire_timers() {
+        uint64_t expirations = 0;
+        int64_t now = now_ns();
+        timer_entry *due = nullptr;
+
+        if (read(timer_fd_, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+            LOG_ERROR("Failed to read timerfd (errno %d).\r\n", errno);
+        }
+
+        // Unlink first: complete() may resume a coroutine that schedules new entries
+        while (timers_ != nullptr && timers_->deadline_ns <= now) {
+            due = timers_;
+            timers_ = due->next_;
+            due->next_ = nullptr;
+            due->complete();
+        }
+        arm();
+    }
+
+    /**
+     * Sets the timerfd to the earliest deadline, or disarms it.
+     */
+    void arm() {
+        itimerspec spec{};
+        int64_t deadline = 0;
+
+        if (timers_ != nullptr) {
+            // A zero it_value would disarm the timer instead of firing at once
+            deadline = timers_->deadline_ns > 0 ? timers_->deadline_ns : 1;
+            spec.it_value.tv_sec = deadline / 1000000000LL;
+            spec.it_value.tv_nsec = deadline % 1000000000LL;
+        }
+        if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+            LOG_ERROR("Failed to arm timerfd (errno %d).\r\n", errno);
+        }
+    }
+
+    int epoll_fd_;
+    int timer_fd_;
+    bool running_ = false;
+    timer_entry *timers_ = nullptr;
+};
+
+/**
+ * @brief Result of read_sample().
+ */
+struct sample {
+    int8_t result;                      ///< 0 on success, -1 if the read failed.
+    std::array<uint16_t, 4> colors;     ///< Clear, red, green and blue.
+    int64_t timestamp_ns;               ///< CLOCK_MONOTONIC time the read finished.
+};
+
+/**
+ * @brief Result of read_register().
+ */
+struct register_value {
+    int8_t result;                      ///< 0 on success, -1 if the read failed.
+    uint8_t value;                      ///< Register value.
+};
+
+/**
+ * @brief Awaiter suspending until a timer deadline.
+ */
+class sleep_awaiter : public timer_entry {
+public:
+    sleep_awaiter(reactor &r, int64_t deadline) : reactor_(r) { deadline_ns = deadline; }
+    sleep_awaiter(const sleep_awaiter &) = delete;
+
+    bool await_ready() const noexcept { return deadline_ns <= now_ns(); }
+    void await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        reactor_.schedule(*this);
+    }
+    void await_resume() const noexcept {}
+
+    void complete() override { handle_.resume(); }
+
+private:
+    reactor &reactor_;
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * @brief Awaiter submitting one queue request and suspending until it has completed.
+ */
+class request_awaiter : public operation {
+public:
+    request_awaiter(tcs3472x_queue_t &queue, uint8_t sensor, tcs3472x_queue_op_t op, uint8_t reg_address,
+                    uint8_t value)
+        : queue_(queue), request_{} {
+        request_.sensor = sensor;
+        request_.op = op;
+        request_.reg_address = reg_address;
+        request_.value = value;
+    }
+    request_awaiter(const request_awaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        request_.context = static_cast<operation *>(this);
+        if (tcs3472x_queue_submit(&queue_, &request_) < 0) {
+            request_.result = -1;
+            return false;
+        }
+        return true;
+    }
+
+    void complete() override { handle_.resume(); }
+
+protected:
+    tcs3472x_queue_t &queue_;
+    tcs3472x_queue_request_t request_;
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * @brief Awaiter of read_sample().
+ */
+class sample_awaiter : public request_awaiter {
+public:
+    sample_awaiter(tcs3472x_queue_t &queue, uint8_t sensor)
+        : request_awaiter(queue, sensor, TCS3472X_QUEUE_OP_READ_COLORS, CDATAL_REGISTER, 0) {}
+
+    sample await_resume() const noexcept {
+        return { request_.result,
+                 { request_.colors[0], request_.colors[1], request_.colors[2], request_.colors[3] },
+                 request_.complete_ns };
+    }
+};
+
+/**
+ * @brief Awaiter of read_register().
+ */
+class register_awaiter : public request_awaiter {
+public:
+    register_awaiter(tcs3472x_queue_t &queue, uint8_t sensor, uint8_t reg_address)
+        : request_awaiter(queue, sensor, TCS3472X_QUEUE_OP_READ_REGISTER, reg_address, 0) {}
+
+    register_value await_resume() const noexcept { return { request_.result, request_.value }; }
+};
+
+/**
+ * @brief Awaiter of write_register().
+ */
+class write_awaiter : public request_awaiter {
+public:
+    write_awaiter(tcs3472x_queue_t &queue, uint8_t sensor, uint8_t reg_address, uint8_t value)
+        : request_awaiter(queue, sensor, TCS3472X_QUEUE_OP_WRITE_REGISTER, reg_address, value) {}
+
+    int8_t await_resume() const noexcept { return request_.result; }
+};
+
+/**
+ * @brief Awaiter of wait_valid(): sleeps until the predicted AVALID, then confirms it on the bus.
+ *
+ * The prediction uses the start time and cached cycle configuration the group keeps for the sensor:
+ * the first result is valid one integration time after the start and every following one a full
+ * RGBC cycle later. If the sensor has not been started through the group, the status is polled
+ * right away.
+ */
+class valid_awaiter : public timer_entry {
+public:
+    static constexpr int64_t retry_ns = 1000000;   ///< Delay before polling STATUS again.
+
+    valid_awaiter(reactor &r, tcs3472x_queue_t &queue, uint8_t sensor)
+        : reactor_(r), queue_(queue), status_(*this), request_{} {
+        request_.sensor = sensor;
+        request_.op = TCS3472X_QUEUE_OP_READ_REGISTER;
+        request_.reg_address = STATUS_REGISTER;
+        request_.context = static_cast<operation *>(&status_);
+    }
+    valid_awaiter(const valid_awaiter &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        const tcs3472x_group_sensor_t &sensor = queue_.group->sensors[request_.sensor];
+        int64_t first = sensor.start_ns + tcs3472x_group_atime_ns(&sensor);
+        int64_t cycle = tcs3472x_group_cycle_ns(&sensor);
+        int64_t now = now_ns();
+
+        handle_ = handle;
+        request_.context = static_cast<operation *>(&status_);
+        deadline_ns = now;
+        if (sensor.start_ns > 0 && cycle > 0) {
+            deadline_ns = first;
+            if (now > first) {
+                deadline_ns = first + (now - first + cycle - 1) / cycle * cycle;
+            }
+        }
+        reactor_.schedule(*this);
+    }
+    int8_t await_resume() const noexcept { return result_; }
+
+    /** Timer expired: read STATUS. */
+    void complete() override {
+        if (tcs3472x_queue_submit(&queue_, &request_) < 0) {
+            result_ = -1;
+            handle_.resume();
+        }
+    }
+
+private:
+    /** Completion of the STATUS read, forwarded to the awaiter. */
+    struct status_operation : operation {
+        explicit status_operation(valid_awaiter &owner) : owner_(owner) {}
+        void complete() override { owner_.on_status(); }
+        valid_awaiter &owner_;
+    };
+
+    void on_status() {
+        if (request_.result < 0 || (request_.value & STATUS_AVALID)) {
+            result_ = request_.result;
+            handle_.resume();
+            return;
+        }
+        deadline_ns = now_ns() + retry_ns;
+        reactor_.schedule(*this);
+    }
+
+    reactor &reactor_;
+    tcs3472x_queue_t &queue_;
+    status_operation status_;
+    tcs3472x_queue_request_t request_;
+    std::coroutine_handle<> handle_;
+    int8_t result_ = 0;
+};
+
+/**
+ * @brief One sensor of a group, addressed through a request queue serviced by a reactor.
+ */
+class async_device {
+public:
+    /**
+     * @param r Reactor the queue is attached to.
+     * @param queue Running request queue of the sensor's group.
+     * @param sensor Index of the sensor in the group.
+     */
+    async_device(reactor &r, tcs3472x_queue_t &queue, uint8_t sensor)
+        : reactor_(r), queue_(queue), sensor_(sensor) {}
+
+    /** Reads clear, red, green and blue. */
+    sample_awaiter read_sample() { return sample_awaiter(queue_, sensor_); }
+
+    /** Waits for the next completed RGBC cycle; resumes with 0, or -1 if the status read failed. */
+    valid_awaiter wait_valid() { return valid_awaiter(reactor_, queue_, sensor_); }
+
+    /** Reads one register. */
+    register_awaiter read_register(uint8_t reg_address) { return register_awaiter(queue_, sensor_, reg_address); }
+
+    /** Writes one register; resumes with 0, or -1 if the write failed. */
+    write_awaiter write_register(uint8_t reg_address, uint8_t value) {
+        return write_awaiter(queue_, sensor_, reg_address, value);
+    }
+
+    /** Suspends until a CLOCK_MONOTONIC deadline. */
+    sleep_awaiter sleep_until(int64_t deadline_ns) { return sleep_awaiter(reactor_, deadline_ns); }
+
+private:
+    reactor &reactor_;
+    tcs3472x_queue_t &queue_;
+    uint8_t sensor_;
+};
+
+} // namespace tcs3472x
+
+#endif // TCS3472X_CORO_HPP
@@ -0,0 +1,282 @@
+/**
+ * @file tcs3472x_device.hpp
+ * @brief Header-only C++20 TCS3472x driver specialized at compile time per sensor variant.
+ *
+ * tcs3472x::device<Variant, Transport> knows the I2C address and expected ID of its variant at compile
+ * time. Register addresses and command bytes are constexpr, so every transaction buffer is built from
+ * constants and each operation inlines to one call of the transport. No exceptions, RTTI, heap or
+ * virtual calls are used, which keeps the layer free in firmware builds.
+ *
+ * A transport is any type with
+ *
+ *     int8_t write(uint8_t address, const uint8_t *tx, uint16_t tx_length);
+ *     int8_t write_read(uint8_t address, const uint8_t *tx, uint16_t tx_length, uint8_t *rx, uint16_t rx_length);
+ *
+ * returning 0 on success and a negative value on error. write_read() should issue the write and the
+ * read as one combined transaction (repeated start) where the bus supports it. c_hal_transport adapts
+ * the C HAL of tcs3472x_i2c_hal.h.
+ */
+
+#ifndef TCS3472X_DEVICE_HPP
+#define TCS3472X_DEVICE_HPP
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+
+extern "C" {
+#include "tcs3472x_i2c_hal.h"
+}
+
+namespace tcs3472x {
+
+/**
+ * @brief Register map.
+ */
+namespace reg {
+constexpr uint8_t enable = 0x00;    ///< Enables states and interrupts (R/W)
+constexpr uint8_t atime = 0x01;     ///< RGBC time (R/W)
+constexpr uint8_t wtime = 0x03;     ///< Wait time (R/W)
+constexpr uint8_t ailtl = 0x04;     ///< Clear interrupt low threshold low byte (R/W)
+constexpr uint8_t aihtl = 0x06;     ///< Clear interrupt high threshold low byte (R/W)
+constexpr uint8_t pers = 0x0C;      ///< Interrupt persistence filter (R/W)
+constexpr uint8_t config = 0x0D;    ///< Configuration (R/W)
+constexpr uint8_t control = 0x0F;   ///< Control (R/W)
+constexpr uint8_t id = 0x12;        ///< Device ID (Read only)
+constexpr uint8_t status = 0x13;    ///< Device status (Read only)
+constexpr uint8_t cdatal = 0x14;    ///< Clear data low byte (Read only)
+} // namespace reg
+
+/**
+ * @brief Enable register bits.
+ */
+namespace enable {
+constexpr uint8_t pon = 0x01;   ///< Power on
+constexpr uint8_t aen = 0x02;   ///< RGBC enable
+constexpr uint8_t wen = 0x08;   ///< Wait enable
+constexpr uint8_t aien = 0x10;  ///< RGBC interrupt enable
+} // namespace enable
+
+/**
+ * @brief Transaction types of the command register.
+ */
+enum class command_type : uint8_t {
+    repeat_byte = 0b00,         ///< Repeat reading/writing the same register.
+    auto_increment = 0b01,      ///< Auto-increment the register address on sequential reads/writes.
+    special_function = 0b11,    ///< Special functions.
+};
+
+/**
+ * @brief Builds a command byte: command bit, transaction type and register address.
+ */
+constexpr uint8_t command(uint8_t reg_address, command_type type = command_type::repeat_byte) {
+    return static_cast<uint8_t>(0x80 | (static_cast<uint8_t>(type) << 5) | (reg_address & 0x1F));
+}
+
+static_assert(command(reg::enable) == 0x80, "command byte layout");
+static_assert(command(reg::cdatal, command_type::auto_increment) == 0xB4, "command byte layout");
+
+/**
+ * @brief I2C bus voltage of a variant.
+ */
+enum class io_voltage : uint8_t {
+    vdd,        ///< I2C bus at VDD.
+    v1_8,       ///< I2C bus at 1.8 V.
+};
+
+/** TCS34721: address 0x39, I2C bus at VDD. */
+struct tcs34721 {
+    static constexpr uint8_t address = 0x39;
+    static constexpr uint8_t id = 0x44;
+    static constexpr io_voltage bus_voltage = io_voltage::vdd;
+};
+
+/** TCS34723: address 0x39, I2C bus at 1.8 V. */
+struct tcs34723 {
+    static constexpr uint8_t address = 0x39;
+    static constexpr uint8_t id = 0x4D;
+    static constexpr io_voltage bus_voltage = io_voltage::v1_8;
+};
+
+/** TCS34725: address 0x29, I2C bus at VDD. */
+struct tcs34725 {
+    static constexpr uint8_t address = 0x29;
+    static constexpr uint8_t id = 0x44;
+    static constexpr io_voltage bus_voltage = io_voltage::vdd;
+};
+
+/** TCS34727: address 0x29, I2C bus at 1.8 V. */
+struct tcs34727 {
+    static constexpr uint8_t address = 0x29;
+    static constexpr uint8_t id = 0x4D;
+    static constexpr io_voltage bus_voltage = io_voltage::v1_8;
+};
+
+/**
+ * @brief Requirements on a sensor variant type.
+ */
+template <typename V>
+concept variant = requires {
+    { V::address } -> std::convertible_to<uint8_t>;
+    { V::id } -> std::convertible_to<uint8_t>;
+    { V::bus_voltage } -> std::convertible_to<io_voltage>;
+};
+
+/**
+ * @brief Requirements on a transport type.
+ */
+template <typename T>
+concept transport = requires(T &t, uint8_t address, const uint8_t *tx, uint8_t *rx, uint16_t length) {
+    { t.write(address, tx, length) } -> std::convertible_to<int8_t>;
+    { t.write_read(address, tx, length, rx, length) } -> std::convertible_to<int8_t>;
+};
+
+/**
+ * @brief Integration time of an ATIME value in microseconds: (256 − ATIME) × 2.4 ms.
+ */
+constexpr uint32_t atime_us(uint8_t atime) {
+    return (256u - atime) * 2400u;
+}
+
+/**
+ * @brief ATIME value of the shortest integration time of at least the given duration.
+ */
+constexpr uint8_t atime_for_us(uint32_t integration_time_us) {
+    uint32_t steps = (integration_time_us + 2399u) / 2400u;
+
+    return static_cast<uint8_t>(256u - (steps < 1u ? 1u : steps > 256u ? 256u : steps));
+}
+
+/**
+ * @brief Full-scale clear count of an ATIME value: min(65535, (256 − ATIME) × 1024).
+ */
+constexpr uint16_t full_scale(uint8_t atime) {
+    return (256u - atime) * 1024u > 65535u ? 65535u : static_cast<uint16_t>((256u - atime) * 1024u);
+}
+
+/**
+ * @brief Analog gain of each AGAIN value of the control register.
+ */
+constexpr std::array<uint8_t, 4> again_multiplier = { 1, 4, 16, 60 };
+
+static_assert(atime_us(0xF6) == 24000, "ATIME conversion");
+static_assert(atime_for_us(24000) == 0xF6, "ATIME conversion");
+static_assert(full_scale(0xC0) == 65535 && full_scale(0xFF) == 1024, "full scale");
+
+/**
+ * @brief Transport over the C HAL of tcs3472x_i2c_hal.h, which is bound to its address at init.
+ */
+struct c_hal_transport {
+    int8_t write(uint8_t, const uint8_t *tx, uint16_t tx_length) {
+        return tcs3472x_i2c_hal_write(const_cast<uint8_t *>(tx), tx_length);
+    }
+
+    int8_t write_read(uint8_t, const uint8_t *tx, uint16_t tx_length, uint8_t *rx, uint16_t rx_length) {
+        return tcs3472x_i2c_hal_write_read(tx, tx_length, rx, rx_length);
+    }
+};
+
+/**
+ * @brief A TCS3472x of a given variant on a given transport.
+ */
+template <variant Variant, transport Transport>
+class device {
+public:
+    static constexpr uint8_t address = Variant::address;   ///< 7-bit I2C address.
+    static constexpr uint8_t expected_id = Variant::id;    ///< ID register value of the variant.
+
+    explicit device(Transport &bus) : bus_(bus) {}
+
+    /**
+     * @brief Powers the sensor on with RGBC, wait and interrupt enabled, like tcs3472x_init().
+     *
+     * @return 0 on success, -1 on error.
+     */
+    int8_t init() {
+        return set_enable(enable::pon | enable::aen | enable::wen | enable::aien);
+    }
+
+    /**
+     * @brief Checks that the ID register matches the variant.
+     *
+     * @return 0 if it matches, -1 on mismatch or error.
+     */
+    int8_t probe() {
+        uint8_t id = 0;
+
+        if (read_register<reg::id>(id) < 0) {
+            return -1;
+        }
+        return id == expected_id ? 0 : -1;
+    }
+
+    /**
+     * @brief Writes one register.
+     *
+     * @return 0 on success, -1 on error.
+     */
+    template <uint8_t Reg>
+    int8_t write_register(uint8_t value) {
+        const uint8_t tx[2] = { command(Reg), value };
+
+        return bus_.write(address, tx, sizeof(tx)) < 0 ? -1 : 0;
+    }
+
+    /**
+     * @brief Reads one register.
+     *
+     * @return 0 on success, -1 on error.
+     */
+    template <uint8_t Reg>
+    int8_t read_register(uint8_t &value) {
+        static constexpr uint8_t tx[1] = { command(Reg) };
+
+        return bus_.write_read(address, tx, sizeof(tx), &value, 1) < 0 ? -1 : 0;
+    }
+
+    /**
+     * @brief Writes a prebuilt transaction: command byte followed by data bytes.
+     *
+     * @return 0 on success, -1 on error.
+     */
+    int8_t write_bytes(const uint8_t *tx, uint16_t tx_length) {
+        return bus_.write(address, tx, tx_length) < 0 ? -1 : 0;
+    }
+
+    /** Writes the enable register. */
+    int8_t set_enable(uint8_t value) { return write_register<reg::enable>(value); }
+
+    /** Writes the ATIME register. */
+    int8_t set_atime(uint8_t value) { return write_register<reg::atime>(value); }
+
+    /** Writes the WTIME register. */
+    int8_t set_wtime(uint8_t value) { return write_register<reg::wtime>(value); }
+
+    /** Reads the status register. */
+    int8_t get_status(uint8_t &value) { return read_register<reg::status>(value); }
+
+    /**
+     * @brief Reads clear, red, green and blue in one combined transaction.
+     *
+     * @return 0 on success, -1 on error.
+     */
+    int8_t read_colors(std::array<uint16_t, 4> &colors) {
+        static constexpr uint8_t tx[1] = { command(reg::cdatal, command_type::auto_increment) };
+        uint8_t rx[8];
+
+        if (bus_.write_read(address, tx, sizeof(tx), rx, sizeof(rx)) < 0) {
+            return -1;
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            colors[i] = static_cast<uint16_t>((rx[2 * i + 1] << 8) | rx[2 * i]);
+        }
+        return 0;
+    }
+
+private:
+    Transport &bus_;
+};
+
+} // namespace tcs3472x
+
+#endif // TCS3472X_DEVICE_HPP
@@ -0,0 +1,60 @@
+/**
+ * @file tcs3472x_format.h
+ * @brief Integer-only sample formatting as CSV, NDJSON or packed binary records.
+ *
+ * The formatters write one record into a caller-provided buffer and return its length. They use no
+ * stdio, locale or floating point, so they run in the microcontroller profile and are several times
+ * faster than printf on a host, which matters when logging hundreds of samples per second per sensor.
+ *
+ * CSV columns and NDJSON keys are timestamp_ns, device, clear, red, green and blue. A binary record is
+ * TCS3472X_FORMAT_BINARY_SIZE bytes, all little-endian: the timestamp as a signed 64-bit integer, the
+ * device as an unsigned 16-bit integer, then the four channels as unsigned 16-bit integers.
+ */
+
+#ifndef TCS3472X_FORMAT_H
+#define TCS3472X_FORMAT_H
+
+#include <stdint.h>
+
+#define TCS3472X_FORMAT_MAX_SIZE    128     ///< Longest record of any format, in bytes.
+#define TCS3472X_FORMAT_BINARY_SIZE 18      ///< Size of a binary record.
+#define TCS3472X_FORMAT_CSV_HEADER  "timestamp_ns,device,clear,red,green,blue\n"
+
+/**
+ * @brief Output formats.
+ */
+typedef enum {
+    TCS3472X_FORMAT_CSV,        ///< Comma-separated values, one line per sample.
+    TCS3472X_FORMAT_NDJSON,     ///< One JSON object per line.
+    TCS3472X_FORMAT_BINARY,     ///< Packed little-endian records.
+} tcs3472x_format_t;
+
+/**
+ * @brief One sample to format.
+ */
+typedef struct {
+    int64_t timestamp_ns;       ///< Sample time.
+    uint16_t device;            ///< Index of the sensor the sample came from.
+    uint16_t colors[4];         ///< Clear, red, green and blue data.
+} tcs3472x_format_sample_t;
+
+/**
+ * @brief Writes a signed integer in decimal.
+ *
+ * @param out Destination for at least 20 characters, not terminated.
+ * @param value Value to write.
+ * @return The number of characters written.
+ */
+uint8_t tcs3472x_format_i64(char *out, int64_t value);
+
+/**
+ * @brief Writes a sample in the given format.
+ *
+ * @param out Destination for at least TCS3472X_FORMAT_MAX_SIZE bytes, not terminated.
+ * @param format Format to write.
+ * @param sample Sample to write.
+ * @return The number of bytes written.
+ */
+uint16_t tcs3472x_format_sample(char *out, tcs3472x_format_t format, const tcs3472x_format_sample_t *sample);
+
+#endif // TCS3472X_FORMAT_H
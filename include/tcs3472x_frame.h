@@ -0,0 +1,111 @@
+/**
+ * @file tcs3472x_frame.h
+ * @brief Double-buffered frames of sensor array readings in planar (SoA) layout.
+ *
+ * A frame holds one plane per channel (clear, red, green, blue). Sensor i of a group is pixel i of
+ * each plane, in row-major order. Planes are 64-byte aligned and padded so whole frames can be handed
+ * to vectorized processing without gathering.
+ *
+ * One producer captures frames while one consumer processes the most recently completed frame. The
+ * producer never writes to the frame the consumer holds; if the consumer is still holding it when a
+ * new capture starts, the capture is skipped instead of blocking.
+ */
+
+#ifndef TCS3472X_FRAME_H
+#define TCS3472X_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "tcs3472x_group.h"
+
+#define TCS3472X_FRAME_CHANNELS 4   ///< Clear, red, green and blue.
+#define TCS3472X_FRAME_ALIGN    64  ///< Alignment of every plane in bytes.
+
+/** Number of uint16_t elements in one padded plane of width x height pixels. */
+#define TCS3472X_FRAME_PLANE_STRIDE(width, height) \
+    ((((size_t)(width) * (height) * sizeof(uint16_t) + TCS3472X_FRAME_ALIGN - 1) \
+      / TCS3472X_FRAME_ALIGN) * (TCS3472X_FRAME_ALIGN / sizeof(uint16_t)))
+
+/** Size in bytes of the storage needed for the two frames of a width x height buffer. */
+#define TCS3472X_FRAME_STORAGE_SIZE(width, height) \
+    (2 * TCS3472X_FRAME_CHANNELS * TCS3472X_FRAME_PLANE_STRIDE(width, height) * sizeof(uint16_t))
+
+/**
+ * @brief Channel planes of a frame.
+ */
+typedef enum {
+    TCS3472X_PLANE_CLEAR = 0,
+    TCS3472X_PLANE_RED = 1,
+    TCS3472X_PLANE_GREEN = 2,
+    TCS3472X_PLANE_BLUE = 3,
+} tcs3472x_plane_t;
+
+/**
+ * @brief One captured frame.
+ */
+typedef struct {
+    uint16_t *planes[TCS3472X_FRAME_CHANNELS]; ///< Aligned channel planes, width * height pixels each.
+    uint32_t sequence;                         ///< Capture counter, starting at 1.
+    int64_t timestamp_ns;                      ///< CLOCK_MONOTONIC time of the earliest sensor read.
+    int64_t max_read_skew_ns;                  ///< Spread of the sensor read times within the frame.
+} tcs3472x_frame_t;
+
+/**
+ * @brief Pair of frames shared between one producer and one consumer.
+ */
+typedef struct {
+    uint16_t width;                       ///< Pixels per row.
+    uint16_t height;                      ///< Number of rows.
+    size_t plane_stride;                  ///< Elements between two planes, including padding.
+    tcs3472x_frame_t frames[2];           ///< The two frames.
+    atomic_int published;                 ///< Index of the last completed frame, or -1.
+    atomic_int held;                      ///< Index of the frame held by the consumer, or -1.
+    uint32_t captured;                    ///< Number of completed captures.
+    uint32_t skipped;                     ///< Captures skipped because the consumer held the frame.
+} tcs3472x_frame_buffer_t;
+
+/**
+ * @brief Initializes a frame buffer on caller-provided storage.
+ *
+ * @param fb Frame buffer to initialize.
+ * @param width Pixels per row.
+ * @param height Number of rows.
+ * @param storage TCS3472X_FRAME_ALIGN aligned memory of at least TCS3472X_FRAME_STORAGE_SIZE(width, height) bytes.
+ * @param storage_size Size of storage in bytes.
+ * @return Returns 0 on success, or -1 if the storage is too small or misaligned.
+ */
+int8_t tcs3472x_frame_buffer_init(tcs3472x_frame_buffer_t *fb, uint16_t width, uint16_t height,
+                                  void *storage, size_t storage_size);
+
+/**
+ * @brief Reads a group into the back frame and publishes it.
+ *
+ * The group must contain exactly width * height sensors. Called by the producer only.
+ *
+ * @param fb Frame buffer to capture into.
+ * @param group Group to read.
+ * @return Returns 0 on success, 1 if the capture was skipped because the consumer still holds the
+ *         back frame, or -1 if the group read fails.
+ */
+int8_t tcs3472x_frame_buffer_capture(tcs3472x_frame_buffer_t *fb, tcs3472x_group_t *group);
+
+/**
+ * @brief Takes the most recently published frame for processing.
+ *
+ * The frame stays valid until tcs3472x_frame_buffer_release() is called. Called by the consumer only.
+ *
+ * @param fb Frame buffer to take the frame from.
+ * @return The frame, or NULL if nothing has been published yet.
+ */
+const tcs3472x_frame_t *tcs3472x_frame_buffer_acquire(tcs3472x_frame_buffer_t *fb);
+
+/**
+ * @brief Returns the frame taken with tcs3472x_frame_buffer_acquire() to the producer.
+ *
+ * @param fb Frame buffer the frame belongs to.
+ */
+void tcs3472x_frame_buffer_release(tcs3472x_frame_buffer_t *fb);
+
+#endif // TCS3472X_FRAME_H
@@ -0,0 +1,150 @@
+/**
+ * @file tcs3472x_group.h
+ * @brief Synchronized capture across several TCS3472x sensors on Linux i2c-dev buses.
+ *
+ * Each sensor integrates on its own free-running clock that starts when AEN is set. The group API
+ * restarts the RGBC cycle of every sensor with one I2C_RDWR transaction per bus, so all sensors of a
+ * group integrate in phase, and reads them back with one I2C_RDWR transaction per bus while recording
+ * how far apart in time the individual sensors were started and sampled.
+ *
+ * TCS34725/TCS34727 answer at 0x29 and TCS34721/TCS34723 at 0x39, so a bus carries at most two
+ * sensors unless a multiplexer is used. Larger arrays are spread over several buses.
+ */
+
+#ifndef TCS3472X_GROUP_H
+#define TCS3472X_GROUP_H
+
+#include <stdint.h>
+
+#include "tcs3472x_stats.h"
+
+#define TCS3472X_GROUP_MAX_SENSORS  64  ///< Maximum number of sensors in one group
+#define TCS3472X_GROUP_MAX_BUSES    32  ///< Maximum number of distinct buses in one group
+#define TCS3472X_GROUP_PATH_LEN     32  ///< Maximum length of a bus device path
+
+/**
+ * @brief One sensor of a group.
+ *
+ * The caller fills bus_path, address, enable, atime and wtime before calling tcs3472x_group_init(). The remaining
+ * fields are maintained by the group functions.
+ */
+typedef struct {
+    const char *bus_path;   ///< i2c-dev node of the bus, e.g. "/dev/i2c-1".
+    uint16_t address;       ///< 7-bit I2C address of the sensor.
+    uint8_t enable;         ///< ENABLE register value to run with (PON and AEN are always set).
+    uint8_t atime;          ///< ATIME register value written by tcs3472x_group_configure().
+    uint8_t wtime;          ///< WTIME register value written by tcs3472x_group_configure().
+    uint8_t bus_index;      ///< Index of the sensor's bus in the group.
+    uint16_t colors[4];     ///< Last read clear, red, green and blue data.
+    int64_t start_ns;       ///< CLOCK_MONOTONIC estimate of when AEN was last set.
+    int64_t read_ns;        ///< CLOCK_MONOTONIC estimate of when the data was last read.
+    int64_t start_skew_ns;  ///< Start time relative to the earliest started sensor of the group.
+    int64_t read_skew_ns;   ///< Read time relative to the earliest read sensor of the group.
+    tcs3472x_stats_t stats; ///< Counters of this sensor; each group ioctl counts as one transaction.
+} tcs3472x_group_sensor_t;
+
+/**
+ * @brief An open i2c-dev bus shared by one or more sensors of a group.
+ */
+typedef struct {
+    char path[TCS3472X_GROUP_PATH_LEN]; ///< i2c-dev node of the bus.
+    int fd;                             ///< File descriptor of the opened bus.
+} tcs3472x_group_bus_t;
+
+/**
+ * @brief A set of sensors started and read together.
+ */
+typedef struct {
+    tcs3472x_group_sensor_t *sensors;                   ///< Caller-provided sensor array.
+    uint8_t sensor_count;                               ///< Number of entries in sensors.
+    tcs3472x_group_bus_t buses[TCS3472X_GROUP_MAX_BUSES]; ///< Distinct buses used by the sensors.
+    uint8_t bus_count;                                  ///< Number of entries in buses.
+    int64_t max_start_skew_ns;                          ///< Largest start skew of the last start.
+    int64_t max_read_skew_ns;                           ///< Largest read skew of the last read.
+} tcs3472x_group_t;
+
+/**
+ * @brief Opens every distinct bus used by the sensors of a group.
+ *
+ * @param group Group to initialize.
+ * @param sensors Caller-provided sensor array, which must stay valid for the lifetime of the group.
+ * @param count Number of sensors (at most TCS3472X_GROUP_MAX_SENSORS).
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_init(tcs3472x_group_t *group, tcs3472x_group_sensor_t *sensors, uint8_t count);
+
+/**
+ * @brief Writes the ATIME and WTIME values cached in each sensor of a group.
+ *
+ * Per bus, a single I2C_RDWR transaction writes both registers of every sensor. The cached values
+ * are what tcs3472x_group_cycle_ns() and the scheduler use to predict when data becomes valid.
+ *
+ * @param group Group to configure.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_configure(tcs3472x_group_t *group);
+
+/**
+ * @brief Restarts the RGBC integration cycle of all sensors of a group.
+ *
+ * Per bus, a single I2C_RDWR transaction first clears AEN on every sensor and then sets it again,
+ * so sensors sharing a bus restart within a few byte times of each other. Buses are serviced one
+ * after the other; the resulting per-sensor offsets are stored in start_skew_ns.
+ *
+ * @param group Group to start.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_start(tcs3472x_group_t *group);
+
+/**
+ * @brief Reads the clear, red, green and blue data of all sensors of a group.
+ *
+ * Per bus, a single I2C_RDWR transaction reads the data registers of every sensor. The read time of
+ * each sensor is interpolated within its bus transaction and the per-sensor offsets are stored in
+ * read_skew_ns.
+ *
+ * @param group Group to read.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_read(tcs3472x_group_t *group);
+
+/**
+ * @brief Reads the clear, red, green and blue data of a single sensor of a group.
+ *
+ * Updates colors and read_ns of that sensor only; the skew fields are left untouched.
+ *
+ * @param group Group the sensor belongs to.
+ * @param index Index of the sensor in the group.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_read_sensor(tcs3472x_group_t *group, uint8_t index);
+
+/**
+ * @brief Returns the integration time of a sensor from its cached ATIME value.
+ *
+ * Uses tcs3472x_atime_to_us(), so the group agrees with the driver, including for ATIME = 0.
+ *
+ * @param sensor Sensor to compute the time for.
+ * @return The RGBC integration time in nanoseconds.
+ */
+int64_t tcs3472x_group_atime_ns(const tcs3472x_group_sensor_t *sensor);
+
+/**
+ * @brief Returns the full RGBC cycle time of a sensor from its cached ATIME, WTIME and enable values.
+ *
+ * A cycle is the integration time plus, when WEN is set, the wait time.
+ *
+ * @param sensor Sensor to compute the time for.
+ * @return The time between two consecutive AVALID events in nanoseconds.
+ */
+int64_t tcs3472x_group_cycle_ns(const tcs3472x_group_sensor_t *sensor);
+
+/**
+ * @brief Closes every bus opened by tcs3472x_group_init().
+ *
+ * @param group Group to close.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_group_close(tcs3472x_group_t *group);
+
+#endif // TCS3472X_GROUP_H
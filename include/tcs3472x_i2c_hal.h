@@ -46,6 +46,21 @@ int8_t tcs3472x_i2c_hal_write(uint8_t *buffer, uint16_t length);
  */
 int8_t tcs3472x_i2c_hal_read(uint8_t *buffer, uint16_t length);
 
+/**
+ * @brief Writes data to and then reads data from the TCS3472x sensor in one bus transaction.
+ *
+ * The read follows the write after a repeated START, without a STOP in between, which saves the STOP,
+ * the bus free time and on hosted platforms a second system call compared to a write followed by a
+ * read. A platform without repeated START support may implement it as exactly that pair.
+ *
+ * @param tx Bytes to write, usually a command byte.
+ * @param tx_length Number of bytes to write.
+ * @param rx Buffer where the read data will be stored.
+ * @param rx_length Number of bytes to read.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_i2c_hal_write_read(const uint8_t *tx, uint16_t tx_length, uint8_t *rx, uint16_t rx_length);
+
 /**
  * @brief Closes the I2C communication interface with the TCS3472x sensor.
  *
@@ -0,0 +1,51 @@
+/**
+ * @file tcs3472x_i2c_hal_async.h
+ * @brief Non-blocking I2C HAL contract for interrupt or DMA driven transports.
+ *
+ * A platform implementing this contract starts a transfer and returns immediately. When the bytes
+ * have moved, it calls the completion callback exactly once, typically from the I2C or DMA interrupt.
+ * The buffer passed to a start function must stay valid until the callback has run. At most one
+ * transfer is in flight at a time; starting another one before the callback returns -1.
+ *
+ * The callback may also run before the start function returns, for instance when a transport
+ * completes short transfers synchronously, so callers must have their state ready before starting.
+ */
+
+#ifndef TCS3472X_I2C_HAL_ASYNC_H
+#define TCS3472X_I2C_HAL_ASYNC_H
+
+#include <stdint.h>
+
+/**
+ * @brief Called once when a transfer has finished.
+ *
+ * @param context Pointer passed to the start function.
+ * @param result 0 if the transfer succeeded, negative otherwise.
+ */
+typedef void (*tcs3472x_i2c_hal_async_cb_t)(void *context, int8_t result);
+
+/**
+ * @brief Starts writing data to the TCS3472x sensor.
+ *
+ * @param buffer Bytes to write, valid until the callback has run.
+ * @param length Number of bytes to write.
+ * @param callback Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the transfer was started, or -1 if the bus is busy or an error occurs.
+ */
+int8_t tcs3472x_i2c_hal_async_write(const uint8_t *buffer, uint16_t length,
+                                    tcs3472x_i2c_hal_async_cb_t callback, void *context);
+
+/**
+ * @brief Starts reading data from the TCS3472x sensor.
+ *
+ * @param buffer Destination of the bytes, valid until the callback has run.
+ * @param length Number of bytes to read.
+ * @param callback Completion callback.
+ * @param context Pointer handed to the callback.
+ * @return Returns 0 if the transfer was started, or -1 if the bus is busy or an error occurs.
+ */
+int8_t tcs3472x_i2c_hal_async_read(uint8_t *buffer, uint16_t length,
+                                   tcs3472x_i2c_hal_async_cb_t callback, void *context);
+
+#endif // TCS3472X_I2C_HAL_ASYNC_H
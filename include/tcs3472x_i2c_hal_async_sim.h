@@ -0,0 +1,41 @@
+/**
+ * @file tcs3472x_i2c_hal_async_sim.h
+ * @brief Simulated asynchronous I2C HAL with randomized completion latency.
+ *
+ * The simulated asynchronous HAL implements tcs3472x_i2c_hal_async.h on top of the register file of
+ * the simulated HAL (tcs3472x_i2c_hal_sim.h). A started transfer completes after a random number of
+ * ticks; every call to tcs3472x_i2c_hal_async_sim_tick() plays the role of a timer interrupt and runs
+ * the completion callback of a transfer that is due. A latency of zero ticks completes the transfer
+ * before the start function returns, which exercises callers against synchronous completion.
+ * Failures injected with tcs3472x_i2c_hal_sim_fail_next() are reported through the callback.
+ */
+
+#ifndef TCS3472X_I2C_HAL_ASYNC_SIM_H
+#define TCS3472X_I2C_HAL_ASYNC_SIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Sets the latency range and seeds the latency generator.
+ *
+ * @param seed Seed of the pseudo-random latency sequence (0 is replaced by 1).
+ * @param min_ticks Shortest completion latency in ticks.
+ * @param max_ticks Longest completion latency in ticks.
+ */
+void tcs3472x_i2c_hal_async_sim_init(uint32_t seed, uint32_t min_ticks, uint32_t max_ticks);
+
+/**
+ * @brief Advances simulated time by one tick and completes the transfer in flight if it is due.
+ *
+ * @return 1 if a transfer completed during this tick, 0 otherwise.
+ */
+uint8_t tcs3472x_i2c_hal_async_sim_tick(void);
+
+/**
+ * @brief Returns whether a transfer is in flight.
+ *
+ * @return 1 if a transfer is in flight, 0 otherwise.
+ */
+uint8_t tcs3472x_i2c_hal_async_sim_busy(void);
+
+#endif // TCS3472X_I2C_HAL_ASYNC_SIM_H
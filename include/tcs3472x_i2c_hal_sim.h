@@ -0,0 +1,90 @@
+/**
+ * @file tcs3472x_i2c_hal_sim.h
+ * @brief Simulated TCS3472x behind the I2C HAL, for running the driver without hardware.
+ *
+ * The simulated HAL implements the functions of tcs3472x_i2c_hal.h on top of an in-memory register
+ * file. A write whose first byte has the command bit set selects the register pointer and protocol;
+ * further bytes are stored from that pointer on. Reads return bytes from the pointer on, advancing it
+ * for auto-increment transactions. Every call counts as one bus transaction, and the counters let
+ * tools compare the driver's real traffic against the bus cost model.
+ */
+
+#ifndef TCS3472X_I2C_HAL_SIM_H
+#define TCS3472X_I2C_HAL_SIM_H
+
+#include <stdint.h>
+
+#define TCS3472X_SIM_DEFAULT_ID 0x44    ///< ID register value of a TCS34721/TCS34725.
+
+/**
+ * @brief Bus traffic seen by the simulated HAL.
+ */
+typedef struct {
+    uint32_t transactions;  ///< Completed write, read and write/read calls.
+    uint32_t bytes_written; ///< Bytes written, including command bytes.
+    uint32_t bytes_read;    ///< Bytes read.
+    uint32_t errors;        ///< Calls that failed, including injected failures.
+} tcs3472x_i2c_hal_sim_stats_t;
+
+/**
+ * @brief Sets the values returned by the data registers.
+ *
+ * @param clear Clear channel count.
+ * @param red Red channel count.
+ * @param green Green channel count.
+ * @param blue Blue channel count.
+ */
+void tcs3472x_i2c_hal_sim_set_colors(uint16_t clear, uint16_t red, uint16_t green, uint16_t blue);
+
+/**
+ * @brief Returns a simulated register value.
+ *
+ * @param reg_address Register address (0x00 to 0x1F).
+ * @return The register value.
+ */
+uint8_t tcs3472x_i2c_hal_sim_get_register(uint8_t reg_address);
+
+/**
+ * @brief Overwrites a simulated register, for example to emulate a different device ID.
+ *
+ * @param reg_address Register address (0x00 to 0x1F).
+ * @param value New register value.
+ */
+void tcs3472x_i2c_hal_sim_set_register(uint8_t reg_address, uint8_t value);
+
+/**
+ * @brief Emulates a power loss: every register returns to its power-on value and the data
+ *        registers read zero.
+ */
+void tcs3472x_i2c_hal_sim_power_cycle(void);
+
+/**
+ * @brief Unplugs or plugs in the simulated sensor.
+ *
+ * While the sensor is absent every write and read fails as if the address was not acknowledged.
+ * Plugging it back in emulates a fresh power-up, see tcs3472x_i2c_hal_sim_power_cycle().
+ *
+ * @param present 0 to unplug the sensor, non-zero to plug it in.
+ */
+void tcs3472x_i2c_hal_sim_set_present(uint8_t present);
+
+/**
+ * @brief Makes the next write or read calls fail.
+ *
+ * @param count Number of calls that fail before the bus works again.
+ */
+void tcs3472x_i2c_hal_sim_fail_next(uint32_t count);
+
+/**
+ * @brief Returns the traffic counted since the last reset.
+ *
+ * @param stats Destination for the counters.
+ */
+void tcs3472x_i2c_hal_sim_get_stats(tcs3472x_i2c_hal_sim_stats_t *stats);
+
+/**
+ * @brief Clears the traffic counters.
+ */
+void tcs3472x_i2c_hal_sim_reset_stats(void);
+
+#endif // TCS3472X_I2C_HAL_SIM_H
@@ -0,0 +1,108 @@
+/**
+ * @file tcs3472x_iio.h
+ * @brief Linux IIO backend reading the kernel tcs3472 driver's triggered buffer.
+ *
+ * Instead of talking to the sensor over i2c-dev, this backend lets the mainline tcs3472 IIO driver
+ * sample it. Opening the backend:
+ *
+ * - finds the iio:deviceN directory under <sysfs_root>/bus/iio/devices whose name is tcs3472,
+ * - enables the clear, red, green and blue scan elements, and the timestamp if requested, and reads
+ *   their index and type to work out the packed scan layout,
+ * - attaches a trigger by name, typically an hrtimer trigger, setting its sampling frequency and
+ *   creating it through <sysfs_root>/kernel/config if it does not exist yet,
+ * - sets the kernel buffer length and watermark, enables the buffer and opens <dev_root>/iio:deviceN.
+ *
+ * Each tcs3472x_iio_read() then fetches up to TCS3472X_IIO_BLOCK_SIZE bytes of packed scans in one
+ * read() and unpacks them into the clear, red, green, blue order of tcs3472x_get_all_colors_data().
+ * A scan split across two reads is kept until its remainder arrives. Pointing the roots at a
+ * directory tree and a FIFO lets the backend run without the kernel driver.
+ */
+
+#ifndef TCS3472X_IIO_H
+#define TCS3472X_IIO_H
+
+#include <stdint.h>
+
+#define TCS3472X_IIO_PATH_SIZE      256     ///< Longest sysfs or device path.
+#define TCS3472X_IIO_BLOCK_SIZE     4096    ///< Bytes fetched per read() of the chardev.
+#define TCS3472X_IIO_CHANNELS       5       ///< Clear, red, green, blue and timestamp.
+
+/**
+ * @brief Backend settings.
+ */
+typedef struct {
+    const char *sysfs_root;     ///< Root of sysfs, usually "/sys".
+    const char *dev_root;       ///< Directory holding the chardev, usually "/dev".
+    const char *trigger;        ///< Trigger name to attach, or NULL to keep the current trigger.
+    uint32_t sampling_hz;       ///< Sampling frequency written to the trigger, 0 to leave it.
+    uint32_t buffer_length;     ///< Kernel buffer length in scans.
+    uint32_t watermark;         ///< Scans the kernel collects before waking a reader, 0 to leave it.
+    uint8_t timestamp;          ///< Non-zero to enable the timestamp channel.
+} tcs3472x_iio_config_t;
+
+/**
+ * @brief Position and format of one channel within a scan.
+ */
+typedef struct {
+    uint8_t offset;             ///< Byte offset within the scan.
+    uint8_t bytes;              ///< Storage size in bytes.
+    uint8_t bits;               ///< Significant bits.
+    uint8_t shift;              ///< Right shift applied before masking.
+    uint8_t big_endian;         ///< Non-zero for big-endian storage.
+    uint8_t is_signed;          ///< Non-zero for signed values.
+} tcs3472x_iio_channel_t;
+
+/**
+ * @brief Open IIO backend.
+ */
+typedef struct {
+    char device_dir[TCS3472X_IIO_PATH_SIZE];    ///< sysfs directory of the device.
+    int fd;                                     ///< Open chardev.
+    uint8_t timestamp;                          ///< Non-zero if scans carry a timestamp.
+    uint8_t scan_size;                          ///< Bytes per packed scan.
+    tcs3472x_iio_channel_t channels[TCS3472X_IIO_CHANNELS]; ///< Clear, red, green, blue, timestamp.
+    uint8_t block[TCS3472X_IIO_BLOCK_SIZE];     ///< Bytes read from the chardev.
+    uint16_t pending;                           ///< Bytes of an incomplete scan at the start of block.
+    uint64_t reads;                             ///< read() calls that returned data.
+    uint64_t scans;                             ///< Scans unpacked.
+} tcs3472x_iio_t;
+
+/**
+ * @brief Fills settings for an hrtimer trigger named tcs3472x at 100 Hz, a 1024 scan buffer woken
+ *        every 128 scans and timestamps, under /sys and /dev.
+ *
+ * @param config Settings to fill.
+ */
+void tcs3472x_iio_config_default(tcs3472x_iio_config_t *config);
+
+/**
+ * @brief Finds the sensor, configures its buffer and trigger and opens its chardev.
+ *
+ * @param iio Backend to open.
+ * @param config Settings.
+ * @return Returns 0 on success, or -1 if the device, a scan element or the trigger cannot be found
+ *         or configured, or the chardev cannot be opened.
+ */
+int8_t tcs3472x_iio_open(tcs3472x_iio_t *iio, const tcs3472x_iio_config_t *config);
+
+/**
+ * @brief Reads a block of scans.
+ *
+ * Blocks until at least one complete scan is available.
+ *
+ * @param iio Open backend.
+ * @param colors Destination for clear, red, green and blue data, one entry per scan.
+ * @param timestamps_ns Destination for scan timestamps, or NULL. Zero without the timestamp channel.
+ * @param count Capacity of colors and timestamps_ns in scans.
+ * @return The number of scans read, 0 at end of file, or -1 on error.
+ */
+int32_t tcs3472x_iio_read(tcs3472x_iio_t *iio, uint16_t (*colors)[4], int64_t *timestamps_ns, uint32_t count);
+
+/**
+ * @brief Disables the kernel buffer and closes the chardev.
+ *
+ * @param iio Backend to close.
+ */
+void tcs3472x_iio_close(tcs3472x_iio_t *iio);
+
+#endif // TCS3472X_IIO_H
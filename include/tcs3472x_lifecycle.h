@@ -0,0 +1,102 @@
+/**
+ * @file tcs3472x_lifecycle.h
+ * @brief Hot-plug tolerant device lifecycle on top of the core driver.
+ *
+ * The lifecycle is a state machine polled from the application's sampling loop:
+ *
+ * - absent: nothing answers. The next probe is scheduled with exponential backoff between
+ *   min_backoff_ns and max_backoff_ns, so an unplugged sensor costs one failed read per backoff.
+ * - probing: the ID register is read and compared with expected_id.
+ * - configuring: the desired configuration is written with tcs3472x_apply_config(), ENABLE last.
+ * - running: every poll reads one sample and feeds it to a watchdog. error_limit failed reads in a
+ *   row mean the sensor is gone; a watchdog fault means it is answering but lost its configuration,
+ *   for example after a quick reseat or a brownout.
+ * - faulted: entered on a watchdog fault, probes again on the next poll.
+ *
+ * Configuration changes the application makes with the core setters while running are kept: the
+ * configuration cache is copied into the desired configuration whenever the lifecycle leaves the
+ * running state. All times are in nanoseconds of a monotonic clock supplied by the caller.
+ */
+
+#ifndef TCS3472X_LIFECYCLE_H
+#define TCS3472X_LIFECYCLE_H
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_watchdog.h"
+
+/**
+ * @brief Lifecycle states.
+ */
+typedef enum {
+    TCS3472X_LIFECYCLE_ABSENT,      ///< No sensor answered, waiting for the next probe.
+    TCS3472X_LIFECYCLE_PROBING,     ///< Checking the ID register.
+    TCS3472X_LIFECYCLE_CONFIGURING, ///< Writing the desired configuration.
+    TCS3472X_LIFECYCLE_RUNNING,     ///< Sampling.
+    TCS3472X_LIFECYCLE_FAULTED,     ///< The watchdog reported a fault.
+    TCS3472X_LIFECYCLE_STATE_COUNT,
+} tcs3472x_lifecycle_state_t;
+
+/**
+ * @brief Lifecycle limits.
+ */
+typedef struct {
+    uint8_t expected_id;                    ///< ID register value of the sensor.
+    int64_t min_backoff_ns;                 ///< Delay before the first probe after a disappearance.
+    int64_t max_backoff_ns;                 ///< Longest delay between probes.
+    uint16_t error_limit;                   ///< Failed reads in a row that mean the sensor is gone.
+    tcs3472x_watchdog_config_t watchdog;    ///< Watchdog limits; auto_recover is ignored.
+} tcs3472x_lifecycle_config_t;
+
+/**
+ * @brief Lifecycle state.
+ */
+typedef struct {
+    tcs3472x_lifecycle_config_t config;     ///< Limits the lifecycle was initialized with.
+    tcs3472x_config_cache_t desired;        ///< Configuration written on every (re)configuration.
+    tcs3472x_lifecycle_state_t state;       ///< Current state.
+    int64_t next_probe_ns;                  ///< Time of the next probe while absent.
+    int64_t backoff_ns;                     ///< Delay before the probe after the next failure.
+    uint16_t errors;                        ///< Failed reads in a row while running.
+    tcs3472x_watchdog_t watchdog;           ///< Watchdog on the running sample stream.
+    uint32_t probes;                        ///< ID register probes.
+    uint32_t configurations;                ///< Successful configurations.
+    uint32_t entries[TCS3472X_LIFECYCLE_STATE_COUNT]; ///< Times each state was entered.
+} tcs3472x_lifecycle_t;
+
+/**
+ * @brief Fills limits for a TCS34725 read about once per integration cycle.
+ *
+ * @param config Limits to fill: ID 0x44, probes backing off from 10 ms to 2 s, 3 failed reads and the
+ *               default watchdog limits with register checks every 10 samples.
+ */
+void tcs3472x_lifecycle_config_default(tcs3472x_lifecycle_config_t *config);
+
+/**
+ * @brief Initializes a lifecycle in the probing state.
+ *
+ * The sensor does not have to be present; the first poll probes it.
+ *
+ * @param lifecycle Lifecycle to initialize.
+ * @param config Limits, copied into the lifecycle.
+ * @param desired Configuration to write once the sensor answers, copied into the lifecycle.
+ * @param now_ns Current time.
+ */
+void tcs3472x_lifecycle_init(tcs3472x_lifecycle_t *lifecycle, const tcs3472x_lifecycle_config_t *config,
+                             const tcs3472x_config_cache_t *desired, int64_t now_ns);
+
+/**
+ * @brief Advances the lifecycle and reads one sample while running.
+ *
+ * A poll that finds the sensor again probes, configures and enters the running state at once; the
+ * first sample is read on the next poll, after the caller waited for an integration.
+ *
+ * @param lifecycle Lifecycle to advance.
+ * @param now_ns Current time.
+ * @param colors Destination for clear, red, green and blue data.
+ * @return Returns 1 if colors holds a valid sample, or 0 otherwise.
+ */
+int8_t tcs3472x_lifecycle_poll(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns, uint16_t colors[4]);
+
+#endif // TCS3472X_LIFECYCLE_H
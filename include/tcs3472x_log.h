@@ -0,0 +1,92 @@
+/**
+ * @file tcs3472x_log.h
+ * @brief Deferred, lock-free logging for the TCS3472x driver.
+ *
+ * When TCS3472X_LOG_DEFERRED is defined, LOG_DEBUG and LOG_ERROR do not format or print anything at
+ * the call site. They store the format string pointer and up to four raw integer or pointer arguments
+ * in a fixed-size ring, which takes a few atomic operations and never blocks. The messages are
+ * formatted later by tcs3472x_log_drain(), called on demand or from a background thread, and handed
+ * to a sink function (stderr by default). If the ring is full, events are counted as dropped instead
+ * of waiting.
+ *
+ * LOG_DEBUG is compiled out in this mode unless TCS3472X_LOG_DEFERRED_DEBUG is also defined: the
+ * driver logs a debug event on every register access, which would fill the ring and drop the errors
+ * it is meant to keep.
+ *
+ * Because formatting is deferred, every %s argument must still be valid when the ring is drained;
+ * pass string literals or long-lived buffers only. Supported conversions are d, i, u, x, X, c, s and
+ * p, optionally with flags, width and an l length modifier.
+ */
+
+#ifndef TCS3472X_LOG_H
+#define TCS3472X_LOG_H
+
+#include <stdint.h>
+
+#define TCS3472X_LOG_RING_SIZE  64  ///< Number of events the ring holds, must be a power of two.
+#define TCS3472X_LOG_MAX_ARGS   4   ///< Maximum number of arguments per event.
+#define TCS3472X_LOG_LINE_SIZE  160 ///< Longest formatted message handed to the sink.
+
+/**
+ * @brief Event severity.
+ */
+typedef enum {
+    TCS3472X_LOG_LEVEL_DEBUG,
+    TCS3472X_LOG_LEVEL_ERROR,
+} tcs3472x_log_level_t;
+
+/**
+ * @brief Receives formatted messages from tcs3472x_log_drain().
+ */
+typedef void (*tcs3472x_log_sink_t)(tcs3472x_log_level_t level, const char *line);
+
+// Argument counting and casting for the logging macros (up to TCS3472X_LOG_MAX_ARGS arguments)
+#define TCS3472X_LOG_NARGS(...) TCS3472X_LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define TCS3472X_LOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+#define TCS3472X_LOG_CAST(n, ...) TCS3472X_LOG_CAST_(n, __VA_ARGS__)
+#define TCS3472X_LOG_CAST_(n, ...) TCS3472X_LOG_CAST_##n(__VA_ARGS__)
+#define TCS3472X_LOG_CAST_0()
+#define TCS3472X_LOG_CAST_1(a) , (intptr_t)(a)
+#define TCS3472X_LOG_CAST_2(a, b) , (intptr_t)(a), (intptr_t)(b)
+#define TCS3472X_LOG_CAST_3(a, b, c) , (intptr_t)(a), (intptr_t)(b), (intptr_t)(c)
+#define TCS3472X_LOG_CAST_4(a, b, c, d) , (intptr_t)(a), (intptr_t)(b), (intptr_t)(c), (intptr_t)(d)
+
+/** Records an event; used by LOG_DEBUG and LOG_ERROR. */
+#define TCS3472X_LOG_EVENT(level, format, ...) \
+    tcs3472x_log_event(level, format, TCS3472X_LOG_NARGS(__VA_ARGS__) \
+                       TCS3472X_LOG_CAST(TCS3472X_LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__))
+
+/**
+ * @brief Stores an event in the ring without formatting it.
+ *
+ * Safe to call from any thread concurrently. Use the LOG_DEBUG and LOG_ERROR macros rather than
+ * calling this directly; they cast every argument to intptr_t as this function expects.
+ *
+ * @param level Event severity.
+ * @param format printf-style format string, which must be a string literal.
+ * @param nargs Number of intptr_t arguments that follow (at most TCS3472X_LOG_MAX_ARGS).
+ */
+void tcs3472x_log_event(tcs3472x_log_level_t level, const char *format, uint8_t nargs, ...);
+
+/**
+ * @brief Formats all stored events and passes them to the sink.
+ *
+ * @return The number of events formatted.
+ */
+uint32_t tcs3472x_log_drain(void);
+
+/**
+ * @brief Replaces the function formatted messages are passed to.
+ *
+ * @param sink New sink, or NULL to restore the default stderr sink.
+ */
+void tcs3472x_log_set_sink(tcs3472x_log_sink_t sink);
+
+/**
+ * @brief Returns the number of events dropped because the ring was full.
+ *
+ * @return Dropped events since start.
+ */
+uint32_t tcs3472x_log_dropped(void);
+
+#endif // TCS3472X_LOG_H
@@ -0,0 +1,28 @@
+/**
+ * @file tcs3472x_log_thread.h
+ * @brief Background thread draining the deferred log ring on Linux.
+ *
+ * The thread wakes up periodically and calls tcs3472x_log_drain(), so threads that record events
+ * never wait on stderr themselves. It runs under the default scheduling policy and should not share
+ * a CPU with a real-time acquisition thread.
+ */
+
+#ifndef TCS3472X_LOG_THREAD_H
+#define TCS3472X_LOG_THREAD_H
+
+#include <stdint.h>
+
+/**
+ * @brief Starts the drain thread.
+ *
+ * @param interval_ms Time between two drains in milliseconds.
+ * @return Returns 0 on success, or -1 if the thread could not be created.
+ */
+int8_t tcs3472x_log_thread_start(uint32_t interval_ms);
+
+/**
+ * @brief Stops the drain thread after a final drain.
+ */
+void tcs3472x_log_thread_stop(void);
+
+#endif // TCS3472X_LOG_THREAD_H
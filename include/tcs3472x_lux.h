@@ -0,0 +1,51 @@
+/**
+ * @file tcs3472x_lux.h
+ * @brief Illuminance from TCS3472x color data.
+ *
+ * Implements the lux calculation of the TCS3472x application note DN40. The IR content is estimated
+ * as IR = (R + G + B − C) / 2 and removed from each channel, the IR-free channels are weighted into
+ * G″ = R_coef × R′ + G_coef × G′ + B_coef × B′, and G″ is divided by the counts per lux
+ * CPL = (integration time in ms × gain) / (GA × DF). GA is the attenuation of the glass in front of
+ * the sensor (1 in open air) and DF the device factor.
+ *
+ * All arithmetic is integer; coefficients and GA are in thousandths.
+ */
+
+#ifndef TCS3472X_LUX_H
+#define TCS3472X_LUX_H
+
+#include <stdint.h>
+
+#define TCS3472X_LUX_SATURATED  UINT32_MAX  ///< Returned when the clear channel is at full scale.
+
+/**
+ * @brief Coefficients of the lux calculation.
+ */
+typedef struct {
+    int32_t r_coef;     ///< Red coefficient in thousandths.
+    int32_t g_coef;     ///< Green coefficient in thousandths.
+    int32_t b_coef;     ///< Blue coefficient in thousandths.
+    uint32_t ga;        ///< Glass attenuation in thousandths (1000 = open air).
+    uint32_t df;        ///< Device factor.
+} tcs3472x_lux_params_t;
+
+/**
+ * @brief Fills the coefficients with the DN40 open-air values for the TCS3472x.
+ *
+ * @param params Coefficients to fill.
+ */
+void tcs3472x_lux_params_default(tcs3472x_lux_params_t *params);
+
+/**
+ * @brief Computes the illuminance of one sample.
+ *
+ * @param params Coefficients.
+ * @param colors Clear, red, green and blue data.
+ * @param atime ATIME register value the sample was taken with.
+ * @param again AGAIN value of the control register the sample was taken with.
+ * @return Illuminance in millilux, or TCS3472X_LUX_SATURATED if the clear channel is at full scale.
+ */
+uint32_t tcs3472x_lux_mlux(const tcs3472x_lux_params_t *params, const uint16_t colors[4], uint8_t atime,
+                           uint8_t again);
+
+#endif // TCS3472X_LUX_H
@@ -0,0 +1,99 @@
+/**
+ * @file tcs3472x_metrics.h
+ * @brief Prometheus text-format exporter for TCS3472x device counters on Linux.
+ *
+ * tcs3472x_metrics_render() turns the counters of one or more devices into the Prometheus text
+ * exposition format in a caller-provided buffer, without allocating memory. The text can be written
+ * atomically to a *.prom file for node-exporter's textfile collector with tcs3472x_metrics_write_file(),
+ * or served over HTTP on the loopback interface by a metrics server thread.
+ *
+ * Exported metrics, each labelled with device="<name>":
+ * - tcs3472x_samples_total, tcs3472x_saturations_total, tcs3472x_transactions_total,
+ *   tcs3472x_errors_total and tcs3472x_retries_total (counters)
+ * - tcs3472x_transaction_latency_seconds (histogram)
+ */
+
+#ifndef TCS3472X_METRICS_H
+#define TCS3472X_METRICS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "tcs3472x_stats.h"
+
+#define TCS3472X_METRICS_BUFFER_SIZE    16384   ///< Render buffer of the metrics server.
+
+/**
+ * @brief A device to export.
+ */
+typedef struct {
+    const char *name;               ///< Value of the device label; must not contain quotes, backslashes or newlines.
+    const tcs3472x_stats_t *stats;  ///< Counters of the device.
+} tcs3472x_metrics_device_t;
+
+/**
+ * @brief State of a metrics server. All fields are maintained by the server functions.
+ */
+typedef struct {
+    int listen_fd;                                  ///< Listening TCP socket.
+    pthread_t thread;                               ///< Thread answering scrapes.
+    atomic_int running;                             ///< Cleared to stop the thread.
+    const tcs3472x_metrics_device_t *devices;       ///< Devices to export.
+    uint8_t count;                                  ///< Number of entries in devices.
+    char buffer[TCS3472X_METRICS_BUFFER_SIZE];      ///< Render buffer, only used by the server thread.
+} tcs3472x_metrics_server_t;
+
+/**
+ * @brief Renders the counters of a set of devices in Prometheus text format.
+ *
+ * Does not allocate and may be called from any thread. The counters are read without locking while
+ * their writers keep updating them, so as described in tcs3472x_stats.h different counters may be
+ * momentarily out of step, including a histogram's sum with its buckets. The histogram count is the
+ * sum of the rendered buckets, so those two always agree.
+ *
+ * @param buffer Destination buffer; the text is NUL-terminated.
+ * @param size Size of the destination buffer.
+ * @param devices Devices to export.
+ * @param count Number of devices.
+ * @return Returns the length of the text, or -1 if it does not fit in the buffer.
+ */
+int32_t tcs3472x_metrics_render(char *buffer, uint32_t size, const tcs3472x_metrics_device_t *devices,
+                                uint8_t count);
+
+/**
+ * @brief Atomically replaces a file with rendered metrics.
+ *
+ * The text is written to "<path>.tmp" and renamed over path, so a collector reading the file never
+ * sees a partial write. The temporary file must be on the same filesystem as path.
+ *
+ * @param path Destination file, e.g. "/var/lib/node_exporter/textfile_collector/tcs3472x.prom".
+ * @param text Text returned by tcs3472x_metrics_render().
+ * @param length Length of the text.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_metrics_write_file(const char *path, const char *text, uint32_t length);
+
+/**
+ * @brief Starts a thread serving the metrics over HTTP on 127.0.0.1.
+ *
+ * Every connection is answered with freshly rendered metrics, whatever the request path. Rendering
+ * happens on the server thread into the server's own buffer, never on the acquisition thread.
+ *
+ * @param server Server state.
+ * @param port TCP port to listen on.
+ * @param devices Devices to export, which must stay valid until the server is stopped.
+ * @param count Number of devices.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_metrics_server_start(tcs3472x_metrics_server_t *server, uint16_t port,
+                                     const tcs3472x_metrics_device_t *devices, uint8_t count);
+
+/**
+ * @brief Stops a metrics server and closes its socket.
+ *
+ * @param server Server state.
+ */
+void tcs3472x_metrics_server_stop(tcs3472x_metrics_server_t *server);
+
+#endif // TCS3472X_METRICS_H
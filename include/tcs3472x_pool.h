@@ -0,0 +1,114 @@
+/**
+ * @file tcs3472x_pool.h
+ * @brief Work-stealing thread pool running parallel loops over sensors on Linux.
+ *
+ * tcs3472x_pool_run() calls a function on every index of a range, for example every device of a
+ * processing batch, spread over the pool's threads. The calling thread takes part as worker 0.
+ *
+ * Every worker owns a deque of index ranges. The whole range starts on worker 0's deque. A worker
+ * takes the newest range from its own deque, and while it is larger than the batch size, pushes back
+ * the upper half and keeps the lower half, so the work splits only as far as idle workers ask for
+ * it. Idle workers steal the oldest, and so largest, range from another worker's deque. Deques are
+ * lock-free (Chase and Lev), so the owner's push and pop never wait on thieves.
+ *
+ * The batch size sets the smallest range handed to the function; larger batches amortize scheduling,
+ * smaller ones balance uneven work better. The pool never allocates after start.
+ */
+
+#ifndef TCS3472X_POOL_H
+#define TCS3472X_POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define TCS3472X_POOL_MAX_WORKERS   64  ///< Most workers, including the calling thread.
+#define TCS3472X_POOL_DEQUE_SIZE    64  ///< Ranges per deque; splitting a 32-bit range needs at most 32.
+
+/**
+ * @brief Function run on the indexes begin to end − 1.
+ */
+typedef void (*tcs3472x_pool_fn_t)(void *context, uint32_t begin, uint32_t end);
+
+/**
+ * @brief Lock-free deque of one worker, on its own cache lines.
+ */
+typedef struct {
+    _Alignas(64) atomic_llong top;                      ///< Oldest range, taken by thieves.
+    _Alignas(64) atomic_llong bottom;                   ///< One past the newest range, owner only.
+    atomic_ullong ranges[TCS3472X_POOL_DEQUE_SIZE];     ///< Ranges as begin << 32 | end.
+} tcs3472x_pool_deque_t;
+
+/**
+ * @brief Counters of a pool.
+ */
+typedef struct {
+    uint64_t runs;      ///< Completed tcs3472x_pool_run() calls.
+    uint64_t batches;   ///< Function calls.
+    uint64_t splits;    ///< Ranges split in half.
+    uint64_t steals;    ///< Ranges taken from another worker.
+} tcs3472x_pool_stats_t;
+
+/**
+ * @brief Work-stealing pool.
+ */
+typedef struct {
+    tcs3472x_pool_deque_t deques[TCS3472X_POOL_MAX_WORKERS]; ///< One per worker, 0 is the caller's.
+    pthread_t threads[TCS3472X_POOL_MAX_WORKERS];   ///< Threads of workers 1 and up.
+    uint32_t workers;                   ///< Workers including the calling thread.
+    atomic_uint next_worker;            ///< Deque index handed to the next worker thread.
+    pthread_mutex_t lock;               ///< Protects the job fields and the counters below.
+    pthread_cond_t wake;                ///< Signalled when a job starts or the pool stops.
+    pthread_cond_t idle;                ///< Signalled when a worker finished a job.
+    uint64_t generation;                ///< Incremented for every job.
+    uint32_t finished;                  ///< Workers that finished the current job.
+    uint8_t stop;                       ///< Set to end the worker threads.
+    tcs3472x_pool_fn_t fn;              ///< Function of the current job.
+    void *context;                      ///< Context of the current job.
+    uint32_t batch;                     ///< Batch size of the current job.
+    atomic_uint remaining;              ///< Indexes of the current job not processed yet.
+    atomic_ullong batches;              ///< Function calls.
+    atomic_ullong splits;               ///< Ranges split in half.
+    atomic_ullong steals;               ///< Ranges taken from another worker.
+    uint64_t runs;                      ///< Completed jobs.
+} tcs3472x_pool_t;
+
+/**
+ * @brief Starts the worker threads of a pool.
+ *
+ * @param pool Pool to start.
+ * @param workers Number of workers including the calling thread, 1 to TCS3472X_POOL_MAX_WORKERS.
+ *                With 1 worker, jobs run on the calling thread only.
+ * @return Returns 0 on success, or -1 if the count is invalid or a thread cannot be created.
+ */
+int8_t tcs3472x_pool_start(tcs3472x_pool_t *pool, uint32_t workers);
+
+/**
+ * @brief Runs a function on every index of a range and waits until all calls have returned.
+ *
+ * Only one thread may run jobs on a pool at a time.
+ *
+ * @param pool Started pool.
+ * @param fn Function to call.
+ * @param context Passed to fn.
+ * @param count Number of indexes, 0 to count − 1.
+ * @param batch Smallest range split off, 0 to use count / (8 × workers).
+ */
+void tcs3472x_pool_run(tcs3472x_pool_t *pool, tcs3472x_pool_fn_t fn, void *context, uint32_t count, uint32_t batch);
+
+/**
+ * @brief Copies the pool's counters.
+ *
+ * @param pool Pool to read.
+ * @param stats Destination for the counters.
+ */
+void tcs3472x_pool_get_stats(tcs3472x_pool_t *pool, tcs3472x_pool_stats_t *stats);
+
+/**
+ * @brief Stops and joins the worker threads.
+ *
+ * @param pool Pool to stop.
+ */
+void tcs3472x_pool_stop(tcs3472x_pool_t *pool);
+
+#endif // TCS3472X_POOL_H
@@ -0,0 +1,81 @@
+/**
+ * @file tcs3472x_post.h
+ * @brief Per-device post-processing of raw samples: calibration, filtering and lux.
+ *
+ * Each device runs its own pipeline over a batch of raw samples:
+ *
+ * 1. dark offset subtraction, clamped at zero,
+ * 2. per-channel gain calibration in 16.16 fixed point, clamped to the 16-bit range,
+ * 3. an exponential moving average with weight 1 / 2^filter_shift, kept in 8 fractional bits,
+ * 4. illuminance of the filtered sample with tcs3472x_lux_mlux().
+ *
+ * A device's state only depends on its own samples, so different devices can be processed on
+ * different threads in any order; tcs3472x_post_range() has the signature of a tcs3472x_pool_fn_t
+ * for that purpose. All arithmetic is integer.
+ */
+
+#ifndef TCS3472X_POST_H
+#define TCS3472X_POST_H
+
+#include <stdint.h>
+
+#include "tcs3472x_lux.h"
+
+#define TCS3472X_POST_GAIN_ONE      65536   ///< Calibration gain of 1.0 in 16.16 fixed point.
+#define TCS3472X_POST_FILTER_BITS   8       ///< Fractional bits of the filter state.
+
+/**
+ * @brief Pipeline of one device.
+ */
+typedef struct {
+    uint16_t dark[4];           ///< Dark offsets subtracted from clear, red, green and blue.
+    uint32_t gain_q16[4];       ///< Calibration gains in 16.16 fixed point.
+    uint8_t filter_shift;       ///< Filter weight 1 / 2^filter_shift, 0 to pass samples through.
+    uint8_t atime;              ///< ATIME the device samples with.
+    uint8_t again;              ///< AGAIN the device samples with.
+    tcs3472x_lux_params_t lux;  ///< Lux coefficients.
+    uint32_t filter[4];         ///< Filter state with TCS3472X_POST_FILTER_BITS fractional bits.
+    uint16_t filtered[4];       ///< Last filtered sample.
+    uint32_t mlux;              ///< Illuminance of the last filtered sample in millilux.
+    uint32_t samples;           ///< Samples processed.
+    uint8_t primed;             ///< Non-zero once the filter holds a sample.
+} tcs3472x_post_device_t;
+
+/**
+ * @brief A batch of raw samples for a set of devices, as passed to tcs3472x_post_range().
+ */
+typedef struct {
+    tcs3472x_post_device_t *devices;    ///< Device pipelines.
+    const uint16_t (*samples)[4];       ///< count samples per device, device after device.
+    uint32_t count;                     ///< Samples per device in this batch.
+} tcs3472x_post_batch_t;
+
+/**
+ * @brief Initializes a pipeline with no dark offset, unity gains and the default lux coefficients.
+ *
+ * @param device Pipeline to initialize.
+ * @param filter_shift Filter weight 1 / 2^filter_shift.
+ * @param atime ATIME the device samples with.
+ * @param again AGAIN the device samples with.
+ */
+void tcs3472x_post_init(tcs3472x_post_device_t *device, uint8_t filter_shift, uint8_t atime, uint8_t again);
+
+/**
+ * @brief Runs samples of one device through its pipeline.
+ *
+ * @param device Pipeline to update.
+ * @param samples Clear, red, green and blue data, oldest first.
+ * @param count Number of samples.
+ */
+void tcs3472x_post_process(tcs3472x_post_device_t *device, const uint16_t (*samples)[4], uint32_t count);
+
+/**
+ * @brief Processes the devices begin to end − 1 of a batch.
+ *
+ * @param context The tcs3472x_post_batch_t to process.
+ * @param begin First device.
+ * @param end One past the last device.
+ */
+void tcs3472x_post_range(void *context, uint32_t begin, uint32_t end);
+
+#endif // TCS3472X_POST_H
@@ -0,0 +1,102 @@
+/**
+ * @file tcs3472x_power.h
+ * @brief Power consumption estimate and low-power configuration planner for the TCS3472x.
+ *
+ * The estimate weights the datasheet supply currents of the sensor states by the time the sensor
+ * spends in them: active during the RGBC integration, wait state during the wait time and while
+ * powered on without AEN, sleep with PON cleared. Bus energy is the time the host's color reads keep
+ * the bus busy, taken from the cost model of tcs3472x_bus_cost.h, times the power drawn through the
+ * two pull-up resistors while a line is low, assuming each line is low half of that time.
+ *
+ * The planner searches every gain and ATIME for the configuration with the lowest average sensor
+ * current whose cycle fits the required sample period and whose dimmest scene still reaches the
+ * required signal-to-noise ratio without the brightest scene saturating. The remaining time of the
+ * period is filled with the wait state, which draws less current than an integration.
+ *
+ * All arithmetic is integer so the planner can run on the target as well as on a host.
+ */
+
+#ifndef TCS3472X_POWER_H
+#define TCS3472X_POWER_H
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+#include "tcs3472x_bus_cost.h"
+
+#define TCS3472X_POWER_ACTIVE_NA    235000  ///< Typical supply current while integrating.
+#define TCS3472X_POWER_WAIT_NA      65000   ///< Typical supply current in the wait state.
+#define TCS3472X_POWER_SLEEP_NA     2500    ///< Typical supply current in sleep.
+
+/**
+ * @brief Electrical parameters of the estimate.
+ */
+typedef struct {
+    uint32_t active_na;         ///< Sensor supply current while integrating, in nanoamperes.
+    uint32_t wait_na;           ///< Sensor supply current in the wait state, in nanoamperes.
+    uint32_t sleep_na;          ///< Sensor supply current in sleep, in nanoamperes.
+    uint32_t vdd_mv;            ///< Supply and bus pull-up voltage in millivolts.
+    uint32_t pullup_ohm;        ///< Resistance of each bus pull-up.
+    tcs3472x_bus_config_t bus;  ///< Bus the color reads are costed on.
+} tcs3472x_power_params_t;
+
+/**
+ * @brief Result of an estimate.
+ */
+typedef struct {
+    uint32_t cycle_us;          ///< Time between two samples of the sensor, 0 if AEN is clear.
+    uint32_t sensor_na;         ///< Average sensor supply current in nanoamperes.
+    uint32_t sensor_uj_per_hour;///< Sensor supply energy per hour in microjoules.
+    uint32_t bus_uj_per_hour;   ///< Bus pull-up energy of the host reads per hour in microjoules.
+} tcs3472x_power_estimate_t;
+
+/**
+ * @brief What the planner must achieve.
+ *
+ * Scene brightness is given as clear channel counts per second at 1x gain. The signal-to-noise ratio
+ * is the clear count of the dimmest scene over the noise floor in counts.
+ */
+typedef struct {
+    uint32_t rate_mhz;              ///< Required sample rate in millihertz (1000 = 1 Hz).
+    uint32_t min_counts_per_s;      ///< Clear counts per second at 1x gain of the dimmest scene.
+    uint32_t max_counts_per_s;      ///< Clear counts per second at 1x gain of the brightest scene, 0 to ignore.
+    uint16_t min_snr;               ///< Required clear count of the dimmest scene over noise_counts.
+    uint16_t noise_counts;          ///< Noise floor in counts.
+} tcs3472x_power_requirement_t;
+
+/**
+ * @brief Fills the parameters with the datasheet typical currents, 3.3 V, 4.7 kΩ pull-ups and a
+ *        fast mode bus.
+ *
+ * @param params Parameters to fill.
+ */
+void tcs3472x_power_params_default(tcs3472x_power_params_t *params);
+
+/**
+ * @brief Estimates the power drawn by a sensor configuration and its host reads.
+ *
+ * @param params Electrical parameters.
+ * @param config Configuration the sensor runs with, usually tcs3472x_get_config_cache().
+ * @param read_rate_mhz Rate at which the host reads the color data, in millihertz.
+ * @param estimate Destination for the estimate.
+ */
+void tcs3472x_power_estimate(const tcs3472x_power_params_t *params, const tcs3472x_config_cache_t *config,
+                             uint32_t read_rate_mhz, tcs3472x_power_estimate_t *estimate);
+
+/**
+ * @brief Finds the lowest-power configuration that meets a requirement.
+ *
+ * The planned enable value has PON and AEN set, and WEN if a wait time is used. The estimate assumes
+ * the host reads once per required sample period.
+ *
+ * @param params Electrical parameters.
+ * @param requirement Sample rate, brightness and signal-to-noise requirement.
+ * @param config Destination for the planned register values.
+ * @param estimate Destination for the estimate of the planned configuration.
+ * @return Returns 0 on success, or -1 if no configuration meets the requirement.
+ */
+int8_t tcs3472x_power_plan(const tcs3472x_power_params_t *params,
+                           const tcs3472x_power_requirement_t *requirement,
+                           tcs3472x_config_cache_t *config, tcs3472x_power_estimate_t *estimate);
+
+#endif // TCS3472X_POWER_H
@@ -0,0 +1,140 @@
+/**
+ * @file tcs3472x_queue.h
+ * @brief Submission/completion queue for TCS3472x operations on Linux i2c-dev buses.
+ *
+ * Callers submit read and configuration requests for any sensor of a group and return immediately.
+ * One worker thread per bus collects everything queued for its bus and issues it as combined I2C_RDWR
+ * ioctls, up to I2C_RDWR_IOCTL_MAX_MSGS messages each. A finished request is handed back either by
+ * calling its callback on the worker thread, or, if it has no callback, by appending it to the
+ * completion queue and signalling an eventfd that an event loop can poll.
+ *
+ * Requests are caller-owned and must stay untouched from submission until completion; the queue never
+ * allocates. While a queue is running, the group must not be used directly.
+ *
+ * Event-loop use:
+ *
+ *     tcs3472x_queue_submit(&queue, &request);
+ *     // poll()/epoll on tcs3472x_queue_event_fd(&queue), then:
+ *     n = tcs3472x_queue_reap(&queue, done, 16);
+ */
+
+#ifndef TCS3472X_QUEUE_H
+#define TCS3472X_QUEUE_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "tcs3472x_group.h"
+
+/**
+ * @brief Operations a request can perform.
+ */
+typedef enum {
+    TCS3472X_QUEUE_OP_READ_COLORS,      ///< Read clear, red, green and blue into colors.
+    TCS3472X_QUEUE_OP_READ_REGISTER,    ///< Read reg_address into value.
+    TCS3472X_QUEUE_OP_WRITE_REGISTER,   ///< Write value to reg_address.
+} tcs3472x_queue_op_t;
+
+struct tcs3472x_queue_request;
+
+/**
+ * @brief Called on the bus worker thread when a request has finished.
+ *
+ * @param request The finished request; its result field is set.
+ */
+typedef void (*tcs3472x_queue_cb_t)(struct tcs3472x_queue_request *request);
+
+/**
+ * @brief One queued operation.
+ *
+ * The caller fills sensor, op, reg_address, value (for writes), callback and context. The remaining
+ * fields are set by the queue.
+ */
+typedef struct tcs3472x_queue_request {
+    uint8_t sensor;                         ///< Index of the sensor in the group.
+    uint8_t op;                             ///< tcs3472x_queue_op_t to perform.
+    uint8_t reg_address;                    ///< Register of a register read or write.
+    uint8_t value;                          ///< Value to write, or value read.
+    uint16_t colors[4];                     ///< Clear, red, green and blue of a color read.
+    tcs3472x_queue_cb_t callback;           ///< Completion callback, or NULL for the completion queue.
+    void *context;                          ///< Caller data, untouched by the queue.
+    int8_t result;                          ///< 0 on success, -1 if the transfer failed.
+    int64_t complete_ns;                    ///< CLOCK_MONOTONIC time the transfer finished.
+    struct tcs3472x_queue_request *next;    ///< Link used while queued.
+} tcs3472x_queue_request_t;
+
+struct tcs3472x_queue;
+
+/**
+ * @brief Worker servicing one bus. All fields are maintained by the queue functions.
+ */
+typedef struct {
+    struct tcs3472x_queue *queue;           ///< Queue the worker belongs to.
+    uint8_t bus_index;                      ///< Index of the bus in the group.
+    pthread_t thread;                       ///< Worker thread.
+    pthread_mutex_t lock;                   ///< Protects head, tail and running.
+    pthread_cond_t wake;                    ///< Signalled on submission and stop.
+    tcs3472x_queue_request_t *head;         ///< First pending request.
+    tcs3472x_queue_request_t *tail;         ///< Last pending request.
+    uint8_t running;                        ///< Cleared to stop the worker once its list is empty.
+} tcs3472x_queue_worker_t;
+
+/**
+ * @brief A submission/completion queue over the buses of a group.
+ */
+typedef struct tcs3472x_queue {
+    tcs3472x_group_t *group;                                ///< Group whose sensors are addressed.
+    tcs3472x_queue_worker_t workers[TCS3472X_GROUP_MAX_BUSES]; ///< One worker per bus of the group.
+    uint8_t worker_count;                                   ///< Number of started workers.
+    int event_fd;                                           ///< Signalled when a completion is queued.
+    pthread_mutex_t completion_lock;                        ///< Protects the completion queue.
+    tcs3472x_queue_request_t *completed_head;               ///< Oldest completion not yet reaped.
+    tcs3472x_queue_request_t *completed_tail;               ///< Newest completion not yet reaped.
+} tcs3472x_queue_t;
+
+/**
+ * @brief Creates the completion eventfd and starts one worker per bus of a group.
+ *
+ * @param queue Queue to initialize.
+ * @param group Initialized group, which must outlive the queue.
+ * @return Returns 0 on success, or -1 if an error occurs.
+ */
+int8_t tcs3472x_queue_init(tcs3472x_queue_t *queue, tcs3472x_group_t *group);
+
+/**
+ * @brief Queues a request on the worker of its sensor's bus.
+ *
+ * @param queue Queue to submit to.
+ * @param request Request to perform, owned by the queue until it completes.
+ * @return Returns 0 on success, or -1 if the request is invalid or the queue is stopping.
+ */
+int8_t tcs3472x_queue_submit(tcs3472x_queue_t *queue, tcs3472x_queue_request_t *request);
+
+/**
+ * @brief Returns the eventfd that becomes readable when completions are waiting to be reaped.
+ *
+ * @param queue Queue to query.
+ * @return The eventfd file descriptor.
+ */
+int tcs3472x_queue_event_fd(const tcs3472x_queue_t *queue);
+
+/**
+ * @brief Takes finished requests without a callback off the completion queue, oldest first.
+ *
+ * @param queue Queue to reap from.
+ * @param requests Destination for the finished requests.
+ * @param max Size of requests.
+ * @return The number of requests stored in requests.
+ */
+uint32_t tcs3472x_queue_reap(tcs3472x_queue_t *queue, tcs3472x_queue_request_t **requests, uint32_t max);
+
+/**
+ * @brief Completes all queued requests, stops the workers and closes the eventfd.
+ *
+ * The group itself is left open.
+ *
+ * @param queue Queue to close.
+ */
+void tcs3472x_queue_close(tcs3472x_queue_t *queue);
+
+#endif // TCS3472X_QUEUE_H
@@ -0,0 +1,101 @@
+/**
+ * @file tcs3472x_sched.h
+ * @brief Earliest-deadline-first read scheduler for sensors of a group running at different rates.
+ *
+ * Every sensor of a group gets its own sampling period and relative deadline. A read is released at
+ * the first AVALID event (predicted from the sensor's start time and cached ATIME/WTIME) at or after
+ * its nominal release time, so no read fetches stale data. Released reads are issued in deadline order.
+ *
+ * Admission control keeps the estimated bus utilization of every bus below a configurable limit, and
+ * rejects periods shorter than the sensor's RGBC cycle, which could only return repeated data.
+ */
+
+#ifndef TCS3472X_SCHED_H
+#define TCS3472X_SCHED_H
+
+#include <stdint.h>
+
+#include "tcs3472x_group.h"
+#include "tcs3472x_bus_cost.h"
+
+#define TCS3472X_SCHED_DEFAULT_LIMIT_PPM    900000  ///< Default bus utilization limit (90 %).
+
+/**
+ * @brief Called after every scheduled read with the sensor's fresh data.
+ */
+typedef void (*tcs3472x_sched_callback_t)(void *context, uint8_t sensor_index,
+                                         const tcs3472x_group_sensor_t *sensor);
+
+/**
+ * @brief Scheduling state of one sensor.
+ */
+typedef struct {
+    uint8_t active;             ///< Non-zero if the sensor has been admitted.
+    int64_t period_ns;          ///< Sampling period.
+    int64_t deadline_ns;        ///< Relative deadline, measured from the release.
+    int64_t release_ns;         ///< Absolute time of the next release.
+    int64_t due_ns;             ///< Absolute deadline of the next release.
+    uint32_t completed;         ///< Reads performed.
+    uint32_t missed;            ///< Reads that finished after their deadline.
+    uint32_t failed;            ///< Reads that failed on the bus.
+} tcs3472x_sched_task_t;
+
+/**
+ * @brief Scheduler over the sensors of one group.
+ */
+typedef struct {
+    tcs3472x_group_t *group;                               ///< Group being scheduled.
+    tcs3472x_sched_task_t tasks[TCS3472X_GROUP_MAX_SENSORS]; ///< One task per group sensor.
+    uint32_t bus_load_ppm[TCS3472X_GROUP_MAX_BUSES];       ///< Admitted utilization per bus.
+    uint32_t limit_ppm;                                    ///< Admission limit per bus.
+    int64_t read_cost_ns;                                  ///< Estimated bus time of one sensor read.
+    tcs3472x_sched_callback_t callback;                    ///< Optional per-read callback.
+    void *context;                                         ///< Passed to callback.
+} tcs3472x_sched_t;
+
+/**
+ * @brief Initializes a scheduler for a started group.
+ *
+ * @param sched Scheduler to initialize.
+ * @param group Group to schedule. tcs3472x_group_start() must have been called.
+ * @param bus Bus configuration used to estimate the bus time of a read with the cost model.
+ * @param callback Optional function called after each read, may be NULL.
+ * @param context Passed to callback.
+ */
+void tcs3472x_sched_init(tcs3472x_sched_t *sched, tcs3472x_group_t *group,
+                         const tcs3472x_bus_config_t *bus, tcs3472x_sched_callback_t callback,
+                         void *context);
+
+/**
+ * @brief Admits a sensor with the given period and relative deadline.
+ *
+ * @param sched Scheduler to add the sensor to.
+ * @param sensor_index Index of the sensor in the group.
+ * @param period_us Sampling period in microseconds.
+ * @param deadline_us Time after each release by which the read must be done, in microseconds.
+ * @param now_ns Current CLOCK_MONOTONIC time; the first release is the next AVALID after it.
+ * @return Returns 0 if admitted, or -1 if the sensor is not in the group, the period is shorter than
+ *         the sensor cycle or the bus would exceed its utilization limit. A sensor that is already
+ *         scheduled keeps its current period when the new one is rejected.
+ */
+int8_t tcs3472x_sched_add(tcs3472x_sched_t *sched, uint8_t sensor_index, uint32_t period_us,
+                          uint32_t deadline_us, int64_t now_ns);
+
+/**
+ * @brief Removes a sensor from the schedule and returns its bus time to the budget.
+ *
+ * @param sched Scheduler to remove the sensor from.
+ * @param sensor_index Index of the sensor in the group; indices outside the group are ignored.
+ */
+void tcs3472x_sched_remove(tcs3472x_sched_t *sched, uint8_t sensor_index);
+
+/**
+ * @brief Issues all reads released at or before now_ns, earliest deadline first.
+ *
+ * @param sched Scheduler to run.
+ * @param now_ns Current CLOCK_MONOTONIC time.
+ * @return The absolute time of the next release, or INT64_MAX if no sensor is scheduled.
+ */
+int64_t tcs3472x_sched_poll(tcs3472x_sched_t *sched, int64_t now_ns);
+
+#endif // TCS3472X_SCHED_H
@@ -0,0 +1,181 @@
+/**
+ * @file tcs3472x_sort.h
+ * @brief Trigger-to-decision color sorting against a palette of reference colors.
+ *
+ * The pipeline keeps the sensor powered with the shortest integration time. A trigger, for example a
+ * light barrier on a conveyor, restarts the integration cycle with one bus write, so the sample only
+ * covers the part in front of the sensor. Once the integration has had time to complete, each poll
+ * reads STATUS and the four channels in one combined write/read transaction until AVALID is set, then
+ * classifies the sample and returns a decision with the time from the trigger.
+ *
+ * Classification converts the red, green and blue counts to CIE XYZ with a 3x3 matrix and then to
+ * CIELAB. Parts pass at varying distance and angle, so lightness is normalized away by dividing by Y:
+ * every sample is compared at L* = 100 and Delta E (CIE76) is taken over a* and b* alone. The default
+ * matrix treats the channels as linear sRGB primaries; a matrix measured on the machine can replace
+ * it. The reference colors are usually taught in by showing each part to the sensor, so the sensor's
+ * own color response cancels out.
+ *
+ * The nearest reference is found through a grid over the part of the a*b* plane the palette covers,
+ * widened by max_delta_e on every side. Each cell lists the references that can be nearest for some
+ * point inside it, so a lookup only measures a few distances however large the palette is, and still
+ * returns the same reference as a full scan. Colors outside the grid, which are rejected unless
+ * max_delta_e is raised afterwards, fall back to a full scan.
+ *
+ * All arithmetic is integer. Delta E values are in 1/16 units (TCS3472X_SORT_DELTA_E_ONE), and times
+ * are nanoseconds of a monotonic clock supplied by the caller.
+ */
+
+#ifndef TCS3472X_SORT_H
+#define TCS3472X_SORT_H
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+
+#define TCS3472X_SORT_DELTA_E_ONE       16      ///< A Delta E of 1 in the units of this module.
+#define TCS3472X_SORT_MAX_REFERENCES    32      ///< Palette capacity.
+#define TCS3472X_SORT_GRID_SIZE         16      ///< Cells per axis of the lookup grid.
+#define TCS3472X_SORT_MAX_CANDIDATES    1024    ///< Total candidate entries of all grid cells.
+#define TCS3472X_SORT_REJECT            (-1)    ///< Decision for samples that match no reference.
+
+/**
+ * @brief Pipeline settings.
+ */
+typedef struct {
+    int16_t matrix[3][3];       ///< Red, green and blue counts to X, Y and Z, 4096 = 1.0.
+    uint8_t atime;              ///< ATIME while sorting; 0xFF is the shortest integration (2.4 ms).
+    uint8_t again;              ///< AGAIN while sorting.
+    uint16_t min_clear;         ///< Clear count below which no part is assumed in view.
+    uint16_t max_delta_e;       ///< Largest Delta E accepted as a match.
+    uint32_t timeout_ns;        ///< Time after the trigger at which a missing AVALID is an error.
+} tcs3472x_sort_config_t;
+
+/**
+ * @brief A reference color in the a*b* plane.
+ */
+typedef struct {
+    int16_t a;                  ///< a* in 1/16 units.
+    int16_t b;                  ///< b* in 1/16 units.
+} tcs3472x_sort_reference_t;
+
+/**
+ * @brief Result of one trigger.
+ */
+typedef struct {
+    int8_t reference;           ///< Index of the nearest reference, or TCS3472X_SORT_REJECT.
+    uint16_t delta_e;           ///< Delta E to the nearest reference, in 1/16 units.
+    tcs3472x_sort_reference_t color;  ///< a* and b* of the sample.
+    uint16_t colors[4];         ///< Clear, red, green and blue counts of the sample.
+    int64_t latency_ns;         ///< Time from the trigger to the poll that produced the decision.
+} tcs3472x_sort_decision_t;
+
+/**
+ * @brief Palette, lookup grid and pipeline state.
+ */
+typedef struct {
+    tcs3472x_sort_config_t config;  ///< Settings.
+    tcs3472x_sort_reference_t references[TCS3472X_SORT_MAX_REFERENCES]; ///< Palette.
+    uint8_t reference_count;    ///< References in the palette.
+    uint8_t indexed;            ///< Non-zero while the grid matches the palette.
+    tcs3472x_sort_reference_t grid_origin; ///< Lowest a* and b* covered by the grid.
+    uint16_t cell_width;        ///< Width of a grid cell in 1/16 units.
+    uint16_t cell_start[TCS3472X_SORT_GRID_SIZE * TCS3472X_SORT_GRID_SIZE + 1]; ///< Candidate ranges per cell.
+    uint8_t candidates[TCS3472X_SORT_MAX_CANDIDATES];   ///< Reference indices of all cells.
+    uint16_t full_scale;        ///< Clear count of a saturated sample at the configured ATIME.
+    uint8_t pending;            ///< Non-zero between a trigger and its decision.
+    int64_t trigger_ns;         ///< Time of the pending trigger.
+    int64_t ready_ns;           ///< Earliest time the integration can have completed.
+    uint32_t decisions;         ///< Decisions returned, rejects included.
+    uint32_t rejects;           ///< Decisions without a matching reference.
+    uint32_t errors;            ///< Bus errors and timeouts.
+} tcs3472x_sorter_t;
+
+/**
+ * @brief Fills a configuration with the linear sRGB to XYZ matrix, ATIME 0xFF, 16x gain, a minimum clear
+ *        count of 16, a maximum Delta E of 10 and a timeout of 10 ms.
+ *
+ * @param config Configuration to fill.
+ */
+void tcs3472x_sort_config_default(tcs3472x_sort_config_t *config);
+
+/**
+ * @brief Initializes a sorter with an empty palette and sets the sensor up for sorting.
+ *
+ * Powers the sensor on with the configured ATIME and AGAIN and no wait time, keeping the cached low
+ * interrupt threshold.
+ *
+ * @param sorter Sorter to initialize.
+ * @param config Settings, copied into the sorter.
+ * @return Returns 0 on success, or -1 if the sensor could not be configured.
+ */
+int8_t tcs3472x_sort_init(tcs3472x_sorter_t *sorter, const tcs3472x_sort_config_t *config);
+
+/**
+ * @brief Converts a sample to its a*b* color at normalized lightness.
+ *
+ * @param config Settings with the XYZ matrix.
+ * @param colors Clear, red, green and blue counts.
+ * @param color Destination for a* and b*, each clamped to ±2048.
+ */
+void tcs3472x_sort_color(const tcs3472x_sort_config_t *config, const uint16_t colors[4],
+                         tcs3472x_sort_reference_t *color);
+
+/**
+ * @brief Adds a reference color to the palette. The lookup grid has to be rebuilt afterwards.
+ *
+ * @param sorter Sorter to add to.
+ * @param color Reference color, for example from tcs3472x_sort_color() on a sample of the part.
+ * @return The index of the new reference, or -1 if the palette is full.
+ */
+int8_t tcs3472x_sort_add_reference(tcs3472x_sorter_t *sorter, const tcs3472x_sort_reference_t *color);
+
+/**
+ * @brief Builds the lookup grid for the current palette.
+ *
+ * @param sorter Sorter to index.
+ * @return Returns 0 on success, or -1 if the candidate lists do not fit TCS3472X_SORT_MAX_CANDIDATES.
+ *         Lookups then scan the whole palette.
+ */
+int8_t tcs3472x_sort_build_index(tcs3472x_sorter_t *sorter);
+
+/**
+ * @brief Finds the reference nearest to a color.
+ *
+ * Uses the grid when it is built and the color lies inside it, and scans the palette otherwise.
+ *
+ * @param sorter Sorter with the palette.
+ * @param color Color to match.
+ * @param delta_e If not NULL, receives the Delta E to the nearest reference in 1/16 units,
+ *                saturated at UINT16_MAX.
+ * @return The index of the nearest reference, or -1 if the palette is empty.
+ */
+int8_t tcs3472x_sort_match(const tcs3472x_sorter_t *sorter, const tcs3472x_sort_reference_t *color,
+                           uint16_t *delta_e);
+
+/**
+ * @brief Starts a measurement by restarting the integration cycle.
+ *
+ * A trigger while another one is pending restarts the measurement.
+ *
+ * @param sorter Sorter to trigger.
+ * @param now_ns Time of the trigger event.
+ * @return Returns 0 on success, or -1 if the restart failed.
+ */
+int8_t tcs3472x_sort_trigger(tcs3472x_sorter_t *sorter, int64_t now_ns);
+
+/**
+ * @brief Completes a pending measurement once its sample is available.
+ *
+ * Does not touch the bus before the integration can have completed, and reads STATUS and the data
+ * in one transaction afterwards. Samples below min_clear, saturated samples and samples further than
+ * max_delta_e from every reference are rejected.
+ *
+ * @param sorter Sorter to poll.
+ * @param now_ns Current time.
+ * @param decision Destination for the decision.
+ * @return 1 if a decision was made, 0 if the sample is not available yet or nothing is pending, or -1
+ *         on a bus error or timeout, which ends the pending measurement.
+ */
+int8_t tcs3472x_sort_poll(tcs3472x_sorter_t *sorter, int64_t now_ns, tcs3472x_sort_decision_t *decision);
+
+#endif // TCS3472X_SORT_H
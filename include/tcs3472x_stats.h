@@ -0,0 +1,61 @@
+/**
+ * @file tcs3472x_stats.h
+ * @brief Per-device counters and transaction latency histogram.
+ *
+ * The core driver counts samples and saturated samples of the sensor it drives, the platform HAL
+ * counts transactions, their failures and their latency, and recovery code counts retries. Each
+ * counter has a single writer; readers on other threads may see a snapshot in which counters are
+ * momentarily inconsistent with each other, which is acceptable for monitoring.
+ */
+
+#ifndef TCS3472X_STATS_H
+#define TCS3472X_STATS_H
+
+#include <stdint.h>
+
+#define TCS3472X_STATS_LATENCY_BUCKETS  9   ///< Latency histogram buckets, the last one unbounded.
+
+/**
+ * @brief Upper bounds of the latency buckets in microseconds; the last bucket has no bound.
+ */
+extern const uint32_t tcs3472x_stats_latency_bounds_us[TCS3472X_STATS_LATENCY_BUCKETS - 1];
+
+/**
+ * @brief Counters of one device.
+ */
+typedef struct {
+    uint32_t samples;           ///< Color samples read.
+    uint32_t saturations;       ///< Samples whose clear channel reached full scale.
+    uint32_t transactions;      ///< Bus transactions issued.
+    uint32_t errors;            ///< Failed bus transactions.
+    uint32_t retries;           ///< Operations repeated after a failure.
+    uint32_t latency_buckets[TCS3472X_STATS_LATENCY_BUCKETS]; ///< Transactions per latency bucket.
+    uint64_t latency_sum_ns;    ///< Sum of all transaction latencies.
+} tcs3472x_stats_t;
+
+/**
+ * @brief Returns the counters of the device driven by the core driver.
+ *
+ * @return Pointer to the core driver's counters.
+ */
+tcs3472x_stats_t *tcs3472x_get_stats(void);
+
+/**
+ * @brief Records one bus transaction.
+ *
+ * @param stats Counters to update.
+ * @param latency_ns Duration of the transaction.
+ * @param result 0 if the transaction succeeded, negative otherwise.
+ */
+void tcs3472x_stats_record_transaction(tcs3472x_stats_t *stats, uint32_t latency_ns, int8_t result);
+
+/**
+ * @brief Records one color sample and checks it for saturation.
+ *
+ * @param stats Counters to update.
+ * @param clear Clear channel count of the sample.
+ * @param atime ATIME register value the sample was integrated with.
+ */
+void tcs3472x_stats_record_sample(tcs3472x_stats_t *stats, uint16_t clear, uint8_t atime);
+
+#endif // TCS3472X_STATS_H
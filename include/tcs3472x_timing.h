@@ -0,0 +1,66 @@
+/**
+ * @file tcs3472x_timing.h
+ * @brief Estimation of the integration window a sample was taken over.
+ *
+ * A sample describes the light collected during an integration window that ended at the last AVALID
+ * event before the data registers were read, not the time the read returned. The estimator anchors
+ * the sensor's cycle to one observed AVALID transition after a restart of the integration cycle and
+ * predicts later windows from the configured ATIME, WTIME, WLONG and WEN. The internal oscillator may run
+ * up to roughly 10 % off nominal, so the duration of the first integration, as observed, is used to
+ * scale all predicted durations.
+ *
+ * Times are plain nanosecond counts of whatever monotonic clock the caller uses.
+ */
+
+#ifndef TCS3472X_TIMING_H
+#define TCS3472X_TIMING_H
+
+#include <stdint.h>
+
+#include "tcs3472x.h"
+
+/**
+ * @brief Cycle model of one sensor.
+ */
+typedef struct {
+    tcs3472x_config_cache_t config; ///< Register values the model was built from.
+    int64_t atime_ns;           ///< Integration time, scaled to the observed oscillator.
+    int64_t cycle_ns;           ///< Time between two AVALID events, scaled to the observed oscillator.
+    int64_t first_end_ns;       ///< Estimated end of the first integration after the restart.
+    int64_t uncertainty_ns;     ///< Half width of the interval the first end is known to lie in.
+    uint8_t synced;             ///< Non-zero once tcs3472x_timing_sync() has been called.
+} tcs3472x_timing_t;
+
+/**
+ * @brief Initializes a cycle model from register values.
+ *
+ * @param timing Model to initialize.
+ * @param config Configuration the sensor runs with, usually tcs3472x_get_config_cache().
+ */
+void tcs3472x_timing_init(tcs3472x_timing_t *timing, const tcs3472x_config_cache_t *config);
+
+/**
+ * @brief Anchors the model to the first AVALID event after AEN was set.
+ *
+ * @param timing Model to anchor.
+ * @param enable_ns Midpoint of the write that set AEN.
+ * @param invalid_ns Midpoint of the last status read that saw AVALID clear, or enable_ns if none did.
+ * @param valid_ns Midpoint of the first status read that saw AVALID set.
+ */
+void tcs3472x_timing_sync(tcs3472x_timing_t *timing, int64_t enable_ns, int64_t invalid_ns,
+                          int64_t valid_ns);
+
+/**
+ * @brief Estimates the integration window of the data read at a given time.
+ *
+ * @param timing Anchored model.
+ * @param read_ns Midpoint of the data read transaction.
+ * @param start_ns Destination for the estimated window start.
+ * @param end_ns Destination for the estimated window end.
+ * @return Returns 0 on success, or -1 if the model is not anchored or no integration had completed
+ *         at read_ns.
+ */
+int8_t tcs3472x_timing_window(const tcs3472x_timing_t *timing, int64_t read_ns, int64_t *start_ns,
+                              int64_t *end_ns);
+
+#endif // TCS3472X_TIMING_H
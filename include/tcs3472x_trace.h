@@ -0,0 +1,42 @@
+/**
+ * @file tcs3472x_trace.h
+ * @brief Optional USDT probe points for the TCS3472x driver.
+ *
+ * When TCS3472X_ENABLE_USDT is defined and <sys/sdt.h> (systemtap-sdt-dev) is available, every
+ * TCS3472X_TRACEn() macro becomes a USDT probe in the "tcs3472x" provider. An untraced probe is a
+ * single NOP, and the probe arguments are only evaluated into registers, so they must be cheap,
+ * side-effect free integer expressions. Without TCS3472X_ENABLE_USDT the macros expand to nothing.
+ *
+ * Probes:
+ * - i2c_start(is_read, length) / i2c_end(is_read, length, result): every HAL transfer.
+ * - group_start(nmsgs) / group_end(nmsgs, result): every I2C_RDWR transfer of a sensor group.
+ * - sample_ready(clear, red, green, blue): color data read by tcs3472x_get_all_colors_data().
+ * - config_change(reg_address, value): configuration register written by the driver.
+ * - error(reg_address): a driver operation on the given register failed.
+ *
+ * Example: bpftrace -e 'usdt:./build/tcs3472x_example:tcs3472x:i2c_end { @[arg0] = hist(arg1); }'
+ */
+
+#ifndef TCS3472X_TRACE_H
+#define TCS3472X_TRACE_H
+
+#if defined(TCS3472X_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TCS3472X_TRACE1(name, a) DTRACE_PROBE1(tcs3472x, name, a)
+#define TCS3472X_TRACE2(name, a, b) DTRACE_PROBE2(tcs3472x, name, a, b)
+#define TCS3472X_TRACE3(name, a, b, c) DTRACE_PROBE3(tcs3472x, name, a, b, c)
+#define TCS3472X_TRACE4(name, a, b, c, d) DTRACE_PROBE4(tcs3472x, name, a, b, c, d)
+#else
+#warning "TCS3472X_ENABLE_USDT is set but <sys/sdt.h> was not found, probes are disabled"
+#endif
+#endif
+
+#ifndef TCS3472X_TRACE1
+#define TCS3472X_TRACE1(name, a) do { } while (0)
+#define TCS3472X_TRACE2(name, a, b) do { } while (0)
+#define TCS3472X_TRACE3(name, a, b, c) do { } while (0)
+#define TCS3472X_TRACE4(name, a, b, c, d) do { } while (0)
+#endif
+
+#endif // TCS3472X_TRACE_H
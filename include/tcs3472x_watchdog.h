@@ -0,0 +1,102 @@
+/**
+ * @file tcs3472x_watchdog.h
+ * @brief Stuck-sensor and anomaly watchdog on the sample stream of the core driver.
+ *
+ * Every sample is checked in constant time against these stream conditions:
+ *
+ * - zero: all four channels zero for zero_limit samples in a row, typical after a brownout. A scene
+ *   dark enough to read zero trips it too, so set zero_limit to 0 where the sensor can see complete
+ *   darkness; a brownout then still shows up as DISABLED at the next register check.
+ * - frozen: the same four channel values for frozen_limit samples in a row, as seen when the sensor
+ *   stopped integrating.
+ * - implausible: the sum of red, green and blue outside a permille band of the clear count for
+ *   implausible_limit samples in a row.
+ *
+ * Samples below min_clear or with a saturated channel are judged by neither the frozen nor the
+ * implausible check, because a dim or clipped scene can repeat values and noise and clipping break
+ * the channel relation.
+ * - every check_interval samples, the ID register is compared with the expected ID and the PON and
+ *   AEN bits of ENABLE with the configuration cache; both reads go through the core driver.
+ *
+ * On a fault the watchdog restores the sensor with tcs3472x_restore_config() when auto_recover is
+ * set. The host must not read faster than the sensor integrates by more than frozen_limit − 1 reads
+ * per cycle, or repeated reads of one integration look frozen.
+ */
+
+#ifndef TCS3472X_WATCHDOG_H
+#define TCS3472X_WATCHDOG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Faults the watchdog reports.
+ */
+typedef enum {
+    TCS3472X_WATCHDOG_OK,           ///< No fault.
+    TCS3472X_WATCHDOG_FROZEN,       ///< Identical samples.
+    TCS3472X_WATCHDOG_ZERO,         ///< All-zero samples.
+    TCS3472X_WATCHDOG_IMPLAUSIBLE,  ///< Red, green and blue do not match clear.
+    TCS3472X_WATCHDOG_ID_CHANGED,   ///< ID register differs from the expected ID.
+    TCS3472X_WATCHDOG_DISABLED,     ///< PON or AEN cleared behind the driver's back.
+    TCS3472X_WATCHDOG_FAULT_COUNT,
+} tcs3472x_watchdog_fault_t;
+
+/**
+ * @brief Watchdog limits.
+ */
+typedef struct {
+    uint16_t frozen_limit;          ///< Identical samples in a row that count as frozen (at least 2).
+    uint16_t zero_limit;            ///< All-zero samples in a row that count as a fault, 0 to disable.
+    uint16_t implausible_limit;     ///< Implausible samples in a row that count as a fault (at least 1).
+    uint16_t min_clear;             ///< Clear count below which the channel relation is not judged.
+    uint16_t min_ratio_permille;    ///< Lowest plausible (R + G + B) / C in permille.
+    uint16_t max_ratio_permille;    ///< Highest plausible (R + G + B) / C in permille.
+    uint16_t check_interval;        ///< Samples between register checks, 0 to never read registers.
+    uint8_t auto_recover;           ///< Non-zero to call tcs3472x_restore_config() on a fault.
+} tcs3472x_watchdog_config_t;
+
+/**
+ * @brief Watchdog state.
+ */
+typedef struct {
+    tcs3472x_watchdog_config_t config;  ///< Limits the watchdog was initialized with.
+    uint16_t last[4];           ///< Previous sample.
+    uint16_t identical;         ///< Samples equal to their predecessor, in a row.
+    uint16_t implausible;       ///< Implausible samples in a row.
+    uint16_t until_check;       ///< Samples left until the next register check.
+    uint8_t expected_id;        ///< ID register value of a healthy sensor.
+    uint8_t has_last;           ///< Non-zero once last holds a sample.
+    uint32_t faults[TCS3472X_WATCHDOG_FAULT_COUNT]; ///< Faults seen, per kind.
+    uint32_t recoveries;        ///< Successful tcs3472x_restore_config() calls.
+    uint32_t failed_recoveries; ///< Failed tcs3472x_restore_config() calls.
+} tcs3472x_watchdog_t;
+
+/**
+ * @brief Fills limits suited to a sensor read about once per integration cycle.
+ *
+ * @param config Limits to fill: 8 zero, 8 identical or 4 implausible samples, a 250 to 2500
+ *               permille band above 64 clear counts, register checks every 50 samples and
+ *               automatic recovery.
+ */
+void tcs3472x_watchdog_config_default(tcs3472x_watchdog_config_t *config);
+
+/**
+ * @brief Initializes a watchdog.
+ *
+ * @param watchdog Watchdog to initialize.
+ * @param config Limits, copied into the watchdog.
+ * @param expected_id ID register value of the sensor, usually tcs3472x_get_id() after init.
+ */
+void tcs3472x_watchdog_init(tcs3472x_watchdog_t *watchdog, const tcs3472x_watchdog_config_t *config,
+                            uint8_t expected_id);
+
+/**
+ * @brief Checks one sample and recovers the sensor on a fault.
+ *
+ * @param watchdog Watchdog to update.
+ * @param colors Clear, red, green and blue data of the sample.
+ * @return The fault found, or TCS3472X_WATCHDOG_OK.
+ */
+tcs3472x_watchdog_fault_t tcs3472x_watchdog_feed(tcs3472x_watchdog_t *watchdog, const uint16_t colors[4]);
+
+#endif // TCS3472X_WATCHDOG_H
@@ -7,18 +7,13 @@
  * abstracts the I2C protocol to enable easy interactions with the TCS3472x sensor.
  */
 
-#include <stdio.h>
 #include "tcs3472x.h"
 #include "tcs3472x_i2c_hal.h"
-
-/**
- * Enum for command types used with the TCS3472x sensor.
- */
-typedef enum {
-    REPEAT_BYTE = 0b00,        ///< Command to repeat reading/writing the same register.
-    AUTO_INCREMENT = 0b01,     ///< Command to auto-increment register address on sequential reads/writes.
-    SPECIAL_FUNCTION = 0b11,   ///< Command for special functions, not typically used in standard operations.
-} command_type_t;
+#include "tcs3472x_trace.h"
+#include "tcs3472x_internal.h"
+#ifndef TCS3472X_MCU
+#include "tcs3472x_stats.h"
+#endif
 
 /**
  * Union to represent the command register structure, allowing manipulation of specific fields.
@@ -33,17 +28,23 @@ typedef union {
 } command_register_t;
 
 // Magic numbers from datasheet
-const float INTEGRATION_TIME_MULTIPLIER = 2.4f;
-const uint16_t INTEGRATION_TIME_CONST = 256;
-const uint16_t INTEGRATION_TIME_SPECIAL_CASE = 700;
+#define INTEGRATION_TIME_STEP_US        2400
+#define INTEGRATION_TIME_CONST          256
+#define INTEGRATION_TIME_SPECIAL_CASE_US 700000
 
 static command_register_t command_register;
+static tcs3472x_config_cache_t config_cache = {
+    .enable = 0,
+    .atime = ATIME_DEFAULT,
+    .wtime = WTIME_DEFAULT,
+    .config = CONFIG_DEFAULT,
+    .control = CONTROL_DEFAULT,
+    .ailt = 0,
+};
 
 // Function prototypes
 static uint16_t _get_color_data(uint8_t reg_address);
-float _calc_atime_in_milliseconds (uint8_t atime);
 void _write_command_register(uint8_t reg_address, command_type_t cmd_type);
-uint8_t _build_command_register(uint8_t reg_address, command_type_t cmd_type);
 
 /**
  * Writes a command to the command register of the TCS3472x sensor.
@@ -56,6 +57,7 @@ void _write_command_register(uint8_t reg_address, command_type_t cmd_type) {
     command_register.byte = _build_command_register(reg_address, cmd_type);
 
     if (tcs3472x_i2c_hal_write(&command_register.byte, 1) < 0) {
+        TCS3472X_TRACE1(error, reg_address);
         LOG_ERROR("Failed to write command register.\r\n");
     }
     LOG_DEBUG("reg_address = 0x%X\r\n", reg_address);
@@ -65,6 +67,7 @@ void _write_command_register(uint8_t reg_address, command_type_t cmd_type) {
 void tcs3472x_init(void) {
     enable_register_t enable_register;
 
+    enable_register.byte = 0;
     enable_register.bits.aien = 1;
     enable_register.bits.wen = 1;
     enable_register.bits.aen = 1;
@@ -73,8 +76,49 @@ void tcs3472x_init(void) {
     _write_command_register(ENABLE_REGISTER, REPEAT_BYTE);
 
     if (tcs3472x_i2c_hal_write(&enable_register.byte, 1) < 0) {
+        TCS3472X_TRACE1(error, ENABLE_REGISTER);
         LOG_ERROR("Failed to initialize TCS3472x sensor (set PON).\r\n");
+        return;
+    }
+    config_cache.enable = enable_register.byte;
+    TCS3472X_TRACE2(config_change, ENABLE_REGISTER, enable_register.byte);
+}
+
+int8_t tcs3472x_set_enable(uint8_t enable) {
+    uint8_t send_data[2] = {0};
+
+    send_data[0] = _build_command_register(ENABLE_REGISTER, REPEAT_BYTE);
+    send_data[1] = enable;
+
+    if (tcs3472x_i2c_hal_write(send_data, 2) < 0) {
+        TCS3472X_TRACE1(error, ENABLE_REGISTER);
+        LOG_ERROR("Failed to set ENABLE register.\r\n");
+        return -1;
     }
+    config_cache.enable = enable;
+    TCS3472X_TRACE2(config_change, ENABLE_REGISTER, enable);
+    return 0;
+}
+
+uint8_t tcs3472x_get_status(void) {
+    uint8_t status = 0;
+
+    _write_command_register(STATUS_REGISTER, REPEAT_BYTE);
+
+    if (tcs3472x_i2c_hal_read(&status, 1) < 0) {
+        TCS3472X_TRACE1(error, STATUS_REGISTER);
+        LOG_ERROR("Failed to read STATUS register.\r\n");
+        return 0;
+    }
+    return status;
+}
+
+const tcs3472x_config_cache_t *tcs3472x_get_config_cache(void) {
+    return &config_cache;
+}
+
+void tcs3472x_set_config_cache(const tcs3472x_config_cache_t *config) {
+    config_cache = *config;
 }
 
 uint8_t tcs3472x_get_enable(void) {
@@ -83,6 +127,7 @@ uint8_t tcs3472x_get_enable(void) {
     _write_command_register(ENABLE_REGISTER, REPEAT_BYTE);
 
     if (tcs3472x_i2c_hal_read(&enable, 1) < 0) {
+        TCS3472X_TRACE1(error, ENABLE_REGISTER);
         LOG_ERROR("Failed to read ENABLE register.\r\n");
         return 0;
     }
@@ -95,26 +140,16 @@ uint8_t tcs3472x_get_id(void) {
 	_write_command_register(ID_REGISTER, REPEAT_BYTE);
 
     if (tcs3472x_i2c_hal_read(&id, 1) < 0) {
+        TCS3472X_TRACE1(error, ID_REGISTER);
         LOG_ERROR("Failed to read ID register.\r\n");
         return 0;
     }
     return id;
 }
 
-float tcs3472x_set_atime(float integration_time) {
-	const float MAX_INTEGRATION_TIME_ALLOWED = INTEGRATION_TIME_CONST * INTEGRATION_TIME_MULTIPLIER; // 614.4 milliseconds
-	uint8_t atime_reg = 0;
-	uint8_t send_data[2] = {0};
-	float actual_integration_time = 0;
-
-	if(integration_time >= MAX_INTEGRATION_TIME_ALLOWED) {
-		atime_reg = 0x00;
-		actual_integration_time = INTEGRATION_TIME_SPECIAL_CASE;
-	}
-	else {
-		atime_reg = INTEGRATION_TIME_CONST - (integration_time / INTEGRATION_TIME_MULTIPLIER);
-		actual_integration_time = _calc_atime_in_milliseconds(atime_reg);
-	}
+int32_t tcs3472x_set_atime_us(uint32_t integration_time_us) {
+    uint8_t atime_reg = tcs3472x_us_to_atime(integration_time_us);
+    uint8_t send_data[2] = {0};
 
     command_register.byte = _build_command_register(ATIME_REGISTER, REPEAT_BYTE);
 
@@ -122,38 +157,108 @@ float tcs3472x_set_atime(float integration_time) {
     send_data[1] = atime_reg;
 
     if (tcs3472x_i2c_hal_write(send_data, 2) < 0) {
+        TCS3472X_TRACE1(error, ATIME_REGISTER);
         LOG_ERROR("Failed to set ATIME register.\r\n");
         return -1;
     }
+    config_cache.atime = atime_reg;
+    TCS3472X_TRACE2(config_change, ATIME_REGISTER, atime_reg);
 
-	// Returns actual value of atime in milliseconds
-	return actual_integration_time;
+    // Returns actual value of atime in microseconds
+    return tcs3472x_atime_to_us(atime_reg);
 }
 
-float tcs3472x_get_atime(void) {
+int32_t tcs3472x_get_atime_us(void) {
+    uint8_t atime_reg = 0;
 
-	uint8_t atime_reg = 0;
-	float atime_ms = 0;
-
-	_write_command_register(ATIME_REGISTER, REPEAT_BYTE);
+    _write_command_register(ATIME_REGISTER, REPEAT_BYTE);
 
     if (tcs3472x_i2c_hal_read(&atime_reg, 1) < 0) {
+        TCS3472X_TRACE1(error, ATIME_REGISTER);
         LOG_ERROR("Failed to read ATIME register.\r\n");
         return -1;
     }
+    return tcs3472x_atime_to_us(atime_reg);
+}
 
+int32_t tcs3472x_atime_to_us(uint8_t atime) {
     // Special case according to datasheet
-    if (atime_reg == 0) {
-    	atime_ms = INTEGRATION_TIME_SPECIAL_CASE;
+    if (atime == 0) {
+        return INTEGRATION_TIME_SPECIAL_CASE_US;
     }
-    // Calculate the integration time in milliseconds
-    else {
-    	atime_ms = _calc_atime_in_milliseconds(atime_reg);
+    return (INTEGRATION_TIME_CONST - atime) * INTEGRATION_TIME_STEP_US;
+}
+
+uint8_t tcs3472x_us_to_atime(uint32_t integration_time_us) {
+    const uint32_t MAX_INTEGRATION_TIME_ALLOWED_US = INTEGRATION_TIME_CONST * INTEGRATION_TIME_STEP_US; // 614.4 milliseconds
+    uint32_t steps = 0;
+
+    if (integration_time_us >= MAX_INTEGRATION_TIME_ALLOWED_US) {
+        return 0x00;
+    }
+
+    steps = (integration_time_us + INTEGRATION_TIME_STEP_US - 1) / INTEGRATION_TIME_STEP_US;
+    if (steps == 0) {
+        steps = 1;
+    }
+    return INTEGRATION_TIME_CONST - steps;
+}
+
+int8_t tcs3472x_set_wtime(uint8_t wtime) {
+    if (_write_register(WTIME_REGISTER, wtime) < 0) {
+        LOG_ERROR("Failed to set WTIME register.\r\n");
+        return -1;
     }
-    return atime_ms;
+    config_cache.wtime = wtime;
+    return 0;
 }
 
-uint8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value) {
+int8_t tcs3472x_set_wlong(uint8_t wlong) {
+    uint8_t config = wlong ? CONFIG_WLONG : 0;
+
+    if (_write_register(CONFIG_REGISTER, config) < 0) {
+        LOG_ERROR("Failed to set CONFIG register.\r\n");
+        return -1;
+    }
+    config_cache.config = config;
+    return 0;
+}
+
+int8_t tcs3472x_set_gain(uint8_t again) {
+    if (again > CONTROL_AGAIN_60X) {
+        LOG_ERROR("Invalid gain value %u.\r\n", again);
+        return -1;
+    }
+    if (_write_register(CONTROL_REGISTER, again) < 0) {
+        LOG_ERROR("Failed to set CONTROL register.\r\n");
+        return -1;
+    }
+    config_cache.control = again;
+    return 0;
+}
+
+#ifndef TCS3472X_MCU
+float tcs3472x_set_atime(float integration_time) {
+	int32_t actual_us = 0;
+
+	if (integration_time < 0) {
+		integration_time = 0;
+	}
+
+	actual_us = tcs3472x_set_atime_us((uint32_t)(integration_time * 1000.0f));
+
+	// Returns actual value of atime in milliseconds
+	return actual_us < 0 ? -1 : actual_us / 1000.0f;
+}
+
+float tcs3472x_get_atime(void) {
+	int32_t atime_us = tcs3472x_get_atime_us();
+
+	return atime_us < 0 ? -1 : atime_us / 1000.0f;
+}
+#endif // TCS3472X_MCU
+
+int8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value) {
 	uint8_t send_data[2] = {0};
 	uint8_t lower_byte = 0, upper_byte = 0;
 	lower_byte = value & 0x00FF;
@@ -166,9 +271,11 @@ uint8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value) {
     send_data[1] = lower_byte;
 
     if (tcs3472x_i2c_hal_write(send_data, 2) < 0) {
+        TCS3472X_TRACE1(error, AILTL_REGISTER);
         LOG_ERROR("Failed to set AILTL register.\r\n");
         return -1;
     }
+    TCS3472X_TRACE2(config_change, AILTL_REGISTER, lower_byte);
 
 	command_register.byte = _build_command_register(AILTH_REGISTER, REPEAT_BYTE);
 
@@ -176,26 +283,31 @@ uint8_t tcs3472x_set_isr_threshold_reg_low(uint16_t value) {
     send_data[1] = upper_byte;
 
     if (tcs3472x_i2c_hal_write(send_data, 2) < 0) {
+        TCS3472X_TRACE1(error, AILTH_REGISTER);
         LOG_ERROR("Failed to set AILTH register.\r\n");
         return -1;
     }
+    TCS3472X_TRACE2(config_change, AILTH_REGISTER, upper_byte);
+    config_cache.ailt = value;
+    return 0;
 }
 
-void tcs3472x_get_all_colors_data(uint16_t *buff) {
+int8_t tcs3472x_get_all_colors_data(uint16_t *buff) {
+    uint8_t command = _build_command_register(CDATAL_REGISTER, AUTO_INCREMENT);
     uint8_t data[8] = {0};  // 2 bytes for each color (clear, red, green, blue)
-    uint16_t combined_data = 0;
 
-    _write_command_register(CDATAL_REGISTER, AUTO_INCREMENT);
-    tcs3472x_i2c_hal_read(data, sizeof(data));
+    if (tcs3472x_i2c_hal_write_read(&command, 1, data, sizeof(data)) < 0) {
+        TCS3472X_TRACE1(error, CDATAL_REGISTER);
+        LOG_ERROR("Failed to read color data registers.\r\n");
+        return -1;
+    }
+    _unpack_colors(data, buff);
 
-    combined_data = (data[1] << 8) | data[0];
-    buff[0] = combined_data;
-    combined_data = (data[3] << 8) | data[2];
-    buff[1] = combined_data;
-    combined_data = (data[5] << 8) | data[4];
-    buff[2] = combined_data;
-    combined_data = (data[7] << 8) | data[6];
-    buff[3] = combined_data;
+    TCS3472X_TRACE4(sample_ready, buff[0], buff[1], buff[2], buff[3]);
+#ifndef TCS3472X_MCU
+    tcs3472x_stats_record_sample(tcs3472x_get_stats(), buff[0], config_cache.atime);
+#endif
+    return 0;
 }
 
 uint16_t tcs3472x_get_clear_data(void) {
@@ -222,8 +334,26 @@ uint8_t _build_command_register(uint8_t reg_address, command_type_t cmd_type) {
     return command_register.byte;
 }
 
-float _calc_atime_in_milliseconds(uint8_t atime) {
-	return (INTEGRATION_TIME_CONST-atime) * INTEGRATION_TIME_MULTIPLIER;
+int8_t _write_register(uint8_t reg_address, uint8_t value) {
+    uint8_t send_data[2] = {0};
+
+    send_data[0] = _build_command_register(reg_address, REPEAT_BYTE);
+    send_data[1] = value;
+
+    if (tcs3472x_i2c_hal_write(send_data, 2) < 0) {
+        TCS3472X_TRACE1(error, reg_address);
+        return -1;
+    }
+    TCS3472X_TRACE2(config_change, reg_address, value);
+    return 0;
+}
+
+void _unpack_colors(const uint8_t *data, uint16_t *buff) {
+    uint8_t c = 0;
+
+    for (c = 0; c < 4; c++) {
+        buff[c] = (uint16_t)((data[2 * c + 1] << 8) | data[2 * c]);
+    }
 }
 
 /**
@@ -0,0 +1,233 @@
+/**
+ * @file tcs3472x_async.c
+ * @brief Non-blocking TCS3472x operations running on the asynchronous I2C HAL.
+ *
+ * This file implements the functions declared in tcs3472x_async.h. A register write is a single
+ * transfer of command byte and value, or of command byte and both bytes of a 16-bit threshold. A register read is a command byte write followed by a read,
+ * each started from the completion callback of the previous transfer.
+ */
+
+#include <stddef.h>
+
+#include "tcs3472x_async.h"
+#include "tcs3472x_i2c_hal_async.h"
+#include "tcs3472x_trace.h"
+
+/**
+ * Operations of the state machine.
+ */
+typedef enum {
+    OP_NONE = 0,        ///< Idle.
+    OP_WRITE_REGISTER,  ///< Write tx[1], or tx[1] and tx[2] for a threshold, starting at one register.
+    OP_READ_REGISTER,   ///< Read one register into value.
+    OP_READ_COLORS,     ///< Read the eight data registers into colors.
+} async_op_t;
+
+/**
+ * Transfers of a read operation.
+ */
+typedef enum {
+    STEP_COMMAND = 0,   ///< Command byte write selecting the register.
+    STEP_DATA,          ///< Data transfer.
+} async_step_t;
+
+static int8_t _start_write(tcs3472x_async_t *dev, uint8_t command, uint16_t value, uint16_t length,
+                           tcs3472x_async_done_t done, void *context);
+static int8_t _start_read(tcs3472x_async_t *dev, async_op_t op, uint8_t command,
+                          tcs3472x_async_done_t done, void *context);
+static void _on_transfer(void *context, int8_t result);
+static void _finish(tcs3472x_async_t *dev, int8_t result);
+
+void tcs3472x_async_init(tcs3472x_async_t *dev) {
+    dev->config.enable = 0;
+    dev->config.atime = ATIME_DEFAULT;
+    dev->config.wtime = WTIME_DEFAULT;
+    dev->config.config = CONFIG_DEFAULT;
+    dev->config.control = CONTROL_DEFAULT;
+    dev->config.ailt = 0;
+    dev->op = OP_NONE;
+    dev->step = STEP_COMMAND;
+    dev->colors = NULL;
+    dev->value = NULL;
+    dev->done = NULL;
+    dev->context = NULL;
+}
+
+uint8_t tcs3472x_async_busy(const tcs3472x_async_t *dev) {
+    return dev->op != OP_NONE;
+}
+
+int8_t tcs3472x_async_set_enable(tcs3472x_async_t *dev, uint8_t enable, tcs3472x_async_done_t done,
+                                 void *context) {
+    return _start_write(dev, COMMAND_BIT | ENABLE_REGISTER, enable, 2, done, context);
+}
+
+int8_t tcs3472x_async_set_atime(tcs3472x_async_t *dev, uint8_t atime, tcs3472x_async_done_t done,
+                                void *context) {
+    return _start_write(dev, COMMAND_BIT | ATIME_REGISTER, atime, 2, done, context);
+}
+
+int8_t tcs3472x_async_set_wtime(tcs3472x_async_t *dev, uint8_t wtime, tcs3472x_async_done_t done,
+                                void *context) {
+    return _start_write(dev, COMMAND_BIT | WTIME_REGISTER, wtime, 2, done, context);
+}
+
+int8_t tcs3472x_async_set_wlong(tcs3472x_async_t *dev, uint8_t wlong, tcs3472x_async_done_t done,
+                                void *context) {
+    return _start_write(dev, COMMAND_BIT | CONFIG_REGISTER, wlong ? CONFIG_WLONG : 0, 2, done, context);
+}
+
+int8_t tcs3472x_async_set_gain(tcs3472x_async_t *dev, uint8_t again, tcs3472x_async_done_t done,
+                               void *context) {
+    if (again > CONTROL_AGAIN_60X) {
+        LOG_ERROR("Invalid gain value %u.\r\n", again);
+        return -1;
+    }
+    return _start_write(dev, COMMAND_BIT | CONTROL_REGISTER, again, 2, done, context);
+}
+
+int8_t tcs3472x_async_set_isr_threshold_low(tcs3472x_async_t *dev, uint16_t value, tcs3472x_async_done_t done,
+                                            void *context) {
+    return _start_write(dev, COMMAND_BIT | COMMAND_AUTO_INCREMENT | AILTL_REGISTER, value, 3, done, context);
+}
+
+int8_t tcs3472x_async_get_status(tcs3472x_async_t *dev, uint8_t *status, tcs3472x_async_done_t done,
+                                 void *context) {
+    if (dev->op != OP_NONE) {
+        return -1;
+    }
+    dev->value = status;
+    return _start_read(dev, OP_READ_REGISTER, COMMAND_BIT | STATUS_REGISTER, done, context);
+}
+
+int8_t tcs3472x_async_get_all_colors_data(tcs3472x_async_t *dev, uint16_t *colors,
+                                          tcs3472x_async_done_t done, void *context) {
+    if (dev->op != OP_NONE) {
+        return -1;
+    }
+    dev->colors = colors;
+    return _start_read(dev, OP_READ_COLORS, COMMAND_BIT | COMMAND_AUTO_INCREMENT | CDATAL_REGISTER,
+                       done, context);
+}
+
+/**
+ * Starts a single-transfer register write of the low byte of value, or of both bytes if length is 3.
+ */
+static int8_t _start_write(tcs3472x_async_t *dev, uint8_t command, uint16_t value, uint16_t length,
+                           tcs3472x_async_done_t done, void *context) {
+    if (dev->op != OP_NONE) {
+        return -1;
+    }
+
+    dev->op = OP_WRITE_REGISTER;
+    dev->step = STEP_DATA;
+    dev->reg_address = command & 0x1F;
+    dev->tx[0] = command;
+    dev->tx[1] = value & 0x00FF;
+    dev->tx[2] = (value >> 8) & 0x00FF;
+    dev->done = done;
+    dev->context = context;
+
+    if (tcs3472x_i2c_hal_async_write(dev->tx, length, _on_transfer, dev) < 0) {
+        TCS3472X_TRACE1(error, dev->reg_address);
+        LOG_ERROR("Failed to start register write.\r\n");
+        dev->op = OP_NONE;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Starts a read by writing its command byte; the data transfer follows from _on_transfer().
+ */
+static int8_t _start_read(tcs3472x_async_t *dev, async_op_t op, uint8_t command,
+                          tcs3472x_async_done_t done, void *context) {
+    dev->op = op;
+    dev->step = STEP_COMMAND;
+    dev->reg_address = command & 0x1F;
+    dev->tx[0] = command;
+    dev->done = done;
+    dev->context = context;
+
+    if (tcs3472x_i2c_hal_async_write(dev->tx, 1, _on_transfer, dev) < 0) {
+        TCS3472X_TRACE1(error, dev->reg_address);
+        LOG_ERROR("Failed to start command register write.\r\n");
+        dev->op = OP_NONE;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * HAL completion callback: advances the operation in progress by one transfer.
+ */
+static void _on_transfer(void *context, int8_t result) {
+    tcs3472x_async_t *dev = context;
+    uint16_t length = 0;
+
+    if (result < 0) {
+        TCS3472X_TRACE1(error, dev->reg_address);
+        LOG_ERROR("Asynchronous transfer failed.\r\n");
+        _finish(dev, -1);
+        return;
+    }
+
+    if (dev->step == STEP_COMMAND) {
+        dev->step = STEP_DATA;
+        length = dev->op == OP_READ_COLORS ? sizeof(dev->rx) : 1;
+        if (tcs3472x_i2c_hal_async_read(dev->rx, length, _on_transfer, dev) < 0) {
+            TCS3472X_TRACE1(error, dev->reg_address);
+            LOG_ERROR("Failed to start data read.\r\n");
+            _finish(dev, -1);
+        }
+        return;
+    }
+
+    if (dev->op == OP_WRITE_REGISTER) {
+        if (dev->reg_address == ENABLE_REGISTER) {
+            dev->config.enable = dev->tx[1];
+        }
+        else if (dev->reg_address == ATIME_REGISTER) {
+            dev->config.atime = dev->tx[1];
+        }
+        else if (dev->reg_address == WTIME_REGISTER) {
+            dev->config.wtime = dev->tx[1];
+        }
+        else if (dev->reg_address == CONFIG_REGISTER) {
+            dev->config.config = dev->tx[1];
+        }
+        else if (dev->reg_address == CONTROL_REGISTER) {
+            dev->config.control = dev->tx[1];
+        }
+        else if (dev->reg_address == AILTL_REGISTER) {
+            dev->config.ailt = (uint16_t)((dev->tx[2] << 8) | dev->tx[1]);
+        }
+        TCS3472X_TRACE2(config_change, dev->reg_address, dev->tx[1]);
+    }
+    else if (dev->op == OP_READ_REGISTER) {
+        *dev->value = dev->rx[0];
+    }
+    else {
+        dev->colors[0] = (dev->rx[1] << 8) | dev->rx[0];
+        dev->colors[1] = (dev->rx[3] << 8) | dev->rx[2];
+        dev->colors[2] = (dev->rx[5] << 8) | dev->rx[4];
+        dev->colors[3] = (dev->rx[7] << 8) | dev->rx[6];
+        TCS3472X_TRACE4(sample_ready, dev->colors[0], dev->colors[1], dev->colors[2], dev->colors[3]);
+    }
+
+    _finish(dev, 0);
+}
+
+/**
+ * Returns the state machine to idle before calling the done callback, so it can start the next
+ * operation.
+ */
+static void _finish(tcs3472x_async_t *dev, int8_t result) {
+    tcs3472x_async_done_t done = dev->done;
+    void *context = dev->context;
+
+    dev->op = OP_NONE;
+    if (done) {
+        done(context, result);
+    }
+}
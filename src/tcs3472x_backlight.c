@@ -0,0 +1,137 @@
+/**
+ * @file tcs3472x_backlight.c
+ * @brief Closed-loop display backlight controller driven by TCS3472x samples.
+ *
+ * This file implements the functions declared in tcs3472x_backlight.h using integer arithmetic only.
+ * The logarithmic mapping uses a base 2 logarithm in 16.16 fixed point.
+ */
+
+#include <stddef.h>
+#include "tcs3472x_backlight.h"
+
+#define LOG2_FRACTION_BITS  16
+#define NS_PER_SEC          1000000000LL
+
+static uint32_t _log2_q16(uint32_t x);
+static int8_t _write_level(tcs3472x_backlight_t *backlight, uint32_t level, int64_t now_ns);
+
+int8_t tcs3472x_backlight_init(tcs3472x_backlight_t *backlight, const tcs3472x_backlight_config_t *config) {
+    if (config->min_mlux == 0 || config->min_mlux >= config->max_mlux ||
+        config->min_level > config->max_level || config->output == NULL) {
+        return -1;
+    }
+
+    backlight->config = *config;
+    backlight->anchor_mlux = 0;
+    backlight->target = config->min_level;
+    backlight->level = config->min_level;
+    backlight->moved_ns = 0;
+    backlight->writes = 0;
+    backlight->started = 0;
+    return 0;
+}
+
+uint32_t tcs3472x_backlight_map(const tcs3472x_backlight_config_t *config, uint32_t mlux) {
+    uint32_t log_min = 0, log_max = 0;
+
+    if (mlux <= config->min_mlux) {
+        return config->min_level;
+    }
+    if (mlux >= config->max_mlux) {
+        return config->max_level;
+    }
+
+    log_min = _log2_q16(config->min_mlux);
+    log_max = _log2_q16(config->max_mlux);
+    return config->min_level + (uint32_t)((uint64_t)(config->max_level - config->min_level) *
+                                          (_log2_q16(mlux) - log_min) / (log_max - log_min));
+}
+
+int8_t tcs3472x_backlight_update_lux(tcs3472x_backlight_t *backlight, uint32_t mlux, int64_t now_ns) {
+    const tcs3472x_backlight_config_t *config = &backlight->config;
+    uint64_t band = (uint64_t)backlight->anchor_mlux * config->hysteresis_permille / 1000;
+    uint64_t allowed = 0;
+    uint32_t level = 0;
+
+    if (!backlight->started) {
+        backlight->anchor_mlux = mlux;
+        backlight->target = tcs3472x_backlight_map(config, mlux);
+        return _write_level(backlight, backlight->target, now_ns);
+    }
+
+    if ((uint64_t)mlux > backlight->anchor_mlux + band || (uint64_t)mlux + band < backlight->anchor_mlux) {
+        backlight->anchor_mlux = mlux;
+        backlight->target = tcs3472x_backlight_map(config, mlux);
+    }
+
+    if (backlight->level == backlight->target) {
+        backlight->moved_ns = now_ns;
+        return 0;
+    }
+
+    level = backlight->target;
+    if (config->max_levels_per_s != 0) {
+        // Time since the last change accumulates until it allows at least one level
+        allowed = (uint64_t)config->max_levels_per_s * (uint64_t)(now_ns - backlight->moved_ns) / NS_PER_SEC;
+        if (allowed == 0) {
+            return 0;
+        }
+        if (backlight->target > backlight->level && backlight->target - backlight->level > allowed) {
+            level = backlight->level + (uint32_t)allowed;
+        }
+        else if (backlight->target < backlight->level && backlight->level - backlight->target > allowed) {
+            level = backlight->level - (uint32_t)allowed;
+        }
+    }
+    return _write_level(backlight, level, now_ns);
+}
+
+int8_t tcs3472x_backlight_update(tcs3472x_backlight_t *backlight, const uint16_t colors[4], uint8_t atime,
+                                 uint8_t again, int64_t now_ns) {
+    uint32_t mlux = tcs3472x_lux_mlux(&backlight->config.lux, colors, atime, again);
+
+    // A saturated sample is at least as bright as the top of the range
+    if (mlux == TCS3472X_LUX_SATURATED) {
+        mlux = backlight->config.max_mlux;
+    }
+    return tcs3472x_backlight_update_lux(backlight, mlux, now_ns);
+}
+
+/**
+ * Writes a level to the output and records it.
+ *
+ * @return 1 on success, -1 if the output failed.
+ */
+static int8_t _write_level(tcs3472x_backlight_t *backlight, uint32_t level, int64_t now_ns) {
+    if (backlight->config.output(backlight->config.context, level) < 0) {
+        return -1;
+    }
+    backlight->level = level;
+    backlight->moved_ns = now_ns;
+    backlight->writes++;
+    backlight->started = 1;
+    return 1;
+}
+
+/**
+ * Computes log2(x) in 16.16 fixed point for x > 0.
+ */
+static uint32_t _log2_q16(uint32_t x) {
+    uint32_t integer = 0, result = 0, bit = 0;
+    uint64_t mantissa = 0;
+
+    while ((x >> integer) > 1) {
+        integer++;
+    }
+
+    // Normalize to [1, 2) in 16.16, then square repeatedly to extract fraction bits
+    mantissa = ((uint64_t)x << LOG2_FRACTION_BITS) >> integer;
+    for (bit = 1u << (LOG2_FRACTION_BITS - 1); bit != 0; bit >>= 1) {
+        mantissa = (mantissa * mantissa) >> LOG2_FRACTION_BITS;
+        if (mantissa >= (2u << LOG2_FRACTION_BITS)) {
+            mantissa >>= 1;
+            result |= bit;
+        }
+    }
+    return (integer << LOG2_FRACTION_BITS) | result;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file tcs3472x_batch.c
+ * @brief Multi-register operations of the TCS3472x driver.
+ *
+ * This file implements the whole-configuration write, the integration restart and the combined
+ * status and data read declared in tcs3472x.h. They live apart from the core driver so that
+ * microcontroller builds which only need the single-register functions do not carry them.
+ */
+
+#include "tcs3472x.h"
+#include "tcs3472x_i2c_hal.h"
+#include "tcs3472x_trace.h"
+#include "tcs3472x_internal.h"
+#ifndef TCS3472X_MCU
+#include "tcs3472x_stats.h"
+#endif
+
+int8_t tcs3472x_apply_config(const tcs3472x_config_cache_t *config) {
+    uint8_t send_data[4] = {0};
+
+    send_data[0] = _build_command_register(WTIME_REGISTER, AUTO_INCREMENT);
+    send_data[1] = config->wtime;
+    send_data[2] = config->ailt & 0x00FF;
+    send_data[3] = (config->ailt >> 8) & 0x00FF;
+
+    if (_write_register(ATIME_REGISTER, config->atime) < 0 ||
+        tcs3472x_i2c_hal_write(send_data, sizeof(send_data)) < 0 ||
+        _write_register(CONFIG_REGISTER, config->config) < 0 ||
+        _write_register(CONTROL_REGISTER, config->control) < 0 ||
+        _write_register(ENABLE_REGISTER, config->enable) < 0) {
+        LOG_ERROR("Failed to apply configuration registers.\r\n");
+        return -1;
+    }
+    tcs3472x_set_config_cache(config);
+    return 0;
+}
+
+int8_t tcs3472x_restore_config(void) {
+    tcs3472x_config_cache_t config = *tcs3472x_get_config_cache();
+
+    return tcs3472x_apply_config(&config);
+}
+
+int8_t tcs3472x_restart_integration(void) {
+    tcs3472x_config_cache_t config = *tcs3472x_get_config_cache();
+    uint8_t send_data[3] = {0};
+
+    // Repeated byte protocol: both values go to ENABLE within one transaction
+    send_data[0] = _build_command_register(ENABLE_REGISTER, REPEAT_BYTE);
+    send_data[1] = (config.enable | ENABLE_PON) & ~ENABLE_AEN;
+    send_data[2] = config.enable | ENABLE_PON | ENABLE_AEN;
+
+    if (tcs3472x_i2c_hal_write(send_data, sizeof(send_data)) < 0) {
+        TCS3472X_TRACE1(error, ENABLE_REGISTER);
+        LOG_ERROR("Failed to restart the integration cycle.\r\n");
+        return -1;
+    }
+    config.enable = send_data[2];
+    tcs3472x_set_config_cache(&config);
+    TCS3472X_TRACE2(config_change, ENABLE_REGISTER, send_data[2]);
+    return 0;
+}
+
+int8_t tcs3472x_get_status_colors(uint8_t *status, uint16_t *buff) {
+    uint8_t command = _build_command_register(STATUS_REGISTER, AUTO_INCREMENT);
+    uint8_t data[9] = {0};  // STATUS, then 2 bytes for each color
+
+    if (tcs3472x_i2c_hal_write_read(&command, 1, data, sizeof(data)) < 0) {
+        TCS3472X_TRACE1(error, STATUS_REGISTER);
+        LOG_ERROR("Failed to read status and color data registers.\r\n");
+        return -1;
+    }
+    *status = data[0];
+    _unpack_colors(&data[1], buff);
+
+    TCS3472X_TRACE4(sample_ready, buff[0], buff[1], buff[2], buff[3]);
+#ifndef TCS3472X_MCU
+    // Polls that find AVALID clear return no new sample
+    if (*status & STATUS_AVALID) {
+        tcs3472x_stats_record_sample(tcs3472x_get_stats(), buff[0], tcs3472x_get_config_cache()->atime);
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file tcs3472x_bus_cost.c
+ * @brief Bus time cost model and capacity planner for the TCS3472x driver.
+ *
+ * This file implements the functions declared in tcs3472x_bus_cost.h. The traffic table mirrors what
+ * src/tcs3472x.c and the group functions actually put on the bus and must be kept in sync with them.
+ */
+
+#include <stddef.h>
+#include "tcs3472x_bus_cost.h"
+
+#define BYTE_BIT_TIMES      9   ///< 8 data bits plus acknowledge
+#define START_BIT_TIMES     1   ///< START or repeated START condition
+#define STOP_BIT_TIMES      1   ///< STOP condition
+
+// Bus free time minimums from the I2C specification
+#define STANDARD_MODE_BUS_FREE_NS   4700
+#define FAST_MODE_BUS_FREE_NS       1300
+#define FAST_MODE_PLUS_BUS_FREE_NS  500
+
+static const tcs3472x_bus_ops_t bus_ops[TCS3472X_BUS_OP_COUNT] = {
+    // Command byte and ENABLE value are written as two separate transactions
+    [TCS3472X_BUS_OP_INIT]                  = { .transactions = 2, .messages = 2, .bytes = 2 },
+    // Command byte write, then a separate 1 byte read
+    [TCS3472X_BUS_OP_GET_ENABLE]            = { .transactions = 2, .messages = 2, .bytes = 2 },
+    [TCS3472X_BUS_OP_GET_ID]                = { .transactions = 2, .messages = 2, .bytes = 2 },
+    [TCS3472X_BUS_OP_GET_ATIME]             = { .transactions = 2, .messages = 2, .bytes = 2 },
+    // Command byte and value in one write
+    [TCS3472X_BUS_OP_SET_ATIME]             = { .transactions = 1, .messages = 1, .bytes = 2 },
+    // One write per threshold byte
+    [TCS3472X_BUS_OP_SET_ISR_THRESHOLD_LOW] = { .transactions = 2, .messages = 2, .bytes = 4 },
+    // Command byte write, then a data read after a repeated START
+    [TCS3472X_BUS_OP_GET_ALL_COLORS]        = { .transactions = 1, .messages = 2, .bytes = 9 },
+    [TCS3472X_BUS_OP_GET_STATUS_COLORS]     = { .transactions = 1, .messages = 2, .bytes = 10 },
+    // Command byte write, then a separate data read
+    [TCS3472X_BUS_OP_GET_COLOR]             = { .transactions = 2, .messages = 2, .bytes = 3 },
+    // ATIME, WTIME with AILTL/AILTH, CONFIG, CONTROL and ENABLE, one write each
+    [TCS3472X_BUS_OP_APPLY_CONFIG]          = { .transactions = 5, .messages = 5, .bytes = 12 },
+    // Command byte and two ENABLE values in one repeated byte write
+    [TCS3472X_BUS_OP_RESTART_INTEGRATION]   = { .transactions = 1, .messages = 1, .bytes = 3 },
+    // I2C_RDWR message sets, costed as if the sensor were alone on the bus
+    [TCS3472X_BUS_OP_GROUP_CONFIGURE]       = { .transactions = 1, .messages = 2, .bytes = 4 },
+    [TCS3472X_BUS_OP_GROUP_START]           = { .transactions = 1, .messages = 2, .bytes = 4 },
+    [TCS3472X_BUS_OP_GROUP_READ]            = { .transactions = 1, .messages = 2, .bytes = 9 },
+};
+
+void tcs3472x_bus_config_default(tcs3472x_bus_config_t *config, uint32_t bus_hz) {
+    config->bus_hz = bus_hz;
+    config->overhead_ns = 0;
+
+    if (bus_hz <= TCS3472X_BUS_STANDARD_MODE_HZ) {
+        config->bus_free_ns = STANDARD_MODE_BUS_FREE_NS;
+    }
+    else if (bus_hz <= TCS3472X_BUS_FAST_MODE_HZ) {
+        config->bus_free_ns = FAST_MODE_BUS_FREE_NS;
+    }
+    else {
+        config->bus_free_ns = FAST_MODE_PLUS_BUS_FREE_NS;
+    }
+}
+
+const tcs3472x_bus_ops_t *tcs3472x_bus_cost_ops(tcs3472x_bus_op_t op) {
+    if (op >= TCS3472X_BUS_OP_COUNT) {
+        return NULL;
+    }
+    return &bus_ops[op];
+}
+
+uint32_t tcs3472x_bus_cost_ns(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op) {
+    const tcs3472x_bus_ops_t *ops = tcs3472x_bus_cost_ops(op);
+    uint32_t bit_times = 0;
+
+    if (ops == NULL || config->bus_hz == 0) {
+        return 0;
+    }
+
+    bit_times = ops->messages * (START_BIT_TIMES + BYTE_BIT_TIMES)  // (repeated) START and address
+              + ops->bytes * BYTE_BIT_TIMES
+              + ops->transactions * STOP_BIT_TIMES;
+
+    return (uint32_t)((uint64_t)bit_times * 1000000000ULL / config->bus_hz)
+         + ops->transactions * (config->bus_free_ns + config->overhead_ns);
+}
+
+uint32_t tcs3472x_bus_occupancy_ppm(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op,
+                                    uint32_t rate_mhz) {
+    // cost_ns * rate_mhz / 1e12 is the busy fraction, times 1e6 for parts per million
+    return (uint32_t)(((uint64_t)tcs3472x_bus_cost_ns(config, op) * rate_mhz + 999999) / 1000000);
+}
+
+uint32_t tcs3472x_bus_max_sensors(const tcs3472x_bus_config_t *config, tcs3472x_bus_op_t op,
+                                  uint32_t rate_mhz, uint32_t limit_ppm) {
+    uint32_t per_sensor_ppm = tcs3472x_bus_occupancy_ppm(config, op, rate_mhz);
+
+    if (per_sensor_ppm == 0) {
+        return 0;
+    }
+    return limit_ppm / per_sensor_ppm;
+}
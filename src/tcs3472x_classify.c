@@ -0,0 +1,123 @@
+/**
+ * @file tcs3472x_classify.c
+ * @brief Light-source classification from channel ratios.
+ *
+ * This file implements the functions declared in tcs3472x_classify.h using integer arithmetic only.
+ */
+
+#include <stddef.h>
+#include "tcs3472x_classify.h"
+
+#define DEFAULT_MIN_CLEAR       64
+#define DEFAULT_SWITCH_COUNT    3
+#define FEATURE_MAX             2047
+#define RECIPROCAL_BITS         26      ///< 2^26 / C leaves 16 bits to shift out after multiplying
+
+/**
+ * Centroids of the channel model: visible red, green and blue shares and an IR share relative to the
+ * visible light, the same IR count added to every channel.
+ */
+static const uint16_t default_centroids[TCS3472X_LIGHT_COUNT][TCS3472X_CLASSIFY_FEATURES] = {
+    [TCS3472X_LIGHT_UNKNOWN]        = {    0,   0,   0,   0 },
+    [TCS3472X_LIGHT_DAYLIGHT]       = {  411, 439, 393, 110 },  // 33/36/31 %, IR 12 %
+    [TCS3472X_LIGHT_INCANDESCENT]   = {  704, 595, 493, 384 },  // 50/33/17 %, IR 60 %
+    [TCS3472X_LIGHT_FLUORESCENT]    = {  341, 442, 281,  20 },  // 32/42/26 %, IR 2 %
+    [TCS3472X_LIGHT_LED]            = {  345, 385, 314,  10 },  // 33/37/30 %, IR 1 %
+};
+
+void tcs3472x_classify_init(tcs3472x_classifier_t *classifier) {
+    uint8_t i = 0, f = 0;
+
+    for (i = 0; i < TCS3472X_LIGHT_COUNT; i++) {
+        for (f = 0; f < TCS3472X_CLASSIFY_FEATURES; f++) {
+            classifier->centroids[i][f] = default_centroids[i][f];
+        }
+        tcs3472x_lux_params_default(&classifier->lux[i]);
+        classifier->counts[i] = 0;
+    }
+    classifier->min_clear = DEFAULT_MIN_CLEAR;
+    classifier->switch_count = DEFAULT_SWITCH_COUNT;
+    classifier->current = TCS3472X_LIGHT_UNKNOWN;
+    classifier->candidate = TCS3472X_LIGHT_UNKNOWN;
+    classifier->votes = 0;
+}
+
+void tcs3472x_classify_features(const uint16_t colors[4], uint16_t features[TCS3472X_CLASSIFY_FEATURES]) {
+    const uint32_t reciprocal = ((uint32_t)1 << RECIPROCAL_BITS) / (colors[0] == 0 ? 1 : colors[0]);
+    int32_t ir = ((int32_t)colors[1] + colors[2] + colors[3] - colors[0]) / 2;
+    uint32_t ratio = 0;
+    uint8_t f = 0;
+
+    for (f = 0; f < TCS3472X_CLASSIFY_FEATURES; f++) {
+        ratio = (uint32_t)(((uint64_t)(f < 3 ? colors[f + 1] : (ir < 0 ? 0 : (uint32_t)ir)) * reciprocal) >> 16);
+        features[f] = ratio > FEATURE_MAX ? FEATURE_MAX : (uint16_t)ratio;
+    }
+}
+
+tcs3472x_light_t tcs3472x_classify_sample(const tcs3472x_classifier_t *classifier, const uint16_t colors[4],
+                                          uint32_t *margin) {
+    uint16_t features[TCS3472X_CLASSIFY_FEATURES];
+    uint32_t best = UINT32_MAX, second = UINT32_MAX, distance = 0;
+    int32_t difference = 0;
+    tcs3472x_light_t light = TCS3472X_LIGHT_UNKNOWN;
+    uint8_t i = 0, f = 0;
+
+    if (colors[0] < classifier->min_clear) {
+        if (margin != NULL) {
+            *margin = 0;
+        }
+        return TCS3472X_LIGHT_UNKNOWN;
+    }
+
+    tcs3472x_classify_features(colors, features);
+    for (i = TCS3472X_LIGHT_UNKNOWN + 1; i < TCS3472X_LIGHT_COUNT; i++) {
+        distance = 0;
+        for (f = 0; f < TCS3472X_CLASSIFY_FEATURES; f++) {
+            difference = (int32_t)features[f] - classifier->centroids[i][f];
+            distance += (uint32_t)(difference * difference);
+        }
+        if (distance < best) {
+            second = best;
+            best = distance;
+            light = (tcs3472x_light_t)i;
+        }
+        else if (distance < second) {
+            second = distance;
+        }
+    }
+
+    if (margin != NULL) {
+        *margin = second - best;
+    }
+    return light;
+}
+
+tcs3472x_light_t tcs3472x_classify_update(tcs3472x_classifier_t *classifier, const uint16_t colors[4]) {
+    tcs3472x_light_t light = tcs3472x_classify_sample(classifier, colors, NULL);
+
+    classifier->counts[light]++;
+    if (light == classifier->current) {
+        classifier->votes = 0;
+        return classifier->current;
+    }
+
+    if (light == classifier->candidate) {
+        classifier->votes++;
+    }
+    else {
+        classifier->candidate = light;
+        classifier->votes = 1;
+    }
+
+    // The first classified sample sets the class at once
+    if (classifier->votes >= classifier->switch_count || classifier->current == TCS3472X_LIGHT_UNKNOWN) {
+        classifier->current = light;
+        classifier->votes = 0;
+    }
+    return classifier->current;
+}
+
+uint32_t tcs3472x_classify_mlux(const tcs3472x_classifier_t *classifier, const uint16_t colors[4], uint8_t atime,
+                                uint8_t again) {
+    return tcs3472x_lux_mlux(&classifier->lux[classifier->current], colors, atime, again);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file tcs3472x_format.c
+ * @brief Integer-only sample formatting as CSV, NDJSON or packed binary records.
+ *
+ * This file implements the functions declared in tcs3472x_format.h. Decimal digits are produced two
+ * at a time from a table, which halves the number of divisions.
+ */
+
+#include "tcs3472x_format.h"
+
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static uint8_t _format_u64(char *out, uint64_t value);
+static char *_append(char *out, const char *text);
+static char *_put_u16_le(char *out, uint16_t value);
+
+uint8_t tcs3472x_format_i64(char *out, int64_t value) {
+    if (value < 0) {
+        *out = '-';
+        return 1 + _format_u64(out + 1, (uint64_t)0 - (uint64_t)value);
+    }
+    return _format_u64(out, (uint64_t)value);
+}
+
+uint16_t tcs3472x_format_sample(char *out, tcs3472x_format_t format, const tcs3472x_format_sample_t *sample) {
+    static const char *const keys[4] = { ",\"clear\":", ",\"red\":", ",\"green\":", ",\"blue\":" };
+    char *p = out;
+    uint64_t timestamp = (uint64_t)sample->timestamp_ns;
+    uint8_t i = 0;
+
+    switch (format) {
+        case TCS3472X_FORMAT_BINARY:
+            for (i = 0; i < 8; i++) {
+                *p++ = (char)(timestamp >> (8 * i));
+            }
+            p = _put_u16_le(p, sample->device);
+            for (i = 0; i < 4; i++) {
+                p = _put_u16_le(p, sample->colors[i]);
+            }
+            break;
+        case TCS3472X_FORMAT_NDJSON:
+            p = _append(p, "{\"timestamp_ns\":");
+            p += tcs3472x_format_i64(p, sample->timestamp_ns);
+            p = _append(p, ",\"device\":");
+            p += _format_u64(p, sample->device);
+            for (i = 0; i < 4; i++) {
+                p = _append(p, keys[i]);
+                p += _format_u64(p, sample->colors[i]);
+            }
+            p = _append(p, "}\n");
+            break;
+        case TCS3472X_FORMAT_CSV:
+        default:
+            p += tcs3472x_format_i64(p, sample->timestamp_ns);
+            *p++ = ',';
+            p += _format_u64(p, sample->device);
+            for (i = 0; i < 4; i++) {
+                *p++ = ',';
+                p += _format_u64(p, sample->colors[i]);
+            }
+            *p++ = '\n';
+            break;
+    }
+    return (uint16_t)(p - out);
+}
+
+/**
+ * Writes an unsigned integer in decimal, two digits per step.
+ *
+ * @return The number of characters written.
+ */
+static uint8_t _format_u64(char *out, uint64_t value) {
+    char digits[20];
+    uint8_t n = sizeof(digits), length = 0;
+    uint32_t pair = 0, low = 0, chunk = 0;
+    uint8_t i = 0;
+
+    // 64-bit division is slow, so it only splits off eight digits at a time above 32 bits
+    while (value > UINT32_MAX) {
+        chunk = (uint32_t)(value % 100000000);
+        value /= 100000000;
+        for (i = 0; i < 4; i++) {
+            pair = (chunk % 100) * 2;
+            chunk /= 100;
+            digits[--n] = digit_pairs[pair + 1];
+            digits[--n] = digit_pairs[pair];
+        }
+    }
+    low = (uint32_t)value;
+    while (low >= 100) {
+        pair = (low % 100) * 2;
+        low /= 100;
+        digits[--n] = digit_pairs[pair + 1];
+        digits[--n] = digit_pairs[pair];
+    }
+    if (low >= 10) {
+        pair = low * 2;
+        digits[--n] = digit_pairs[pair + 1];
+        digits[--n] = digit_pairs[pair];
+    }
+    else {
+        digits[--n] = (char)('0' + low);
+    }
+
+    length = sizeof(digits) - n;
+    for (pair = 0; pair < length; pair++) {
+        out[pair] = digits[n + pair];
+    }
+    return length;
+}
+
+/**
+ * Copies a string without its terminator.
+ *
+ * @return The position after the copied characters.
+ */
+static char *_append(char *out, const char *text) {
+    while (*text != '\0') {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+/**
+ * Writes a 16-bit value in little-endian order.
+ *
+ * @return The position after the two bytes.
+ */
+static char *_put_u16_le(char *out, uint16_t value) {
+    out[0] = (char)(value & 0xFF);
+    out[1] = (char)(value >> 8);
+    return out + 2;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file tcs3472x_internal.h
+ * @brief Helpers shared by the translation units of the core driver.
+ *
+ * Private to src/; this header is not installed and its functions are not part of the API.
+ */
+
+#ifndef TCS3472X_INTERNAL_H
+#define TCS3472X_INTERNAL_H
+
+#include <stdint.h>
+
+/**
+ * Enum for command types used with the TCS3472x sensor.
+ */
+typedef enum {
+    REPEAT_BYTE = 0b00,        ///< Command to repeat reading/writing the same register.
+    AUTO_INCREMENT = 0b01,     ///< Command to auto-increment register address on sequential reads/writes.
+    SPECIAL_FUNCTION = 0b11,   ///< Command for special functions, not typically used in standard operations.
+} command_type_t;
+
+/**
+ * Builds a command byte.
+ *
+ * @param reg_address The register address or special function code.
+ * @param cmd_type The type of the transaction that follows.
+ * @return The command byte.
+ */
+uint8_t _build_command_register(uint8_t reg_address, command_type_t cmd_type);
+
+/**
+ * Writes one register with the command byte and value in a single transaction.
+ *
+ * @param reg_address The register address to write.
+ * @param value The value to write.
+ * @return 0 on success, -1 if the write fails.
+ */
+int8_t _write_register(uint8_t reg_address, uint8_t value);
+
+/**
+ * Converts the little-endian clear, red, green and blue data bytes to counts.
+ *
+ * @param data 8 bytes starting at CDATAL.
+ * @param buff Destination for 4 counts.
+ */
+void _unpack_colors(const uint8_t *data, uint16_t *buff);
+
+#endif // TCS3472X_INTERNAL_H
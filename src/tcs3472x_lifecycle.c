@@ -0,0 +1,147 @@
+/**
+ * @file tcs3472x_lifecycle.c
+ * @brief Hot-plug tolerant device lifecycle on top of the core driver.
+ *
+ * This file implements the functions declared in tcs3472x_lifecycle.h.
+ */
+
+#include "tcs3472x.h"
+#include "tcs3472x_lifecycle.h"
+
+#define DEFAULT_ID                  0x44
+#define DEFAULT_MIN_BACKOFF_NS      10000000LL      ///< 10 ms
+#define DEFAULT_MAX_BACKOFF_NS      2000000000LL    ///< 2 s
+#define DEFAULT_ERROR_LIMIT         3
+#define DEFAULT_CHECK_INTERVAL      10
+
+static void _enter(tcs3472x_lifecycle_t *lifecycle, tcs3472x_lifecycle_state_t state);
+static void _leave_running(tcs3472x_lifecycle_t *lifecycle);
+static void _absent(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns);
+static void _probe(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns);
+static int8_t _sample(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns, uint16_t colors[4]);
+
+void tcs3472x_lifecycle_config_default(tcs3472x_lifecycle_config_t *config) {
+    config->expected_id = DEFAULT_ID;
+    config->min_backoff_ns = DEFAULT_MIN_BACKOFF_NS;
+    config->max_backoff_ns = DEFAULT_MAX_BACKOFF_NS;
+    config->error_limit = DEFAULT_ERROR_LIMIT;
+    tcs3472x_watchdog_config_default(&config->watchdog);
+    config->watchdog.check_interval = DEFAULT_CHECK_INTERVAL;
+}
+
+void tcs3472x_lifecycle_init(tcs3472x_lifecycle_t *lifecycle, const tcs3472x_lifecycle_config_t *config,
+                             const tcs3472x_config_cache_t *desired, int64_t now_ns) {
+    uint8_t i = 0;
+
+    lifecycle->config = *config;
+    // The lifecycle decides how to recover, not the watchdog
+    lifecycle->config.watchdog.auto_recover = 0;
+    lifecycle->desired = *desired;
+    lifecycle->next_probe_ns = now_ns;
+    lifecycle->backoff_ns = config->min_backoff_ns;
+    lifecycle->errors = 0;
+    lifecycle->probes = 0;
+    lifecycle->configurations = 0;
+    for (i = 0; i < TCS3472X_LIFECYCLE_STATE_COUNT; i++) {
+        lifecycle->entries[i] = 0;
+    }
+    tcs3472x_watchdog_init(&lifecycle->watchdog, &lifecycle->config.watchdog, config->expected_id);
+    _enter(lifecycle, TCS3472X_LIFECYCLE_PROBING);
+}
+
+int8_t tcs3472x_lifecycle_poll(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns, uint16_t colors[4]) {
+    switch (lifecycle->state) {
+        case TCS3472X_LIFECYCLE_ABSENT:
+            if (now_ns - lifecycle->next_probe_ns < 0) {
+                return 0;
+            }
+            _enter(lifecycle, TCS3472X_LIFECYCLE_PROBING);
+            _probe(lifecycle, now_ns);
+            return 0;
+        case TCS3472X_LIFECYCLE_PROBING:
+        case TCS3472X_LIFECYCLE_CONFIGURING:
+        case TCS3472X_LIFECYCLE_FAULTED:
+            _enter(lifecycle, TCS3472X_LIFECYCLE_PROBING);
+            _probe(lifecycle, now_ns);
+            return 0;
+        case TCS3472X_LIFECYCLE_RUNNING:
+            return _sample(lifecycle, now_ns, colors);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Switches to a state and counts the entry.
+ */
+static void _enter(tcs3472x_lifecycle_t *lifecycle, tcs3472x_lifecycle_state_t state) {
+    lifecycle->state = state;
+    lifecycle->entries[state]++;
+}
+
+/**
+ * Keeps configuration changes made through the core setters while running.
+ */
+static void _leave_running(tcs3472x_lifecycle_t *lifecycle) {
+    lifecycle->desired = *tcs3472x_get_config_cache();
+}
+
+/**
+ * Enters the absent state and schedules the next probe, doubling the backoff up to its maximum.
+ */
+static void _absent(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns) {
+    _enter(lifecycle, TCS3472X_LIFECYCLE_ABSENT);
+    lifecycle->next_probe_ns = now_ns + lifecycle->backoff_ns;
+    lifecycle->backoff_ns = lifecycle->backoff_ns > lifecycle->config.max_backoff_ns / 2 ?
+                            lifecycle->config.max_backoff_ns : lifecycle->backoff_ns * 2;
+}
+
+/**
+ * Checks the ID register and writes the desired configuration if the expected sensor answers.
+ */
+static void _probe(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns) {
+    uint8_t id = 0;
+
+    lifecycle->probes++;
+    id = tcs3472x_get_id();
+    if (id != lifecycle->config.expected_id) {
+        _absent(lifecycle, now_ns);
+        return;
+    }
+
+    _enter(lifecycle, TCS3472X_LIFECYCLE_CONFIGURING);
+    if (tcs3472x_apply_config(&lifecycle->desired) < 0) {
+        _absent(lifecycle, now_ns);
+        return;
+    }
+
+    LOG_DEBUG("Sensor 0x%02x configured after %u probes.\r\n", id, lifecycle->probes);
+    lifecycle->configurations++;
+    lifecycle->backoff_ns = lifecycle->config.min_backoff_ns;
+    lifecycle->errors = 0;
+    tcs3472x_watchdog_init(&lifecycle->watchdog, &lifecycle->config.watchdog, lifecycle->config.expected_id);
+    _enter(lifecycle, TCS3472X_LIFECYCLE_RUNNING);
+}
+
+/**
+ * Reads one sample and leaves the running state on repeated read errors or a watchdog fault.
+ *
+ * @return 1 if colors holds a valid sample, 0 otherwise.
+ */
+static int8_t _sample(tcs3472x_lifecycle_t *lifecycle, int64_t now_ns, uint16_t colors[4]) {
+    if (tcs3472x_get_all_colors_data(colors) < 0) {
+        if (++lifecycle->errors >= lifecycle->config.error_limit) {
+            _leave_running(lifecycle);
+            _absent(lifecycle, now_ns);
+        }
+        return 0;
+    }
+    lifecycle->errors = 0;
+
+    if (tcs3472x_watchdog_feed(&lifecycle->watchdog, colors) != TCS3472X_WATCHDOG_OK) {
+        _leave_running(lifecycle);
+        _enter(lifecycle, TCS3472X_LIFECYCLE_FAULTED);
+        return 0;
+    }
+    return 1;
+}
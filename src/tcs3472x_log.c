@@ -0,0 +1,204 @@
+/**
+ * @file tcs3472x_log.c
+ * @brief Deferred, lock-free logging for the TCS3472x driver.
+ *
+ * This file implements the ring declared in tcs3472x_log.h. It is a bounded multi-producer queue in
+ * which every slot carries a sequence number telling producers and the drain whose turn it is, so no
+ * lock is ever taken. Sequence numbers are stored relative to the slot index, which lets the ring
+ * start out zero-initialized without an init call.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "tcs3472x_log.h"
+
+#define RING_MASK   (TCS3472X_LOG_RING_SIZE - 1)
+#define SPEC_SIZE   16
+
+/**
+ * One stored event.
+ */
+typedef struct {
+    atomic_uint sequence;                   ///< Turn marker, relative to the slot index.
+    uint8_t level;                          ///< tcs3472x_log_level_t of the event.
+    uint8_t nargs;                          ///< Number of valid entries in args.
+    const char *format;                     ///< Format string literal.
+    intptr_t args[TCS3472X_LOG_MAX_ARGS];   ///< Raw arguments.
+} log_slot_t;
+
+static log_slot_t ring[TCS3472X_LOG_RING_SIZE];
+static atomic_uint enqueue_pos;
+static atomic_uint dequeue_pos;
+static atomic_uint dropped;
+static atomic_uint dropped_reported;
+static tcs3472x_log_sink_t log_sink = NULL;
+
+static void _default_sink(tcs3472x_log_level_t level, const char *line);
+static void _format(char *line, size_t size, const log_slot_t *slot);
+
+void tcs3472x_log_event(tcs3472x_log_level_t level, const char *format, uint8_t nargs, ...) {
+    log_slot_t *slot = NULL;
+    unsigned int pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    unsigned int sequence = 0;
+    va_list ap;
+    uint8_t i = 0;
+
+    for (;;) {
+        slot = &ring[pos & RING_MASK];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire) + (pos & RING_MASK);
+
+        if ((int)(sequence - pos) == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if ((int)(sequence - pos) < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        }
+        else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    if (nargs > TCS3472X_LOG_MAX_ARGS) {
+        nargs = TCS3472X_LOG_MAX_ARGS;
+    }
+
+    slot->level = level;
+    slot->format = format;
+    slot->nargs = nargs;
+    va_start(ap, nargs);
+    for (i = 0; i < nargs; i++) {
+        slot->args[i] = va_arg(ap, intptr_t);
+    }
+    va_end(ap);
+
+    atomic_store_explicit(&slot->sequence, pos + 1 - (pos & RING_MASK), memory_order_release);
+}
+
+uint32_t tcs3472x_log_drain(void) {
+    tcs3472x_log_sink_t sink = log_sink ? log_sink : _default_sink;
+    char line[TCS3472X_LOG_LINE_SIZE];
+    log_slot_t *slot = NULL;
+    unsigned int pos = 0, sequence = 0, lost = 0;
+    uint32_t count = 0;
+
+    for (;;) {
+        pos = atomic_load_explicit(&dequeue_pos, memory_order_relaxed);
+        slot = &ring[pos & RING_MASK];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire) + (pos & RING_MASK);
+
+        if ((int)(sequence - (pos + 1)) < 0) {
+            break;
+        }
+        if ((int)(sequence - (pos + 1)) > 0 ||
+            !atomic_compare_exchange_weak_explicit(&dequeue_pos, &pos, pos + 1,
+                                                   memory_order_relaxed, memory_order_relaxed)) {
+            continue;
+        }
+
+        _format(line, sizeof(line), slot);
+        sink(slot->level, line);
+        count++;
+
+        atomic_store_explicit(&slot->sequence, pos + TCS3472X_LOG_RING_SIZE - (pos & RING_MASK),
+                              memory_order_release);
+    }
+
+    lost = atomic_load_explicit(&dropped, memory_order_relaxed);
+    if (lost != atomic_exchange_explicit(&dropped_reported, lost, memory_order_relaxed)) {
+        snprintf(line, sizeof(line), "TCS3472X Error: %u log events dropped in total.\r\n", lost);
+        sink(TCS3472X_LOG_LEVEL_ERROR, line);
+    }
+
+    return count;
+}
+
+void tcs3472x_log_set_sink(tcs3472x_log_sink_t sink) {
+    log_sink = sink;
+}
+
+uint32_t tcs3472x_log_dropped(void) {
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+/**
+ * Writes a formatted message to stderr.
+ */
+static void _default_sink(tcs3472x_log_level_t level, const char *line) {
+    (void)level;
+    fputs(line, stderr);
+}
+
+/**
+ * Formats a stored event, converting every raw argument back to the type its conversion expects.
+ *
+ * @param line Destination buffer.
+ * @param size Size of the destination buffer.
+ * @param slot Event to format.
+ */
+static void _format(char *line, size_t size, const log_slot_t *slot) {
+    const char *p = slot->format;
+    char spec[SPEC_SIZE];
+    size_t used = 0, spec_len = 0;
+    uint8_t arg = 0, is_long = 0;
+    int written = 0;
+
+    while (*p != '\0' && used + 1 < size) {
+        if (*p != '%') {
+            line[used++] = *p++;
+            continue;
+        }
+
+        // Collect one conversion specification: %[flags][width][l]conversion
+        spec_len = 0;
+        is_long = 0;
+        spec[spec_len++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.l", *p) != NULL && spec_len + 2 < SPEC_SIZE) {
+            if (*p == 'l') {
+                is_long = 1;
+            }
+            spec[spec_len++] = *p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        spec[spec_len++] = *p;
+        spec[spec_len] = '\0';
+
+        if (*p == '%') {
+            written = snprintf(line + used, size - used, "%%");
+        }
+        else if (arg >= slot->nargs) {
+            written = snprintf(line + used, size - used, "?");
+        }
+        else if (*p == 's') {
+            written = snprintf(line + used, size - used, spec, (const char *)slot->args[arg++]);
+        }
+        else if (*p == 'p') {
+            written = snprintf(line + used, size - used, spec, (void *)slot->args[arg++]);
+        }
+        else if (is_long) {
+            written = snprintf(line + used, size - used, spec, (long)slot->args[arg++]);
+        }
+        else {
+            written = snprintf(line + used, size - used, spec, (int)slot->args[arg++]);
+        }
+        p++;
+
+        if (written < 0) {
+            break;
+        }
+        used += (size_t)written;
+        if (used >= size) {
+            used = size - 1;
+        }
+    }
+
+    line[used] = '\0';
+}
@@ -0,0 +1,59 @@
+/**
+ * @file tcs3472x_lux.c
+ * @brief Illuminance from TCS3472x color data.
+ *
+ * This file implements the functions declared in tcs3472x_lux.h using integer arithmetic only.
+ */
+
+#include "tcs3472x_lux.h"
+
+#define CYCLE_STEP_US           2400    ///< One ATIME step (2.4 ms)
+#define CYCLE_STEPS             256
+#define FULL_SCALE_PER_STEP     1024    ///< Clear count full scale per integration step
+#define MAX_COUNT               65535
+
+// DN40 open-air values for the TCS3472x
+#define DN40_R_COEF             136
+#define DN40_G_COEF             1000
+#define DN40_B_COEF             -444
+#define DN40_GA                 1000
+#define DN40_DF                 310
+
+static const uint8_t gain_multiplier[] = { 1, 4, 16, 60 };
+
+void tcs3472x_lux_params_default(tcs3472x_lux_params_t *params) {
+    params->r_coef = DN40_R_COEF;
+    params->g_coef = DN40_G_COEF;
+    params->b_coef = DN40_B_COEF;
+    params->ga = DN40_GA;
+    params->df = DN40_DF;
+}
+
+uint32_t tcs3472x_lux_mlux(const tcs3472x_lux_params_t *params, const uint16_t colors[4], uint8_t atime,
+                           uint8_t again) {
+    const uint32_t steps = CYCLE_STEPS - atime;
+    const uint32_t full_scale = steps * FULL_SCALE_PER_STEP > MAX_COUNT ? MAX_COUNT : steps * FULL_SCALE_PER_STEP;
+    int32_t ir = 0;
+    int64_t g2 = 0;
+    uint64_t mlux = 0;
+
+    if (colors[0] >= full_scale) {
+        return TCS3472X_LUX_SATURATED;
+    }
+
+    ir = ((int32_t)colors[1] + colors[2] + colors[3] - colors[0]) / 2;
+    if (ir < 0) {
+        ir = 0;
+    }
+
+    // G'' in thousandths of a count
+    g2 = (int64_t)params->r_coef * (colors[1] - ir) + (int64_t)params->g_coef * (colors[2] - ir) +
+         (int64_t)params->b_coef * (colors[3] - ir);
+    if (g2 <= 0) {
+        return 0;
+    }
+
+    // G'' * GA * DF / (ATIME_ms * gain), with G'' and GA in thousandths and ATIME in microseconds
+    mlux = (uint64_t)g2 * params->ga * params->df / ((uint64_t)steps * CYCLE_STEP_US * gain_multiplier[again & 0x03]);
+    return mlux >= TCS3472X_LUX_SATURATED ? TCS3472X_LUX_SATURATED - 1 : (uint32_t)mlux;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file tcs3472x_post.c
+ * @brief Per-device post-processing of raw samples: calibration, filtering and lux.
+ *
+ * This file implements the functions declared in tcs3472x_post.h using integer arithmetic only.
+ */
+
+#include "tcs3472x_post.h"
+
+#define MAX_COUNT   65535
+
+void tcs3472x_post_init(tcs3472x_post_device_t *device, uint8_t filter_shift, uint8_t atime, uint8_t again) {
+    uint8_t c = 0;
+
+    for (c = 0; c < 4; c++) {
+        device->dark[c] = 0;
+        device->gain_q16[c] = TCS3472X_POST_GAIN_ONE;
+        device->filter[c] = 0;
+        device->filtered[c] = 0;
+    }
+    device->filter_shift = filter_shift;
+    device->atime = atime;
+    device->again = again;
+    tcs3472x_lux_params_default(&device->lux);
+    device->mlux = 0;
+    device->samples = 0;
+    device->primed = 0;
+}
+
+void tcs3472x_post_process(tcs3472x_post_device_t *device, const uint16_t (*samples)[4], uint32_t count) {
+    uint32_t i = 0, value = 0;
+    uint64_t calibrated = 0;
+    uint8_t c = 0;
+
+    if (count == 0) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        for (c = 0; c < 4; c++) {
+            value = samples[i][c] > device->dark[c] ? samples[i][c] - device->dark[c] : 0;
+            calibrated = ((uint64_t)value * device->gain_q16[c]) >> 16;
+            value = (calibrated > MAX_COUNT ? MAX_COUNT : (uint32_t)calibrated) << TCS3472X_POST_FILTER_BITS;
+
+            // The first sample seeds the filter instead of ramping up from zero
+            if (!device->primed || device->filter_shift == 0) {
+                device->filter[c] = value;
+            }
+            else if (value >= device->filter[c]) {
+                device->filter[c] += (value - device->filter[c]) >> device->filter_shift;
+            }
+            else {
+                device->filter[c] -= (device->filter[c] - value) >> device->filter_shift;
+            }
+        }
+        device->primed = 1;
+    }
+
+    for (c = 0; c < 4; c++) {
+        device->filtered[c] = (uint16_t)((device->filter[c] + (1u << (TCS3472X_POST_FILTER_BITS - 1))) >>
+                                         TCS3472X_POST_FILTER_BITS);
+    }
+    device->mlux = tcs3472x_lux_mlux(&device->lux, device->filtered, device->atime, device->again);
+    device->samples += count;
+}
+
+void tcs3472x_post_range(void *context, uint32_t begin, uint32_t end) {
+    const tcs3472x_post_batch_t *batch = context;
+    uint32_t d = 0;
+
+    for (d = begin; d < end; d++) {
+        tcs3472x_post_process(&batch->devices[d], batch->samples + (uint64_t)d * batch->count, batch->count);
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * @file tcs3472x_power.c
+ * @brief Power consumption estimate and low-power configuration planner for the TCS3472x.
+ *
+ * This file implements the functions declared in tcs3472x_power.h using integer arithmetic only.
+ */
+
+#include "tcs3472x_power.h"
+
+#define CYCLE_STEP_US           2400    ///< One ATIME/WTIME step (2.4 ms)
+#define CYCLE_STEPS             256
+#define WLONG_FACTOR            12      ///< WLONG multiplies the wait steps
+#define FULL_SCALE_PER_STEP     1024    ///< Clear count full scale per integration step
+#define MAX_COUNT               65535
+#define DEFAULT_VDD_MV          3300
+#define DEFAULT_PULLUP_OHM      4700
+
+static const uint8_t gain_multiplier[] = { 1, 4, 16, 60 };
+
+static uint32_t _wait_us(const tcs3472x_config_cache_t *config);
+static uint32_t _dimmest_count(const tcs3472x_power_requirement_t *requirement, uint8_t again,
+                               uint32_t steps);
+
+void tcs3472x_power_params_default(tcs3472x_power_params_t *params) {
+    params->active_na = TCS3472X_POWER_ACTIVE_NA;
+    params->wait_na = TCS3472X_POWER_WAIT_NA;
+    params->sleep_na = TCS3472X_POWER_SLEEP_NA;
+    params->vdd_mv = DEFAULT_VDD_MV;
+    params->pullup_ohm = DEFAULT_PULLUP_OHM;
+    tcs3472x_bus_config_default(&params->bus, TCS3472X_BUS_FAST_MODE_HZ);
+}
+
+void tcs3472x_power_estimate(const tcs3472x_power_params_t *params, const tcs3472x_config_cache_t *config,
+                             uint32_t read_rate_mhz, tcs3472x_power_estimate_t *estimate) {
+    uint32_t atime_us = 0, wait_us = 0;
+    uint64_t bus_us_per_hour = 0;
+
+    if (!(config->enable & ENABLE_PON)) {
+        estimate->cycle_us = 0;
+        estimate->sensor_na = params->sleep_na;
+    }
+    else if (!(config->enable & ENABLE_AEN)) {
+        estimate->cycle_us = 0;
+        estimate->sensor_na = params->wait_na;
+    }
+    else {
+        atime_us = (uint32_t)tcs3472x_atime_to_us(config->atime);
+        wait_us = _wait_us(config);
+        estimate->cycle_us = atime_us + wait_us;
+        estimate->sensor_na = (uint32_t)(((uint64_t)params->active_na * atime_us +
+                                          (uint64_t)params->wait_na * wait_us) / estimate->cycle_us);
+    }
+
+    // nA * mV is pW; over 3600 s that is 3600 pJ, or 3600 / 1e6 uJ
+    estimate->sensor_uj_per_hour = (uint32_t)((uint64_t)estimate->sensor_na * params->vdd_mv * 3600 / 1000000);
+
+    // cost_ns * rate_mhz / 1000 is busy ns per second; times 3600 s and / 1000 for us per hour
+    bus_us_per_hour = (uint64_t)tcs3472x_bus_cost_ns(&params->bus, TCS3472X_BUS_OP_GET_ALL_COLORS) *
+                      read_rate_mhz * 36 / 10000;
+    // Two lines, each low half the time, draw V^2 / R for the whole busy time
+    estimate->bus_uj_per_hour = params->pullup_ohm == 0 ? 0 :
+        (uint32_t)(bus_us_per_hour * params->vdd_mv * params->vdd_mv / params->pullup_ohm / 1000000);
+}
+
+int8_t tcs3472x_power_plan(const tcs3472x_power_params_t *params,
+                           const tcs3472x_power_requirement_t *requirement,
+                           tcs3472x_config_cache_t *config, tcs3472x_power_estimate_t *estimate) {
+    const uint32_t required_count = (uint32_t)requirement->min_snr * requirement->noise_counts;
+    tcs3472x_config_cache_t candidate;
+    tcs3472x_power_estimate_t candidate_estimate;
+    uint32_t period_us = 0, remaining_us = 0, short_steps = 0, long_steps = 0, steps = 0, full_scale = 0;
+    uint64_t brightest = 0;
+    uint8_t again = 0, feasible = 0, found = 0;
+
+    if (requirement->rate_mhz == 0) {
+        return -1;
+    }
+    period_us = (uint32_t)(1000000000ULL / requirement->rate_mhz);
+
+    for (again = CONTROL_AGAIN_1X; again <= CONTROL_AGAIN_60X; again++) {
+        // A longer integration only adds active time, so the shortest one that works is the best
+        feasible = 0;
+        for (steps = 1; steps <= CYCLE_STEPS && steps * CYCLE_STEP_US <= period_us; steps++) {
+            full_scale = steps * FULL_SCALE_PER_STEP > MAX_COUNT ? MAX_COUNT : steps * FULL_SCALE_PER_STEP;
+            brightest = (uint64_t)requirement->max_counts_per_s * gain_multiplier[again] * steps *
+                        CYCLE_STEP_US / 1000000;
+
+            // Longer integrations saturate too
+            if (requirement->max_counts_per_s != 0 && brightest >= full_scale) {
+                break;
+            }
+            if (_dimmest_count(requirement, again, steps) >= required_count) {
+                feasible = 1;
+                break;
+            }
+        }
+        if (!feasible) {
+            continue;
+        }
+
+        candidate.enable = ENABLE_PON | ENABLE_AEN;
+        candidate.atime = (uint8_t)(CYCLE_STEPS - steps);
+        candidate.wtime = WTIME_DEFAULT;
+        candidate.config = CONFIG_DEFAULT;
+        candidate.control = again;
+
+        // Fill the rest of the period with the longest wait that still fits
+        remaining_us = period_us - steps * CYCLE_STEP_US;
+        short_steps = remaining_us / CYCLE_STEP_US;
+        short_steps = short_steps > CYCLE_STEPS ? CYCLE_STEPS : short_steps;
+        long_steps = remaining_us / (CYCLE_STEP_US * WLONG_FACTOR);
+        long_steps = long_steps > CYCLE_STEPS ? CYCLE_STEPS : long_steps;
+        if (long_steps * WLONG_FACTOR > short_steps) {
+            candidate.enable |= ENABLE_WEN;
+            candidate.wtime = (uint8_t)(CYCLE_STEPS - long_steps);
+            candidate.config = CONFIG_WLONG;
+        }
+        else if (short_steps > 0) {
+            candidate.enable |= ENABLE_WEN;
+            candidate.wtime = (uint8_t)(CYCLE_STEPS - short_steps);
+        }
+
+        tcs3472x_power_estimate(params, &candidate, requirement->rate_mhz, &candidate_estimate);
+        if (!found || candidate_estimate.sensor_na < estimate->sensor_na) {
+            *config = candidate;
+            *estimate = candidate_estimate;
+            found = 1;
+        }
+    }
+    return found ? 0 : -1;
+}
+
+/**
+ * Returns the wait time of a configuration in microseconds, 0 if WEN is clear.
+ */
+static uint32_t _wait_us(const tcs3472x_config_cache_t *config) {
+    if (!(config->enable & ENABLE_WEN)) {
+        return 0;
+    }
+    return (CYCLE_STEPS - config->wtime) * CYCLE_STEP_US *
+           ((config->config & CONFIG_WLONG) ? WLONG_FACTOR : 1);
+}
+
+/**
+ * Returns the clear count of the dimmest scene, limited to full scale.
+ */
+static uint32_t _dimmest_count(const tcs3472x_power_requirement_t *requirement, uint8_t again,
+                               uint32_t steps) {
+    uint64_t count = (uint64_t)requirement->min_counts_per_s * gain_multiplier[again] * steps *
+                     CYCLE_STEP_US / 1000000;
+    uint32_t full_scale = steps * FULL_SCALE_PER_STEP > MAX_COUNT ? MAX_COUNT : steps * FULL_SCALE_PER_STEP;
+
+    return count > full_scale ? full_scale : (uint32_t)count;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file tcs3472x_sort.c
+ * @brief Trigger-to-decision color sorting against a palette of reference colors.
+ *
+ * This file implements the functions declared in tcs3472x_sort.h using integer arithmetic only.
+ */
+
+#include <stddef.h>
+#include "tcs3472x.h"
+#include "tcs3472x_sort.h"
+
+#define ONE                     4096            ///< 1.0 in the 12-bit fixed point of the color math
+#define CYCLE_STEPS             256
+#define FULL_SCALE_PER_STEP     1024
+#define MAX_COUNT               65535
+#define OSCILLATOR_FAST         9               ///< The integration may end after 9/10 of its nominal time
+#define T_MAX                   (8 * ONE)       ///< Largest X/Xn and Z/Zn ratio converted
+#define T_LINEAR                36              ///< (6/29)^3, below which f(t) is linear
+#define WHITE_X                 3893            ///< D65 Xn = 0.95047
+#define WHITE_Z                 4460            ///< D65 Zn = 1.08883
+#define CELL_COUNT              (TCS3472X_SORT_GRID_SIZE * TCS3472X_SORT_GRID_SIZE)
+
+#define DEFAULT_AGAIN           CONTROL_AGAIN_16X
+#define DEFAULT_MIN_CLEAR       16
+#define DEFAULT_MAX_DELTA_E     (10 * TCS3472X_SORT_DELTA_E_ONE)
+#define DEFAULT_TIMEOUT_NS      10000000        ///< 10 ms
+
+/**
+ * Linear sRGB to XYZ matrix in 12-bit fixed point. Its coefficients are all positive, so channel
+ * noise is not amplified the way a matrix fitted with negative coefficients amplifies it.
+ */
+static const int16_t default_matrix[3][3] = {
+    { 1689, 1465,  739 },
+    {  871, 2929,  296 },
+    {   79,  488, 3893 },
+};
+
+static int32_t _lab_f(int32_t t);
+static uint32_t _cbrt(uint64_t value);
+static uint32_t _sqrt(uint64_t value);
+static int16_t _clamp(int32_t value);
+static int32_t _cell(const tcs3472x_sorter_t *sorter, int16_t value, int16_t origin);
+static uint64_t _distance2(const tcs3472x_sort_reference_t *p, const tcs3472x_sort_reference_t *q);
+static uint64_t _axis_min(int32_t value, int32_t low, int32_t high);
+static uint64_t _axis_max(int32_t value, int32_t low, int32_t high);
+
+void tcs3472x_sort_config_default(tcs3472x_sort_config_t *config) {
+    uint8_t i = 0, j = 0;
+
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            config->matrix[i][j] = default_matrix[i][j];
+        }
+    }
+    config->atime = ATIME_DEFAULT;
+    config->again = DEFAULT_AGAIN;
+    config->min_clear = DEFAULT_MIN_CLEAR;
+    config->max_delta_e = DEFAULT_MAX_DELTA_E;
+    config->timeout_ns = DEFAULT_TIMEOUT_NS;
+}
+
+int8_t tcs3472x_sort_init(tcs3472x_sorter_t *sorter, const tcs3472x_sort_config_t *config) {
+    tcs3472x_config_cache_t registers = *tcs3472x_get_config_cache();
+    uint32_t full_scale = (uint32_t)(CYCLE_STEPS - config->atime) * FULL_SCALE_PER_STEP;
+
+    sorter->config = *config;
+    sorter->reference_count = 0;
+    sorter->indexed = 0;
+    sorter->full_scale = full_scale > MAX_COUNT ? MAX_COUNT : (uint16_t)full_scale;
+    sorter->pending = 0;
+    sorter->trigger_ns = 0;
+    sorter->ready_ns = 0;
+    sorter->decisions = 0;
+    sorter->rejects = 0;
+    sorter->errors = 0;
+
+    registers.enable = ENABLE_PON | ENABLE_AEN;
+    registers.atime = config->atime;
+    registers.control = config->again;
+    if (tcs3472x_apply_config(&registers) < 0) {
+        LOG_ERROR("Failed to configure the sensor for sorting.\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+void tcs3472x_sort_color(const tcs3472x_sort_config_t *config, const uint16_t colors[4],
+                         tcs3472x_sort_reference_t *color) {
+    int32_t xyz[3] = {0};
+    int64_t tx = 0, tz = 0;
+    uint8_t i = 0;
+
+    for (i = 0; i < 3; i++) {
+        xyz[i] = config->matrix[i][0] * (int32_t)colors[1]
+               + config->matrix[i][1] * (int32_t)colors[2]
+               + config->matrix[i][2] * (int32_t)colors[3];
+    }
+    if (xyz[1] < 1) {
+        xyz[1] = 1;
+    }
+
+    // Dividing by Y sets every sample to the lightness of the white point
+    tx = (int64_t)xyz[0] * ONE * ONE / ((int64_t)xyz[1] * WHITE_X);
+    tz = (int64_t)xyz[2] * ONE * ONE / ((int64_t)xyz[1] * WHITE_Z);
+    tx = tx < 0 ? 0 : tx > T_MAX ? T_MAX : tx;
+    tz = tz < 0 ? 0 : tz > T_MAX ? T_MAX : tz;
+
+    // a* = 500 (f(X/Xn) − f(1)) and b* = 200 (f(1) − f(Z/Zn)), in 1/16 units
+    color->a = _clamp((_lab_f((int32_t)tx) - ONE) * (500 * TCS3472X_SORT_DELTA_E_ONE) / ONE);
+    color->b = _clamp((ONE - _lab_f((int32_t)tz)) * (200 * TCS3472X_SORT_DELTA_E_ONE) / ONE);
+}
+
+int8_t tcs3472x_sort_add_reference(tcs3472x_sorter_t *sorter, const tcs3472x_sort_reference_t *color) {
+    if (sorter->reference_count >= TCS3472X_SORT_MAX_REFERENCES) {
+        return -1;
+    }
+    sorter->references[sorter->reference_count] = *color;
+    sorter->indexed = 0;
+    return (int8_t)sorter->reference_count++;
+}
+
+int8_t tcs3472x_sort_build_index(tcs3472x_sorter_t *sorter) {
+    int32_t low_a = INT16_MAX, low_b = INT16_MAX, high_a = INT16_MIN, high_b = INT16_MIN, span = 0;
+    int32_t corner_a = 0, corner_b = 0, width = 0;
+    uint64_t upper = 0, farthest = 0, nearest = 0;
+    uint16_t count = 0, cell = 0;
+    uint8_t i = 0;
+
+    sorter->indexed = 0;
+    if (sorter->reference_count == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < sorter->reference_count; i++) {
+        low_a = sorter->references[i].a < low_a ? sorter->references[i].a : low_a;
+        low_b = sorter->references[i].b < low_b ? sorter->references[i].b : low_b;
+        high_a = sorter->references[i].a > high_a ? sorter->references[i].a : high_a;
+        high_b = sorter->references[i].b > high_b ? sorter->references[i].b : high_b;
+    }
+    low_a -= sorter->config.max_delta_e;
+    low_b -= sorter->config.max_delta_e;
+    span = (high_a - low_a > high_b - low_b ? high_a - low_a : high_b - low_b) + sorter->config.max_delta_e + 1;
+    width = (span + TCS3472X_SORT_GRID_SIZE - 1) / TCS3472X_SORT_GRID_SIZE;
+    sorter->grid_origin.a = _clamp(low_a);
+    sorter->grid_origin.b = _clamp(low_b);
+    sorter->cell_width = (uint16_t)width;
+
+    for (cell = 0; cell < CELL_COUNT; cell++) {
+        corner_a = sorter->grid_origin.a + (cell % TCS3472X_SORT_GRID_SIZE) * width;
+        corner_b = sorter->grid_origin.b + (cell / TCS3472X_SORT_GRID_SIZE) * width;
+        sorter->cell_start[cell] = count;
+
+        // No point of the cell is further from its nearest reference than upper
+        upper = UINT64_MAX;
+        for (i = 0; i < sorter->reference_count; i++) {
+            farthest = _axis_max(sorter->references[i].a, corner_a, corner_a + width)
+                     + _axis_max(sorter->references[i].b, corner_b, corner_b + width);
+            upper = farthest < upper ? farthest : upper;
+        }
+
+        // So only references that come at least that close to the cell can be nearest
+        for (i = 0; i < sorter->reference_count; i++) {
+            nearest = _axis_min(sorter->references[i].a, corner_a, corner_a + width)
+                    + _axis_min(sorter->references[i].b, corner_b, corner_b + width);
+            if (nearest > upper) {
+                continue;
+            }
+            if (count >= TCS3472X_SORT_MAX_CANDIDATES) {
+                return -1;
+            }
+            sorter->candidates[count++] = i;
+        }
+    }
+    sorter->cell_start[CELL_COUNT] = count;
+    sorter->indexed = 1;
+    return 0;
+}
+
+int8_t tcs3472x_sort_match(const tcs3472x_sorter_t *sorter, const tcs3472x_sort_reference_t *color,
+                           uint16_t *delta_e) {
+    uint64_t best = UINT64_MAX, distance = 0;
+    uint32_t root = 0;
+    uint16_t begin = 0, end = sorter->reference_count, i = 0;
+    int32_t column = -1, row = -1;
+    int8_t reference = -1;
+    uint8_t candidate = 0, indexed = 0;
+
+    if (sorter->indexed) {
+        column = _cell(sorter, color->a, sorter->grid_origin.a);
+        row = _cell(sorter, color->b, sorter->grid_origin.b);
+        indexed = column >= 0 && row >= 0;
+    }
+    if (indexed) {
+        begin = sorter->cell_start[row * TCS3472X_SORT_GRID_SIZE + column];
+        end = sorter->cell_start[row * TCS3472X_SORT_GRID_SIZE + column + 1];
+    }
+
+    // Candidates are in palette order, so ties resolve as in a full scan
+    for (i = begin; i < end; i++) {
+        candidate = indexed ? sorter->candidates[i] : (uint8_t)i;
+        distance = _distance2(color, &sorter->references[candidate]);
+        if (distance < best) {
+            best = distance;
+            reference = (int8_t)candidate;
+        }
+    }
+
+    if (delta_e != NULL) {
+        root = reference < 0 ? 0 : _sqrt(best);
+        *delta_e = root > UINT16_MAX ? UINT16_MAX : (uint16_t)root;
+    }
+    return reference;
+}
+
+int8_t tcs3472x_sort_trigger(tcs3472x_sorter_t *sorter, int64_t now_ns) {
+    if (tcs3472x_restart_integration() < 0) {
+        sorter->pending = 0;
+        sorter->errors++;
+        return -1;
+    }
+
+    sorter->pending = 1;
+    sorter->trigger_ns = now_ns;
+    sorter->ready_ns = now_ns + (int64_t)tcs3472x_atime_to_us(sorter->config.atime) * 1000 * OSCILLATOR_FAST / 10;
+    return 0;
+}
+
+int8_t tcs3472x_sort_poll(tcs3472x_sorter_t *sorter, int64_t now_ns, tcs3472x_sort_decision_t *decision) {
+    uint8_t status = 0;
+
+    if (!sorter->pending || now_ns < sorter->ready_ns) {
+        return 0;
+    }
+
+    if (tcs3472x_get_status_colors(&status, decision->colors) < 0) {
+        sorter->pending = 0;
+        sorter->errors++;
+        return -1;
+    }
+    if (!(status & STATUS_AVALID)) {
+        if (now_ns - sorter->trigger_ns < sorter->config.timeout_ns) {
+            return 0;
+        }
+        LOG_ERROR("No sample within the sorting timeout.\r\n");
+        sorter->pending = 0;
+        sorter->errors++;
+        return -1;
+    }
+
+    decision->reference = TCS3472X_SORT_REJECT;
+    decision->delta_e = 0;
+    decision->color.a = 0;
+    decision->color.b = 0;
+    if (decision->colors[0] >= sorter->config.min_clear && decision->colors[0] < sorter->full_scale) {
+        tcs3472x_sort_color(&sorter->config, decision->colors, &decision->color);
+        decision->reference = tcs3472x_sort_match(sorter, &decision->color, &decision->delta_e);
+        if (decision->delta_e > sorter->config.max_delta_e) {
+            decision->reference = TCS3472X_SORT_REJECT;
+        }
+    }
+    decision->latency_ns = now_ns - sorter->trigger_ns;
+
+    sorter->pending = 0;
+    sorter->decisions++;
+    if (decision->reference == TCS3472X_SORT_REJECT) {
+        sorter->rejects++;
+    }
+    return 1;
+}
+
+/**
+ * CIELAB companding function f(t) in 12-bit fixed point.
+ */
+static int32_t _lab_f(int32_t t) {
+    if (t <= T_LINEAR) {
+        // t / (3 (6/29)^2) + 4/29
+        return t * 841 / 108 + 565;
+    }
+    // The cube root of a 36-bit fixed point value has 12 fractional bits
+    return (int32_t)_cbrt((uint64_t)t << 24);
+}
+
+/**
+ * Integer cube root, bit by bit. value must be below 2^42.
+ */
+static uint32_t _cbrt(uint64_t value) {
+    uint64_t root = 0, bit = 0;
+    int8_t shift = 0;
+
+    for (shift = 39; shift >= 0; shift -= 3) {
+        root <<= 1;
+        bit = (3 * root * (root + 1) + 1) << shift;
+        if (value >= bit) {
+            value -= bit;
+            root++;
+        }
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * Integer square root, bit by bit.
+ */
+static uint32_t _sqrt(uint64_t value) {
+    uint64_t root = 0, bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static int16_t _clamp(int32_t value) {
+    return value < INT16_MIN ? INT16_MIN : value > INT16_MAX ? INT16_MAX : (int16_t)value;
+}
+
+/**
+ * Grid column or row of an a* or b* value.
+ *
+ * @return The column or row, or -1 if the value lies outside the grid.
+ */
+static int32_t _cell(const tcs3472x_sorter_t *sorter, int16_t value, int16_t origin) {
+    int32_t offset = (int32_t)value - origin;
+
+    if (offset < 0 || offset >= (int32_t)sorter->cell_width * TCS3472X_SORT_GRID_SIZE) {
+        return -1;
+    }
+    return offset / sorter->cell_width;
+}
+
+static uint64_t _distance2(const tcs3472x_sort_reference_t *p, const tcs3472x_sort_reference_t *q) {
+    int64_t da = (int64_t)p->a - q->a, db = (int64_t)p->b - q->b;
+
+    // Differences of int16 values square to up to 2^32 each, so the sum needs 64 bits
+    return (uint64_t)(da * da) + (uint64_t)(db * db);
+}
+
+/**
+ * Squared distance along one axis from a value to the nearest point of [low, high].
+ */
+static uint64_t _axis_min(int32_t value, int32_t low, int32_t high) {
+    int64_t d = value < low ? (int64_t)low - value : value > high ? (int64_t)value - high : 0;
+
+    return (uint64_t)(d * d);
+}
+
+/**
+ * Squared distance along one axis from a value to the farthest point of [low, high].
+ */
+static uint64_t _axis_max(int32_t value, int32_t low, int32_t high) {
+    int64_t d = (int64_t)value - low > (int64_t)high - value ? (int64_t)value - low : (int64_t)high - value;
+
+    return (uint64_t)(d * d);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file tcs3472x_stats.c
+ * @brief Per-device counters and transaction latency histogram.
+ *
+ * This file implements the functions declared in tcs3472x_stats.h.
+ */
+
+#include "tcs3472x_stats.h"
+
+#define COUNTS_PER_ATIME_STEP   1024    ///< Maximum clear count added per 2.4 ms integration step
+#define FULL_SCALE              65535
+#define CYCLE_STEPS             256
+
+const uint32_t tcs3472x_stats_latency_bounds_us[TCS3472X_STATS_LATENCY_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+};
+
+static tcs3472x_stats_t device_stats;
+
+tcs3472x_stats_t *tcs3472x_get_stats(void) {
+    return &device_stats;
+}
+
+void tcs3472x_stats_record_transaction(tcs3472x_stats_t *stats, uint32_t latency_ns, int8_t result) {
+    uint32_t latency_us = latency_ns / 1000;
+    uint8_t bucket = 0;
+
+    while (bucket < TCS3472X_STATS_LATENCY_BUCKETS - 1 &&
+           latency_us > tcs3472x_stats_latency_bounds_us[bucket]) {
+        bucket++;
+    }
+
+    stats->transactions++;
+    stats->latency_buckets[bucket]++;
+    stats->latency_sum_ns += latency_ns;
+    if (result < 0) {
+        stats->errors++;
+    }
+}
+
+void tcs3472x_stats_record_sample(tcs3472x_stats_t *stats, uint16_t clear, uint8_t atime) {
+    uint32_t full_scale = (uint32_t)(CYCLE_STEPS - atime) * COUNTS_PER_ATIME_STEP;
+
+    if (full_scale > FULL_SCALE) {
+        full_scale = FULL_SCALE;
+    }
+
+    stats->samples++;
+    if (clear >= full_scale) {
+        stats->saturations++;
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file tcs3472x_timing.c
+ * @brief Estimation of the integration window a sample was taken over.
+ *
+ * This file implements the functions declared in tcs3472x_timing.h using integer arithmetic only.
+ */
+
+#include "tcs3472x_timing.h"
+
+#define CYCLE_STEP_NS           2400000LL   ///< One ATIME/WTIME step (2.4 ms)
+#define CYCLE_STEPS             256
+#define WLONG_FACTOR            12          ///< WLONG multiplies the wait steps
+#define SCALE_ONE               1000        ///< Oscillator scale in parts per thousand
+#define SCALE_MIN               850         ///< Observed scales outside +/-15 % are rejected as glitches
+#define SCALE_MAX               1150
+
+static int64_t _nominal_atime_ns(const tcs3472x_config_cache_t *config);
+static int64_t _nominal_cycle_ns(const tcs3472x_config_cache_t *config);
+
+void tcs3472x_timing_init(tcs3472x_timing_t *timing, const tcs3472x_config_cache_t *config) {
+    timing->config = *config;
+
+    timing->atime_ns = _nominal_atime_ns(config);
+    timing->cycle_ns = _nominal_cycle_ns(config);
+    timing->first_end_ns = 0;
+    timing->uncertainty_ns = 0;
+    timing->synced = 0;
+}
+
+void tcs3472x_timing_sync(tcs3472x_timing_t *timing, int64_t enable_ns, int64_t invalid_ns,
+                          int64_t valid_ns) {
+    int64_t nominal_atime_ns = _nominal_atime_ns(&timing->config);
+    int64_t observed_ns = 0, scale = SCALE_ONE;
+
+    timing->first_end_ns = invalid_ns + (valid_ns - invalid_ns) / 2;
+    timing->uncertainty_ns = (valid_ns - invalid_ns) / 2;
+
+    // Only trust the observed duration when the detection interval is small against it
+    observed_ns = timing->first_end_ns - enable_ns;
+    if (timing->uncertainty_ns * 20 < observed_ns) {
+        scale = observed_ns * SCALE_ONE / nominal_atime_ns;
+        if (scale < SCALE_MIN || scale > SCALE_MAX) {
+            scale = SCALE_ONE;
+        }
+    }
+
+    timing->atime_ns = nominal_atime_ns * scale / SCALE_ONE;
+    timing->cycle_ns = _nominal_cycle_ns(&timing->config) * scale / SCALE_ONE;
+    timing->synced = 1;
+}
+
+int8_t tcs3472x_timing_window(const tcs3472x_timing_t *timing, int64_t read_ns, int64_t *start_ns,
+                              int64_t *end_ns) {
+    int64_t cycles = 0;
+
+    if (!timing->synced || read_ns < timing->first_end_ns) {
+        return -1;
+    }
+
+    cycles = (read_ns - timing->first_end_ns) / timing->cycle_ns;
+    *end_ns = timing->first_end_ns + cycles * timing->cycle_ns;
+    *start_ns = *end_ns - timing->atime_ns;
+    return 0;
+}
+
+/**
+ * Returns the nominal integration time of a configuration.
+ */
+static int64_t _nominal_atime_ns(const tcs3472x_config_cache_t *config) {
+    return (int64_t)tcs3472x_atime_to_us(config->atime) * 1000;
+}
+
+/**
+ * Returns the nominal time between two AVALID events of a configuration.
+ */
+static int64_t _nominal_cycle_ns(const tcs3472x_config_cache_t *config) {
+    int64_t cycle_ns = _nominal_atime_ns(config);
+
+    if (config->enable & ENABLE_WEN) {
+        cycle_ns += (CYCLE_STEPS - config->wtime) * CYCLE_STEP_NS *
+                    ((config->config & CONFIG_WLONG) ? WLONG_FACTOR : 1);
+    }
+    return cycle_ns;
+}
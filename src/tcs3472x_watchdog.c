@@ -0,0 +1,139 @@
+/**
+ * @file tcs3472x_watchdog.c
+ * @brief Stuck-sensor and anomaly watchdog on the sample stream of the core driver.
+ *
+ * This file implements the functions declared in tcs3472x_watchdog.h using integer arithmetic only.
+ */
+
+#include "tcs3472x.h"
+#include "tcs3472x_watchdog.h"
+
+#define CYCLE_STEPS             256
+#define FULL_SCALE_PER_STEP     1024    ///< Clear count full scale per integration step
+#define MAX_COUNT               65535
+
+static tcs3472x_watchdog_fault_t _check_stream(tcs3472x_watchdog_t *watchdog, const uint16_t colors[4]);
+static tcs3472x_watchdog_fault_t _check_registers(tcs3472x_watchdog_t *watchdog);
+
+void tcs3472x_watchdog_config_default(tcs3472x_watchdog_config_t *config) {
+    config->frozen_limit = 8;
+    config->zero_limit = 8;
+    config->implausible_limit = 4;
+    config->min_clear = 64;
+    config->min_ratio_permille = 250;
+    config->max_ratio_permille = 2500;
+    config->check_interval = 50;
+    config->auto_recover = 1;
+}
+
+void tcs3472x_watchdog_init(tcs3472x_watchdog_t *watchdog, const tcs3472x_watchdog_config_t *config,
+                            uint8_t expected_id) {
+    uint8_t i = 0;
+
+    watchdog->config = *config;
+    watchdog->identical = 0;
+    watchdog->implausible = 0;
+    watchdog->until_check = config->check_interval;
+    watchdog->expected_id = expected_id;
+    watchdog->has_last = 0;
+    for (i = 0; i < TCS3472X_WATCHDOG_FAULT_COUNT; i++) {
+        watchdog->faults[i] = 0;
+    }
+    watchdog->recoveries = 0;
+    watchdog->failed_recoveries = 0;
+}
+
+tcs3472x_watchdog_fault_t tcs3472x_watchdog_feed(tcs3472x_watchdog_t *watchdog, const uint16_t colors[4]) {
+    tcs3472x_watchdog_fault_t fault = _check_stream(watchdog, colors);
+
+    if (fault == TCS3472X_WATCHDOG_OK && watchdog->config.check_interval != 0 && --watchdog->until_check == 0) {
+        watchdog->until_check = watchdog->config.check_interval;
+        fault = _check_registers(watchdog);
+    }
+    if (fault == TCS3472X_WATCHDOG_OK) {
+        return fault;
+    }
+
+    LOG_ERROR("Watchdog fault %d, %s.\r\n", fault, watchdog->config.auto_recover ? "restoring" : "not restoring");
+    watchdog->faults[fault]++;
+    watchdog->identical = 0;
+    watchdog->implausible = 0;
+    watchdog->until_check = watchdog->config.check_interval;
+    watchdog->has_last = 0;
+
+    if (watchdog->config.auto_recover) {
+        if (tcs3472x_restore_config() < 0) {
+            watchdog->failed_recoveries++;
+        }
+        else {
+            watchdog->recoveries++;
+        }
+    }
+    return fault;
+}
+
+/**
+ * Updates the zero, frozen and implausible run lengths with one sample.
+ */
+static tcs3472x_watchdog_fault_t _check_stream(tcs3472x_watchdog_t *watchdog, const uint16_t colors[4]) {
+    const tcs3472x_watchdog_config_t *config = &watchdog->config;
+    const uint32_t steps = CYCLE_STEPS - tcs3472x_get_config_cache()->atime;
+    const uint32_t full_scale = steps * FULL_SCALE_PER_STEP > MAX_COUNT ? MAX_COUNT : steps * FULL_SCALE_PER_STEP;
+    uint32_t sum = (uint32_t)colors[1] + colors[2] + colors[3];
+    uint8_t zero = (colors[0] | colors[1] | colors[2] | colors[3]) == 0;
+    uint8_t same = watchdog->has_last &&
+                   colors[0] == watchdog->last[0] && colors[1] == watchdog->last[1] &&
+                   colors[2] == watchdog->last[2] && colors[3] == watchdog->last[3];
+
+    watchdog->last[0] = colors[0];
+    watchdog->last[1] = colors[1];
+    watchdog->last[2] = colors[2];
+    watchdog->last[3] = colors[3];
+    watchdog->has_last = 1;
+
+    watchdog->identical = same ? watchdog->identical + 1 : 0;
+    if (zero) {
+        watchdog->implausible = 0;
+        if (config->zero_limit != 0 && watchdog->identical + 1 >= config->zero_limit) {
+            return TCS3472X_WATCHDOG_ZERO;
+        }
+        return TCS3472X_WATCHDOG_OK;
+    }
+
+    // Dark and saturated scenes legitimately repeat values and break the channel relation
+    if (colors[0] < config->min_clear || colors[0] >= full_scale || colors[1] >= full_scale ||
+        colors[2] >= full_scale || colors[3] >= full_scale) {
+        watchdog->identical = 0;
+        watchdog->implausible = 0;
+        return TCS3472X_WATCHDOG_OK;
+    }
+
+    if (watchdog->identical + 1 >= config->frozen_limit) {
+        return TCS3472X_WATCHDOG_FROZEN;
+    }
+    if ((uint64_t)sum * 1000 < (uint64_t)colors[0] * config->min_ratio_permille ||
+        (uint64_t)sum * 1000 > (uint64_t)colors[0] * config->max_ratio_permille) {
+        if (++watchdog->implausible >= config->implausible_limit) {
+            return TCS3472X_WATCHDOG_IMPLAUSIBLE;
+        }
+    }
+    else {
+        watchdog->implausible = 0;
+    }
+    return TCS3472X_WATCHDOG_OK;
+}
+
+/**
+ * Reads ID and ENABLE through the core driver and compares them with what they should be.
+ */
+static tcs3472x_watchdog_fault_t _check_registers(tcs3472x_watchdog_t *watchdog) {
+    const uint8_t running = ENABLE_PON | ENABLE_AEN;
+
+    if (tcs3472x_get_id() != watchdog->expected_id) {
+        return TCS3472X_WATCHDOG_ID_CHANGED;
+    }
+    if ((tcs3472x_get_enable() & running) != (tcs3472x_get_config_cache()->enable & running)) {
+        return TCS3472X_WATCHDOG_DISABLED;
+    }
+    return TCS3472X_WATCHDOG_OK;
+}